@@ -35,12 +35,35 @@
 #define TF_TYPE_BYTES 1 // Số byte cho loại frame | Number of bytes for frame type
 
 // Loại checksum. Các tùy chọn: | Checksum type. Options:
-//   TF_CKSUM_NONE, TF_CKSUM_XOR, TF_CKSUM_CRC8, TF_CKSUM_CRC16, TF_CKSUM_CRC32
+//   TF_CKSUM_NONE, TF_CKSUM_XOR, TF_CKSUM_CRC8, TF_CKSUM_CRC16, TF_CKSUM_CRC32, TF_CKSUM_CRC32C
+//   TF_CKSUM_FLETCHER16, TF_CKSUM_ADLER32
 //   TF_CKSUM_CUSTOM8, TF_CKSUM_CUSTOM16, TF_CKSUM_CUSTOM32
 // Checksum tùy chỉnh yêu cầu bạn implement các hàm checksum (xem TinyFrame.h)
 // Custom checksums require you to implement checksum functions (see TinyFrame.h)
 #define TF_CKSUM_TYPE TF_CKSUM_CRC16
 
+// Checksum tùy chỉnh: 1 = bạn cũng implement TF_CksumAddBlock() để xử lý cả khối byte
+// (payload, header) thay vì một lần gọi TF_CksumAdd() cho mỗi byte. Mặc định: 0
+// Custom checksums: 1 = you also implement TF_CksumAddBlock() to process whole byte blocks
+// (payload, header) instead of one TF_CksumAdd() call per byte. Default: 0
+#define TF_CKSUM_CUSTOM_BLOCK 0
+
+// CRC8 / CRC16 / CRC32: số byte xử lý mỗi bước trên payload (1, 4 hoặc 8). 4 và 8 nhanh hơn
+// nhiều nhưng cần thêm bảng hằng (CRC32: 3 KB / 7 KB, CRC16: 1.5 KB / 3.5 KB,
+// CRC8: 768 B / 1.75 KB). Mặc định: 1
+// CRC8 / CRC16 / CRC32: nr of bytes processed per step on the payload (1, 4 or 8). 4 and 8 are
+// much faster but need extra constant tables (CRC32: 3 KB / 7 KB, CRC16: 1.5 KB / 3.5 KB,
+// CRC8: 768 B / 1.75 KB). Default: 1
+#define TF_CRC_SLICING 1
+
+// Cho phép dùng lệnh của CPU cho CRC: CRC32C với SSE 4.2 (kiểm tra lúc chạy) hoặc ARMv8 CRC
+// (khi compiler nhắm tới nó), CRC16 / CRC32 với PCLMULQDQ cho khối >= 64 byte (kiểm tra lúc chạy).
+// Đặt 0 để luôn dùng bảng phần mềm. Mặc định: 1
+// Allow CPU instructions for CRCs: CRC32C with SSE 4.2 (checked at run time) or ARMv8 CRC
+// (when the compiler targets it), CRC16 / CRC32 with PCLMULQDQ for blocks >= 64 bytes (checked
+// at run time). Set to 0 to always use the software tables. Default: 1
+#define TF_USE_CRC_HW 1
+
 // Sử dụng byte SOF để đánh dấu bắt đầu frame | Use a SOF byte to mark the start of a frame
 #define TF_USE_SOF_BYTE 1
 // Giá trị của byte SOF (nếu TF_USE_SOF_BYTE == 1) | Value of the SOF byte (if TF_USE_SOF_BYTE == 1)
@@ -68,24 +91,105 @@ typedef uint8_t TF_COUNT;
 // in multiple calls to the write function. This can be lowered to reduce RAM usage.
 #define TF_SENDBUF_LEN 128
 
+// Đặt buffer nhận / gửi ngoài struct TinyFrame để mỗi instance có kích thước riêng
+// (xem TF_InitEx()). Khi đó hai giá trị trên chỉ là kích thước mặc định.
+// Keep the receive / send buffers outside struct TinyFrame so each instance is sized
+// on its own (see TF_InitEx()). The two values above then only set the default size.
+#define TF_USE_EXTERNAL_BUFFERS 0
+
 // --- Số lượng Listener - xác định kích thước của bảng slot tĩnh ---
 // --- Listener counts - determine sizes of the static slot tables ---
 
 // Frame ID listeners (chờ phản hồi / thông điệp multi-part) | Frame ID listeners (wait for response / multi-part message)
 #define TF_MAX_ID_LST 10
+// Số bucket của bảng tra ID listener (lũy thừa của 2). Mặc định: lũy thừa của 2 >= TF_MAX_ID_LST
+// Nr of buckets in the ID listener lookup table (power of 2). Default: a power of 2 >= TF_MAX_ID_LST
+#define TF_ID_BUCKETS 16
+// Số ô của timing wheel cho timeout của ID listener (lũy thừa của 2). Mỗi TF_Tick() chỉ kiểm tra một ô. Mặc định: 64
+// Nr of slots in the timing wheel for ID listener timeouts (power of 2). Each TF_Tick() checks only one slot. Default: 64
+#define TF_TIMER_SLOTS 64
 // Frame Type listeners (chờ frame với byte payload đầu tiên cụ thể) | Frame Type listeners (wait for frame with a specific first payload byte)
 #define TF_MAX_TYPE_LST 10
+// Số bucket của bảng tra Type listener (lũy thừa của 2), tra cứu O(1) khi nhận frame.
+// Mặc định 256 với type 1 byte (tra trực tiếp, sizeof(TF_COUNT) * 256 byte RAM), 64 với type 2 / 4 byte (bảng băm).
+// Nr of buckets in the Type listener lookup table (power of 2), O(1) lookup when a frame arrives.
+// Default 256 with 1-byte types (direct-mapped, sizeof(TF_COUNT) * 256 bytes of RAM), 64 with 2 / 4-byte types (hashed).
+#define TF_TYPE_BUCKETS 256
 // Generic listeners (dự phòng nếu không có listener nào khác bắt được) | Generic listeners (fallback if no other listener catches it)
 #define TF_MAX_GEN_LST 5
 
+// Đặt các bảng ID / Type / Generic listener ngoài struct TinyFrame để mỗi instance có số slot
+// riêng (xem TF_InitEx()). Khi đó ba giá trị TF_MAX_*_LST trên chỉ là số slot mặc định.
+// Keep the ID / Type / Generic listener tables outside struct TinyFrame so each instance has
+// its own slot counts (see TF_InitEx()). The three TF_MAX_*_LST values above then only set the defaults.
+// Bảng bucket ID (và Type với type 2 / 4 byte) khi đó cũng theo từng instance, TF_INDEX_LEN(số slot),
+// TF_ID_BUCKETS / TF_TYPE_BUCKETS không được dùng.
+// The ID bucket table (and the Type one with 2 / 4-byte types) is then per instance too,
+// TF_INDEX_LEN(nr of slots), TF_ID_BUCKETS / TF_TYPE_BUCKETS are not used.
+#define TF_USE_EXTERNAL_LISTENERS 0
+
+// Stream listeners (nhận payload lớn hơn TF_MAX_PAYLOAD_RX theo từng phần, xem TF_AddStreamListener())
+// Stream listeners (receive payloads larger than TF_MAX_PAYLOAD_RX in chunks, see TF_AddStreamListener())
+#define TF_USE_STREAM_RX 0
+#define TF_MAX_STREAM_LST 2
+
+// Range / Mask listeners (một listener cho cả dải type hoặc mẫu mask/value, xem TF_AddTypeRangeListener()).
+// Tra qua bảng 256 ô theo byte thấp của type, tốn thêm sizeof(TF_COUNT) * 256 byte RAM.
+// Range / Mask listeners (one listener for a whole type range or mask/value pattern, see TF_AddTypeRangeListener()).
+// Looked up through a 256-entry table by the low type byte, costs sizeof(TF_COUNT) * 256 more bytes of RAM.
+#define TF_USE_RANGE_LST 0
+#define TF_MAX_RANGE_LST 4
+
+// Batch listener (giao các frame hoàn tất trong một lần gọi TF_Accept() cùng nhau, xem TF_SetBatchListener())
+// Batch listener (deliver the frames completed in one TF_Accept() call together, see TF_SetBatchListener())
+// TF_MAX_BATCH: số thông điệp tối đa mỗi batch | max messages per batch
+// TF_BATCH_DATA_LEN: buffer cho payload phải sao chép | buffer for payloads that have to be copied
+#define TF_USE_BATCH 0
+#define TF_MAX_BATCH 16
+#define TF_BATCH_DATA_LEN 256
+
+// Hàng đợi dispatch (TF_Accept() chỉ phân tích, listener chạy trên luồng gọi TF_Dispatch()). Không dùng cùng TF_USE_BATCH.
+// Dispatch queue (TF_Accept() only parses, listeners run on the thread calling TF_Dispatch()). Not combined with TF_USE_BATCH.
+// TF_DISPATCH_SLOTS: số frame tối đa trong mỗi lane, lũy thừa của 2 | max frames in each lane, power of 2
+// TF_DISPATCH_DATA_LEN: buffer cho bản sao payload của mỗi lane, lũy thừa của 2 | buffer for each lane's payload copies, power of 2
+// TF_DISPATCH_LANES: số lane, > 1 cho nhiều worker (cần TF_LockListeners() / TF_UnlockListeners()) | nr of lanes, > 1 for several workers (needs TF_LockListeners() / TF_UnlockListeners())
+// Với compiler không phải GCC / Clang, định nghĩa thêm TF_QUEUE_LOAD(p) (acquire), TF_QUEUE_STORE(p, v) (release)
+// và với nhiều lane, TF_QUEUE_SWAP(p, v) (đổi *p thành v, acquire + release, trả về giá trị cũ).
+// With compilers other than GCC / Clang, also define TF_QUEUE_LOAD(p) (acquire), TF_QUEUE_STORE(p, v) (release)
+// and with several lanes, TF_QUEUE_SWAP(p, v) (exchange *p with v, acquire + release, return the old value).
+#define TF_USE_DISPATCH_QUEUE 0
+#define TF_DISPATCH_SLOTS 8
+#define TF_DISPATCH_DATA_LEN 2048
+#define TF_DISPATCH_LANES 1
+
 // Timeout cho việc nhận & phân tích frame | Timeout for receiving & parsing a frame
 // tick = số lần gọi TF_Tick() | ticks = number of calls to TF_Tick()
 #define TF_PARSER_TIMEOUT_TICKS 10
 
+// Khi checksum header sai, quét lại các byte header (tối đa vài byte) tìm SOF tiếp theo
+// thay vì bỏ qua chúng - frame thật bắt đầu bên trong không bị mất. Mặc định: 1
+// After a header checksum failure, rescan the header bytes (a few bytes at most) for the next
+// SOF instead of dropping them - a real frame starting inside is not lost. Default: 1
+#define TF_USE_HEAD_LOOKBACK 1
+
+// Đo timeout bằng đồng hồ đơn điệu TF_GetTime() (do bạn implement) thay vì đếm TF_Tick().
+// Khi đó mọi timeout (kể cả TF_PARSER_TIMEOUT_TICKS) tính theo đơn vị của đồng hồ, TF_TICKS
+// phải đủ rộng cho nó, và TF_NextDeadline() cho biết khi nào cần gọi TF_Tick().
+// Measure timeouts with the TF_GetTime() monotonic clock (implemented by you) instead of
+// counting TF_Tick() calls. All timeouts (TF_PARSER_TIMEOUT_TICKS too) are then in clock units,
+// TF_TICKS must be wide enough for it, and TF_NextDeadline() tells when TF_Tick() is due.
+#define TF_USE_CLOCK 0
+
 // Có sử dụng mutex hay không - yêu cầu bạn implement TF_ClaimTx() và TF_ReleaseTx()
 // Whether to use mutex - requires you to implement TF_ClaimTx() and TF_ReleaseTx()
 #define TF_USE_MUTEX 1
 
+// Giao payload cho listener trực tiếp từ buffer truyền vào TF_Accept() (không sao chép)
+// khi toàn bộ payload và checksum của nó nằm trong buffer đó. Mặc định: 1
+// Hand the payload to listeners straight from the buffer passed to TF_Accept() (no copy)
+// when the whole payload and its checksum lie in that buffer. Default: 1
+#define TF_USE_ZERO_COPY_RX 1
+
 // Hàm báo cáo lỗi. Để vô hiệu hóa debug, thay đổi thành define rỗng
 // Error reporting function. To disable debug, change to empty define
 #define TF_Error(format, ...) printf("[TF] " format "\n", ##__VA_ARGS__)
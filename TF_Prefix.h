@@ -0,0 +1,225 @@
+/**
+ * Đổi tên công khai của TinyFrame thành <TF_PREFIX>TF_... để nhiều cấu hình cùng tồn tại trong một chương trình.
+ * Được TinyFrame.h include khi TF_PREFIX được định nghĩa - không include trực tiếp.
+ * Renames the public TinyFrame names to <TF_PREFIX>TF_... so several configurations can live in one program.
+ * Included by TinyFrame.h when TF_PREFIX is defined - do not include directly.
+ *
+ * Mỗi cấu hình cần một file .c | Each configuration needs one .c file:
+ *
+ *     #define TF_PREFIX link_a_
+ *     #define TF_CONFIG_HEADER "link_a_config.h"
+ *     #include "TinyFrame.c"
+ *
+ * Người dùng include header với cùng hai define và gọi link_a_TF_Init(), link_a_TF_Send() ...,
+ * callback cũng có prefix: link_a_TF_WriteImpl(). Các instance khác nhau có thể được include trong cùng
+ * một file, mỗi prefix một lần, nhưng không cùng với TinyFrame.h không prefix.
+ * The user includes the header with the same two defines and calls link_a_TF_Init(), link_a_TF_Send() ...,
+ * callbacks are prefixed too: link_a_TF_WriteImpl(). Different instances can be included in the same
+ * file, once per prefix, but not together with the unprefixed TinyFrame.h.
+ */
+
+#ifndef TF_PREFIX_UNDEF
+
+// Kiểu | Types
+#define TinyFrame           TF_PFX(TinyFrame)
+#define TinyFrame_          TF_PFX(TinyFrame_)
+#define TF_Msg              TF_PFX(TF_Msg)
+#define TF_Msg_             TF_PFX(TF_Msg_)
+#define TF_ID               TF_PFX(TF_ID)
+#define TF_LEN              TF_PFX(TF_LEN)
+#define TF_TYPE             TF_PFX(TF_TYPE)
+#define TF_CKSUM            TF_PFX(TF_CKSUM)
+#define TF_TICKS            TF_PFX(TF_TICKS)
+#define TF_COUNT            TF_PFX(TF_COUNT)
+#define TF_Listener         TF_PFX(TF_Listener)
+#define TF_Listener_Timeout TF_PFX(TF_Listener_Timeout)
+#define TF_StreamChunk      TF_PFX(TF_StreamChunk)
+#define TF_StreamEnd        TF_PFX(TF_StreamEnd)
+#define TF_BatchListener    TF_PFX(TF_BatchListener)
+#define TF_InitCfg          TF_PFX(TF_InitCfg)
+#define TF_InitCfg_         TF_PFX(TF_InitCfg_)
+#define TF_IdListener_      TF_PFX(TF_IdListener_)
+#define TF_TypeListener_    TF_PFX(TF_TypeListener_)
+#define TF_GenericListener_ TF_PFX(TF_GenericListener_)
+#define TF_StreamListener_  TF_PFX(TF_StreamListener_)
+#define TF_RangeListener_   TF_PFX(TF_RangeListener_)
+#define TF_DispatchLane_    TF_PFX(TF_DispatchLane_)
+
+// Hàm | Functions
+#define TF_ClearMsg              TF_PFX(TF_ClearMsg)
+#define TF_Init                  TF_PFX(TF_Init)
+#define TF_InitStatic            TF_PFX(TF_InitStatic)
+#define TF_InitEx                TF_PFX(TF_InitEx)
+#define TF_InitStaticEx          TF_PFX(TF_InitStaticEx)
+#define TF_DeInit                TF_PFX(TF_DeInit)
+#define TF_Accept                TF_PFX(TF_Accept)
+#define TF_AcceptChar            TF_PFX(TF_AcceptChar)
+#define TF_Tick                  TF_PFX(TF_Tick)
+#define TF_NextDeadline          TF_PFX(TF_NextDeadline)
+#define TF_ResetParser           TF_PFX(TF_ResetParser)
+#define TF_AddIdListener         TF_PFX(TF_AddIdListener)
+#define TF_RemoveIdListener      TF_PFX(TF_RemoveIdListener)
+#define TF_AddTypeListener       TF_PFX(TF_AddTypeListener)
+#define TF_RemoveTypeListener    TF_PFX(TF_RemoveTypeListener)
+#define TF_AddGenericListener    TF_PFX(TF_AddGenericListener)
+#define TF_RemoveGenericListener TF_PFX(TF_RemoveGenericListener)
+#define TF_SetBatchListener      TF_PFX(TF_SetBatchListener)
+#define TF_Dispatch              TF_PFX(TF_Dispatch)
+#define TF_AddStreamListener     TF_PFX(TF_AddStreamListener)
+#define TF_RemoveStreamListener  TF_PFX(TF_RemoveStreamListener)
+#define TF_AddTypeRangeListener    TF_PFX(TF_AddTypeRangeListener)
+#define TF_AddTypeMaskListener     TF_PFX(TF_AddTypeMaskListener)
+#define TF_RemoveTypeRangeListener TF_PFX(TF_RemoveTypeRangeListener)
+#define TF_RemoveTypeMaskListener  TF_PFX(TF_RemoveTypeMaskListener)
+#define TF_RenewIdListener       TF_PFX(TF_RenewIdListener)
+#define TF_Send                  TF_PFX(TF_Send)
+#define TF_SendSimple            TF_PFX(TF_SendSimple)
+#define TF_Query                 TF_PFX(TF_Query)
+#define TF_QuerySimple           TF_PFX(TF_QuerySimple)
+#define TF_Respond               TF_PFX(TF_Respond)
+#define TF_Send_Multipart        TF_PFX(TF_Send_Multipart)
+#define TF_SendSimple_Multipart  TF_PFX(TF_SendSimple_Multipart)
+#define TF_QuerySimple_Multipart TF_PFX(TF_QuerySimple_Multipart)
+#define TF_Query_Multipart       TF_PFX(TF_Query_Multipart)
+#define TF_Respond_Multipart     TF_PFX(TF_Respond_Multipart)
+#define TF_Multipart_Payload     TF_PFX(TF_Multipart_Payload)
+#define TF_Multipart_PayloadRaw  TF_PFX(TF_Multipart_PayloadRaw)
+#define TF_Multipart_Close       TF_PFX(TF_Multipart_Close)
+#define TF_Multipart_CloseCksum  TF_PFX(TF_Multipart_CloseCksum)
+#define TF_Cksum                 TF_PFX(TF_Cksum)
+#define TF_CksumCombine          TF_PFX(TF_CksumCombine)
+
+// Hàm do người dùng cung cấp | User-supplied functions
+#define TF_WriteImpl     TF_PFX(TF_WriteImpl)
+#define TF_GetTime       TF_PFX(TF_GetTime)
+#define TF_ClaimTx       TF_PFX(TF_ClaimTx)
+#define TF_ReleaseTx     TF_PFX(TF_ReleaseTx)
+#define TF_LockListeners   TF_PFX(TF_LockListeners)
+#define TF_UnlockListeners TF_PFX(TF_UnlockListeners)
+#define TF_CksumStart    TF_PFX(TF_CksumStart)
+#define TF_CksumAdd      TF_PFX(TF_CksumAdd)
+#define TF_CksumEnd      TF_PFX(TF_CksumEnd)
+#define TF_CksumAddBlock TF_PFX(TF_CksumAddBlock)
+
+#else
+
+#undef TinyFrame
+#undef TinyFrame_
+#undef TF_Msg
+#undef TF_Msg_
+#undef TF_ID
+#undef TF_LEN
+#undef TF_TYPE
+#undef TF_CKSUM
+#undef TF_TICKS
+#undef TF_COUNT
+#undef TF_Listener
+#undef TF_Listener_Timeout
+#undef TF_StreamChunk
+#undef TF_StreamEnd
+#undef TF_BatchListener
+#undef TF_InitCfg
+#undef TF_InitCfg_
+#undef TF_IdListener_
+#undef TF_TypeListener_
+#undef TF_GenericListener_
+#undef TF_StreamListener_
+#undef TF_RangeListener_
+#undef TF_DispatchLane_
+
+#undef TF_ClearMsg
+#undef TF_Init
+#undef TF_InitStatic
+#undef TF_InitEx
+#undef TF_InitStaticEx
+#undef TF_DeInit
+#undef TF_Accept
+#undef TF_AcceptChar
+#undef TF_Tick
+#undef TF_NextDeadline
+#undef TF_ResetParser
+#undef TF_AddIdListener
+#undef TF_RemoveIdListener
+#undef TF_AddTypeListener
+#undef TF_RemoveTypeListener
+#undef TF_AddGenericListener
+#undef TF_RemoveGenericListener
+#undef TF_SetBatchListener
+#undef TF_Dispatch
+#undef TF_AddStreamListener
+#undef TF_RemoveStreamListener
+#undef TF_AddTypeRangeListener
+#undef TF_AddTypeMaskListener
+#undef TF_RemoveTypeRangeListener
+#undef TF_RemoveTypeMaskListener
+#undef TF_RenewIdListener
+#undef TF_Send
+#undef TF_SendSimple
+#undef TF_Query
+#undef TF_QuerySimple
+#undef TF_Respond
+#undef TF_Send_Multipart
+#undef TF_SendSimple_Multipart
+#undef TF_QuerySimple_Multipart
+#undef TF_Query_Multipart
+#undef TF_Respond_Multipart
+#undef TF_Multipart_Payload
+#undef TF_Multipart_PayloadRaw
+#undef TF_Multipart_Close
+#undef TF_Multipart_CloseCksum
+#undef TF_Cksum
+#undef TF_CksumCombine
+
+#undef TF_WriteImpl
+#undef TF_GetTime
+#undef TF_ClaimTx
+#undef TF_ReleaseTx
+#undef TF_LockListeners
+#undef TF_UnlockListeners
+#undef TF_CksumStart
+#undef TF_CksumAdd
+#undef TF_CksumEnd
+#undef TF_CksumAddBlock
+
+// Cấu hình của instance | Instance config
+#undef TF_ID_BYTES
+#undef TF_LEN_BYTES
+#undef TF_TYPE_BYTES
+#undef TF_CKSUM_TYPE
+#undef TF_USE_SOF_BYTE
+#undef TF_SOF_BYTE
+#undef TF_MAX_PAYLOAD_RX
+#undef TF_SENDBUF_LEN
+#undef TF_MAX_ID_LST
+#undef TF_MAX_TYPE_LST
+#undef TF_MAX_GEN_LST
+#undef TF_PARSER_TIMEOUT_TICKS
+#undef TF_USE_MUTEX
+#undef TF_Error
+#undef TF_CRC_SLICING
+#undef TF_CKSUM_CUSTOM_BLOCK
+#undef TF_USE_CRC_HW
+#undef TF_USE_ZERO_COPY_RX
+#undef TF_USE_STREAM_RX
+#undef TF_MAX_STREAM_LST
+#undef TF_USE_RANGE_LST
+#undef TF_MAX_RANGE_LST
+#undef TF_USE_EXTERNAL_BUFFERS
+#undef TF_USE_EXTERNAL_LISTENERS
+#undef TF_USE_BATCH
+#undef TF_MAX_BATCH
+#undef TF_BATCH_DATA_LEN
+#undef TF_USE_DISPATCH_QUEUE
+#undef TF_DISPATCH_SLOTS
+#undef TF_DISPATCH_DATA_LEN
+#undef TF_DISPATCH_LANES
+#undef TF_QUEUE_LOAD
+#undef TF_QUEUE_STORE
+#undef TF_QUEUE_SWAP
+#undef TF_USE_HEAD_LOOKBACK
+#undef TF_USE_CLOCK
+#undef TF_TYPE_BUCKETS
+#undef TF_ID_BUCKETS
+#undef TF_TIMER_SLOTS
+
+#endif
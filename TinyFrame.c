@@ -1,4 +1,5 @@
 //---------------------------------------------------------------------------
+#define TF_KEEP_PREFIX // Giữ tên có prefix và cấu hình sau khi include header | Keep the prefixed names and config after the header
 #include "TinyFrame.h"
 #include <stdlib.h> // - cho malloc() nếu constructor động được sử dụng | for malloc() if dynamic constructor is used
 //---------------------------------------------------------------------------
@@ -19,6 +20,63 @@
             return false; \
     } while (0) // Thử thực hiện hàm, trả về false nếu thất bại | Try function, return false if failed
 
+// Số byte checksum trên đường truyền | Nr of checksum bytes on the wire
+#if TF_CKSUM_TYPE == TF_CKSUM_NONE
+#define TF_CKSUM_BYTES 0u
+#else
+#define TF_CKSUM_BYTES ((uint32_t)sizeof(TF_CKSUM))
+#endif
+
+// Số byte header sau SOF | Nr of header bytes after the SOF
+#define TF_HEAD_BYTES (TF_ID_BYTES + TF_LEN_BYTES + TF_TYPE_BYTES + TF_CKSUM_BYTES)
+
+// Dung lượng buffer Rx / Tx của instance | Rx / Tx buffer capacity of the instance
+#if TF_USE_EXTERNAL_BUFFERS
+#define TF_RX_CAP(tf) ((tf)->data_size)
+#define TF_TX_CAP(tf) ((tf)->sendbuf_size)
+#else
+#define TF_RX_CAP(tf) ((uint32_t)TF_MAX_PAYLOAD_RX)
+#define TF_TX_CAP(tf) ((uint32_t)TF_SENDBUF_LEN)
+#endif
+
+// Số slot listener của instance | Listener slot counts of the instance
+#if TF_USE_EXTERNAL_LISTENERS
+#define TF_ID_LST_CAP(tf) ((tf)->max_id_lst)
+#define TF_TYPE_LST_CAP(tf) ((tf)->max_type_lst)
+#define TF_GEN_LST_CAP(tf) ((tf)->max_generic_lst)
+#define TF_ID_BUCKET_MASK(tf) ((tf)->id_mask)
+#else
+#define TF_ID_LST_CAP(tf) TF_MAX_ID_LST
+#define TF_TYPE_LST_CAP(tf) TF_MAX_TYPE_LST
+#define TF_GEN_LST_CAP(tf) TF_MAX_GEN_LST
+#define TF_ID_BUCKET_MASK(tf) (TF_ID_BUCKETS - 1u)
+#endif
+// 1-byte types always use the direct-mapped table
+#if TF_USE_EXTERNAL_LISTENERS && TF_TYPE_BYTES > 1
+#define TF_TYPE_BUCKET_MASK(tf) ((tf)->type_mask)
+#else
+#define TF_TYPE_BUCKET_MASK(tf) (TF_TYPE_BUCKETS - 1u)
+#endif
+
+// Parser timeout. With TF_USE_CLOCK it's checked once per TF_Accept() / TF_AcceptChar() call
+// against the time of the previous call, the byte-level checks are compiled out.
+#if TF_USE_CLOCK
+#define PARS_TIMED_OUT(tf) false
+#define PARS_TOUCH(tf) ((void)0)
+#elif TF_USE_DISPATCH_QUEUE
+// TF_Tick() runs on another thread than the parser, it only advances tf->tick_count and the parser
+// compares it with the count at its last received bytes
+#define PARS_TIMED_OUT(tf) \
+    ((TF_TICKS)(TF_QUEUE_LOAD(&(tf)->tick_count) - (tf)->parser_timeout_ticks) >= TF_PARSER_TIMEOUT_TICKS)
+#define PARS_TOUCH(tf) ((tf)->parser_timeout_ticks = TF_QUEUE_LOAD(&(tf)->tick_count))
+#else
+#define PARS_TIMED_OUT(tf) ((tf)->parser_timeout_ticks >= TF_PARSER_TIMEOUT_TICKS)
+#define PARS_TOUCH(tf) ((tf)->parser_timeout_ticks = 0)
+#endif
+
+// Header bytes are kept for a rescan after a header checksum failure
+#define TF_LOOKBACK (TF_USE_HEAD_LOOKBACK && TF_CKSUM_TYPE != TF_CKSUM_NONE)
+
 // Mask phụ thuộc kiểu cho thao tác bit trong trường ID | Type-dependent masks for bit manipulation in the ID field
 #define TF_ID_MASK (TF_ID)(((TF_ID)1 << (sizeof(TF_ID) * 8 - 1)) - 1) // Mask cho phần ID | Mask for ID part
 #define TF_ID_PEERBIT (TF_ID)((TF_ID)1 << ((sizeof(TF_ID) * 8) - 1))  // Bit peer trong ID | Peer bit in ID
@@ -51,8 +109,115 @@ static void TF_ReleaseTx(TinyFrame *tf)
 }
 #endif
 
+#if TF_USE_DISPATCH_QUEUE
+// Positions of the dispatch queue are shared between the parser and TF_Dispatch(): loads acquire, stores release.
+// TF_QUEUE_SWAP exchanges a lane flag (acquire + release) and gives the old value.
+// Other compilers can supply TF_QUEUE_LOAD / TF_QUEUE_STORE / TF_QUEUE_SWAP in TF_Config.h.
+#ifndef TF_QUEUE_LOAD
+#if defined(__GNUC__)
+#define TF_QUEUE_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define TF_QUEUE_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+#error Cần định nghĩa TF_QUEUE_LOAD / TF_QUEUE_STORE cho compiler này | TF_QUEUE_LOAD / TF_QUEUE_STORE must be defined for this compiler
+#endif
+#endif
+#if TF_DISPATCH_LANES > 1 && !defined(TF_QUEUE_SWAP)
+#if defined(__GNUC__)
+#define TF_QUEUE_SWAP(p, v) __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#else
+#error Cần định nghĩa TF_QUEUE_SWAP cho compiler này | TF_QUEUE_SWAP must be defined for this compiler
+#endif
+#endif
+#endif
+
+// Listener tables are shared by the TF_Dispatch() workers when there are several lanes
+#if TF_USE_DISPATCH_QUEUE && TF_DISPATCH_LANES > 1
+#define LST_LOCK(tf) TF_LockListeners(tf)
+#define LST_UNLOCK(tf) TF_UnlockListeners(tf)
+#else
+#define LST_LOCK(tf) ((void)0)
+#define LST_UNLOCK(tf) ((void)0)
+#endif
+
 // region Checksums - Các hàm tính checksum
 
+// CRC16 / CRC32 folding with carry-less multiplication (PCLMULQDQ), used if the CPU has it
+#if TF_USE_CRC_HW && (TF_CKSUM_TYPE == TF_CKSUM_CRC16 || TF_CKSUM_TYPE == TF_CKSUM_CRC32) && \
+    (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <wmmintrin.h>
+#define TF_CRC_CLMUL
+
+#define CLMUL_FOLD(x, k, d) \
+    _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128((x), (k), 0x00), _mm_clmulepi64_si128((x), (k), 0x11)), (d))
+
+/** The CPU has PCLMULQDQ */
+static bool have_pclmul(void)
+{
+    // 0 = not checked yet, 1 = no, 2 = yes; checked once, not on every block
+    static int pclmul;
+    int has = __atomic_load_n(&pclmul, __ATOMIC_RELAXED);
+    if (has == 0)
+    {
+        has = __builtin_cpu_supports("pclmul") ? 2 : 1;
+        __atomic_store_n(&pclmul, has, __ATOMIC_RELAXED);
+    }
+    return has == 2;
+}
+
+/**
+ * Fold a block of data into 16 bytes with the same CRC (any reflected CRC up to 32 bits).
+ *
+ * A 16-byte chunk V followed by 16 bytes D is replaced by (V * x^128 mod P) ^ D, which leaves
+ * the CRC unchanged. The constants are x^n mod P for n = 4*128+64, 4*128, 128+64 and 128,
+ * each times x^-1 to make up for the bit-reflected product, stored bit-reflected in 64 bits.
+ *
+ * @param c - CRC state, mixed into the first bytes
+ * @param buf - data, at least 64 bytes
+ * @param len - data length
+ * @param k - folding constants
+ * @param out - 16 bytes whose CRC from a zero state equals the CRC of the consumed data
+ * @return nr of bytes consumed, a multiple of 16
+ */
+__attribute__((target("pclmul,sse2"))) static uint32_t crc_fold_clmul(uint32_t c, const uint8_t *buf, uint32_t len,
+                                                                      const uint64_t k[4], uint8_t out[16])
+{
+    const __m128i k4 = _mm_set_epi64x((long long)k[1], (long long)k[0]); // fold by 4 blocks
+    const __m128i k1 = _mm_set_epi64x((long long)k[3], (long long)k[2]); // fold by 1 block
+    __m128i x0 = _mm_loadu_si128((const __m128i *)buf);
+    __m128i x1 = _mm_loadu_si128((const __m128i *)(buf + 16));
+    __m128i x2 = _mm_loadu_si128((const __m128i *)(buf + 32));
+    __m128i x3 = _mm_loadu_si128((const __m128i *)(buf + 48));
+    uint32_t left = len - 64;
+
+    x0 = _mm_xor_si128(x0, _mm_cvtsi32_si128((int)c));
+    buf += 64;
+
+    while (left >= 64)
+    {
+        x0 = CLMUL_FOLD(x0, k4, _mm_loadu_si128((const __m128i *)buf));
+        x1 = CLMUL_FOLD(x1, k4, _mm_loadu_si128((const __m128i *)(buf + 16)));
+        x2 = CLMUL_FOLD(x2, k4, _mm_loadu_si128((const __m128i *)(buf + 32)));
+        x3 = CLMUL_FOLD(x3, k4, _mm_loadu_si128((const __m128i *)(buf + 48)));
+        buf += 64;
+        left -= 64;
+    }
+
+    x1 = CLMUL_FOLD(x0, k1, x1);
+    x2 = CLMUL_FOLD(x1, k1, x2);
+    x3 = CLMUL_FOLD(x2, k1, x3);
+
+    while (left >= 16)
+    {
+        x3 = CLMUL_FOLD(x3, k1, _mm_loadu_si128((const __m128i *)buf));
+        buf += 16;
+        left -= 16;
+    }
+
+    _mm_storeu_si128((__m128i *)out, x3);
+    return len - left;
+}
+#endif
+
 // Không có checksum | No checksum
 #if TF_CKSUM_TYPE == TF_CKSUM_NONE
 
@@ -92,28 +257,160 @@ static TF_CKSUM TF_CksumEnd(TF_CKSUM cksum)
 // CRC8 checksum (Dallas/Maxim 1-wire)
 #elif TF_CKSUM_TYPE == TF_CKSUM_CRC8
 
-// Tính CRC8 từ một byte dữ liệu | Calculate CRC8 from one data byte
-static inline uint8_t crc8_bits(uint8_t data)
-{
-    uint8_t crc = 0;
-    if (data & 1)
-        crc ^= 0x5e; // Bit 0
-    if (data & 2)
-        crc ^= 0xbc; // Bit 1
-    if (data & 4)
-        crc ^= 0x61; // Bit 2
-    if (data & 8)
-        crc ^= 0xc2; // Bit 3
-    if (data & 0x10)
-        crc ^= 0x9d; // Bit 4
-    if (data & 0x20)
-        crc ^= 0x23; // Bit 5
-    if (data & 0x40)
-        crc ^= 0x46; // Bit 6
-    if (data & 0x80)
-        crc ^= 0x8c; // Bit 7
-    return crc;
-}
+/** CRC table for the CRC-8 (Dallas/Maxim). The poly is 0x31 (x^8 + x^5 + x^4 + 1), reflected 0x8C */
+static const uint8_t crc8_table[256] = {
+    0x00, 0x5e, 0xbc, 0xe2, 0x61, 0x3f, 0xdd, 0x83, 0xc2, 0x9c, 0x7e, 0x20, 0xa3, 0xfd, 0x1f, 0x41,
+    0x9d, 0xc3, 0x21, 0x7f, 0xfc, 0xa2, 0x40, 0x1e, 0x5f, 0x01, 0xe3, 0xbd, 0x3e, 0x60, 0x82, 0xdc,
+    0x23, 0x7d, 0x9f, 0xc1, 0x42, 0x1c, 0xfe, 0xa0, 0xe1, 0xbf, 0x5d, 0x03, 0x80, 0xde, 0x3c, 0x62,
+    0xbe, 0xe0, 0x02, 0x5c, 0xdf, 0x81, 0x63, 0x3d, 0x7c, 0x22, 0xc0, 0x9e, 0x1d, 0x43, 0xa1, 0xff,
+    0x46, 0x18, 0xfa, 0xa4, 0x27, 0x79, 0x9b, 0xc5, 0x84, 0xda, 0x38, 0x66, 0xe5, 0xbb, 0x59, 0x07,
+    0xdb, 0x85, 0x67, 0x39, 0xba, 0xe4, 0x06, 0x58, 0x19, 0x47, 0xa5, 0xfb, 0x78, 0x26, 0xc4, 0x9a,
+    0x65, 0x3b, 0xd9, 0x87, 0x04, 0x5a, 0xb8, 0xe6, 0xa7, 0xf9, 0x1b, 0x45, 0xc6, 0x98, 0x7a, 0x24,
+    0xf8, 0xa6, 0x44, 0x1a, 0x99, 0xc7, 0x25, 0x7b, 0x3a, 0x64, 0x86, 0xd8, 0x5b, 0x05, 0xe7, 0xb9,
+    0x8c, 0xd2, 0x30, 0x6e, 0xed, 0xb3, 0x51, 0x0f, 0x4e, 0x10, 0xf2, 0xac, 0x2f, 0x71, 0x93, 0xcd,
+    0x11, 0x4f, 0xad, 0xf3, 0x70, 0x2e, 0xcc, 0x92, 0xd3, 0x8d, 0x6f, 0x31, 0xb2, 0xec, 0x0e, 0x50,
+    0xaf, 0xf1, 0x13, 0x4d, 0xce, 0x90, 0x72, 0x2c, 0x6d, 0x33, 0xd1, 0x8f, 0x0c, 0x52, 0xb0, 0xee,
+    0x32, 0x6c, 0x8e, 0xd0, 0x53, 0x0d, 0xef, 0xb1, 0xf0, 0xae, 0x4c, 0x12, 0x91, 0xcf, 0x2d, 0x73,
+    0xca, 0x94, 0x76, 0x28, 0xab, 0xf5, 0x17, 0x49, 0x08, 0x56, 0xb4, 0xea, 0x69, 0x37, 0xd5, 0x8b,
+    0x57, 0x09, 0xeb, 0xb5, 0x36, 0x68, 0x8a, 0xd4, 0x95, 0xcb, 0x29, 0x77, 0xf4, 0xaa, 0x48, 0x16,
+    0xe9, 0xb7, 0x55, 0x0b, 0x88, 0xd6, 0x34, 0x6a, 0x2b, 0x75, 0x97, 0xc9, 0x4a, 0x14, 0xf6, 0xa8,
+    0x74, 0x2a, 0xc8, 0x96, 0x15, 0x4b, 0xa9, 0xf7, 0xb6, 0xe8, 0x0a, 0x54, 0xd7, 0x89, 0x6b, 0x35
+};
+
+#if TF_CRC_SLICING > 1
+// Tables for slicing-by-4/8: crc8_slice[k - 1][i] is the CRC of byte i followed by k zero bytes,
+// generated as T[k][i] = crc8_table[T[k-1][i]] (the state fits in one byte)
+static const uint8_t crc8_slice[TF_CRC_SLICING - 1][256] = {
+    {
+        0x00, 0xc4, 0x91, 0x55, 0x3b, 0xff, 0xaa, 0x6e, 0x76, 0xb2, 0xe7, 0x23, 0x4d, 0x89, 0xdc, 0x18,
+        0xec, 0x28, 0x7d, 0xb9, 0xd7, 0x13, 0x46, 0x82, 0x9a, 0x5e, 0x0b, 0xcf, 0xa1, 0x65, 0x30, 0xf4,
+        0xc1, 0x05, 0x50, 0x94, 0xfa, 0x3e, 0x6b, 0xaf, 0xb7, 0x73, 0x26, 0xe2, 0x8c, 0x48, 0x1d, 0xd9,
+        0x2d, 0xe9, 0xbc, 0x78, 0x16, 0xd2, 0x87, 0x43, 0x5b, 0x9f, 0xca, 0x0e, 0x60, 0xa4, 0xf1, 0x35,
+        0x9b, 0x5f, 0x0a, 0xce, 0xa0, 0x64, 0x31, 0xf5, 0xed, 0x29, 0x7c, 0xb8, 0xd6, 0x12, 0x47, 0x83,
+        0x77, 0xb3, 0xe6, 0x22, 0x4c, 0x88, 0xdd, 0x19, 0x01, 0xc5, 0x90, 0x54, 0x3a, 0xfe, 0xab, 0x6f,
+        0x5a, 0x9e, 0xcb, 0x0f, 0x61, 0xa5, 0xf0, 0x34, 0x2c, 0xe8, 0xbd, 0x79, 0x17, 0xd3, 0x86, 0x42,
+        0xb6, 0x72, 0x27, 0xe3, 0x8d, 0x49, 0x1c, 0xd8, 0xc0, 0x04, 0x51, 0x95, 0xfb, 0x3f, 0x6a, 0xae,
+        0x2f, 0xeb, 0xbe, 0x7a, 0x14, 0xd0, 0x85, 0x41, 0x59, 0x9d, 0xc8, 0x0c, 0x62, 0xa6, 0xf3, 0x37,
+        0xc3, 0x07, 0x52, 0x96, 0xf8, 0x3c, 0x69, 0xad, 0xb5, 0x71, 0x24, 0xe0, 0x8e, 0x4a, 0x1f, 0xdb,
+        0xee, 0x2a, 0x7f, 0xbb, 0xd5, 0x11, 0x44, 0x80, 0x98, 0x5c, 0x09, 0xcd, 0xa3, 0x67, 0x32, 0xf6,
+        0x02, 0xc6, 0x93, 0x57, 0x39, 0xfd, 0xa8, 0x6c, 0x74, 0xb0, 0xe5, 0x21, 0x4f, 0x8b, 0xde, 0x1a,
+        0xb4, 0x70, 0x25, 0xe1, 0x8f, 0x4b, 0x1e, 0xda, 0xc2, 0x06, 0x53, 0x97, 0xf9, 0x3d, 0x68, 0xac,
+        0x58, 0x9c, 0xc9, 0x0d, 0x63, 0xa7, 0xf2, 0x36, 0x2e, 0xea, 0xbf, 0x7b, 0x15, 0xd1, 0x84, 0x40,
+        0x75, 0xb1, 0xe4, 0x20, 0x4e, 0x8a, 0xdf, 0x1b, 0x03, 0xc7, 0x92, 0x56, 0x38, 0xfc, 0xa9, 0x6d,
+        0x99, 0x5d, 0x08, 0xcc, 0xa2, 0x66, 0x33, 0xf7, 0xef, 0x2b, 0x7e, 0xba, 0xd4, 0x10, 0x45, 0x81
+    },
+    {
+        0x00, 0xab, 0x4f, 0xe4, 0x9e, 0x35, 0xd1, 0x7a, 0x25, 0x8e, 0x6a, 0xc1, 0xbb, 0x10, 0xf4, 0x5f,
+        0x4a, 0xe1, 0x05, 0xae, 0xd4, 0x7f, 0x9b, 0x30, 0x6f, 0xc4, 0x20, 0x8b, 0xf1, 0x5a, 0xbe, 0x15,
+        0x94, 0x3f, 0xdb, 0x70, 0x0a, 0xa1, 0x45, 0xee, 0xb1, 0x1a, 0xfe, 0x55, 0x2f, 0x84, 0x60, 0xcb,
+        0xde, 0x75, 0x91, 0x3a, 0x40, 0xeb, 0x0f, 0xa4, 0xfb, 0x50, 0xb4, 0x1f, 0x65, 0xce, 0x2a, 0x81,
+        0x31, 0x9a, 0x7e, 0xd5, 0xaf, 0x04, 0xe0, 0x4b, 0x14, 0xbf, 0x5b, 0xf0, 0x8a, 0x21, 0xc5, 0x6e,
+        0x7b, 0xd0, 0x34, 0x9f, 0xe5, 0x4e, 0xaa, 0x01, 0x5e, 0xf5, 0x11, 0xba, 0xc0, 0x6b, 0x8f, 0x24,
+        0xa5, 0x0e, 0xea, 0x41, 0x3b, 0x90, 0x74, 0xdf, 0x80, 0x2b, 0xcf, 0x64, 0x1e, 0xb5, 0x51, 0xfa,
+        0xef, 0x44, 0xa0, 0x0b, 0x71, 0xda, 0x3e, 0x95, 0xca, 0x61, 0x85, 0x2e, 0x54, 0xff, 0x1b, 0xb0,
+        0x62, 0xc9, 0x2d, 0x86, 0xfc, 0x57, 0xb3, 0x18, 0x47, 0xec, 0x08, 0xa3, 0xd9, 0x72, 0x96, 0x3d,
+        0x28, 0x83, 0x67, 0xcc, 0xb6, 0x1d, 0xf9, 0x52, 0x0d, 0xa6, 0x42, 0xe9, 0x93, 0x38, 0xdc, 0x77,
+        0xf6, 0x5d, 0xb9, 0x12, 0x68, 0xc3, 0x27, 0x8c, 0xd3, 0x78, 0x9c, 0x37, 0x4d, 0xe6, 0x02, 0xa9,
+        0xbc, 0x17, 0xf3, 0x58, 0x22, 0x89, 0x6d, 0xc6, 0x99, 0x32, 0xd6, 0x7d, 0x07, 0xac, 0x48, 0xe3,
+        0x53, 0xf8, 0x1c, 0xb7, 0xcd, 0x66, 0x82, 0x29, 0x76, 0xdd, 0x39, 0x92, 0xe8, 0x43, 0xa7, 0x0c,
+        0x19, 0xb2, 0x56, 0xfd, 0x87, 0x2c, 0xc8, 0x63, 0x3c, 0x97, 0x73, 0xd8, 0xa2, 0x09, 0xed, 0x46,
+        0xc7, 0x6c, 0x88, 0x23, 0x59, 0xf2, 0x16, 0xbd, 0xe2, 0x49, 0xad, 0x06, 0x7c, 0xd7, 0x33, 0x98,
+        0x8d, 0x26, 0xc2, 0x69, 0x13, 0xb8, 0x5c, 0xf7, 0xa8, 0x03, 0xe7, 0x4c, 0x36, 0x9d, 0x79, 0xd2
+    },
+    {
+        0x00, 0x8f, 0x07, 0x88, 0x0e, 0x81, 0x09, 0x86, 0x1c, 0x93, 0x1b, 0x94, 0x12, 0x9d, 0x15, 0x9a,
+        0x38, 0xb7, 0x3f, 0xb0, 0x36, 0xb9, 0x31, 0xbe, 0x24, 0xab, 0x23, 0xac, 0x2a, 0xa5, 0x2d, 0xa2,
+        0x70, 0xff, 0x77, 0xf8, 0x7e, 0xf1, 0x79, 0xf6, 0x6c, 0xe3, 0x6b, 0xe4, 0x62, 0xed, 0x65, 0xea,
+        0x48, 0xc7, 0x4f, 0xc0, 0x46, 0xc9, 0x41, 0xce, 0x54, 0xdb, 0x53, 0xdc, 0x5a, 0xd5, 0x5d, 0xd2,
+        0xe0, 0x6f, 0xe7, 0x68, 0xee, 0x61, 0xe9, 0x66, 0xfc, 0x73, 0xfb, 0x74, 0xf2, 0x7d, 0xf5, 0x7a,
+        0xd8, 0x57, 0xdf, 0x50, 0xd6, 0x59, 0xd1, 0x5e, 0xc4, 0x4b, 0xc3, 0x4c, 0xca, 0x45, 0xcd, 0x42,
+        0x90, 0x1f, 0x97, 0x18, 0x9e, 0x11, 0x99, 0x16, 0x8c, 0x03, 0x8b, 0x04, 0x82, 0x0d, 0x85, 0x0a,
+        0xa8, 0x27, 0xaf, 0x20, 0xa6, 0x29, 0xa1, 0x2e, 0xb4, 0x3b, 0xb3, 0x3c, 0xba, 0x35, 0xbd, 0x32,
+        0xd9, 0x56, 0xde, 0x51, 0xd7, 0x58, 0xd0, 0x5f, 0xc5, 0x4a, 0xc2, 0x4d, 0xcb, 0x44, 0xcc, 0x43,
+        0xe1, 0x6e, 0xe6, 0x69, 0xef, 0x60, 0xe8, 0x67, 0xfd, 0x72, 0xfa, 0x75, 0xf3, 0x7c, 0xf4, 0x7b,
+        0xa9, 0x26, 0xae, 0x21, 0xa7, 0x28, 0xa0, 0x2f, 0xb5, 0x3a, 0xb2, 0x3d, 0xbb, 0x34, 0xbc, 0x33,
+        0x91, 0x1e, 0x96, 0x19, 0x9f, 0x10, 0x98, 0x17, 0x8d, 0x02, 0x8a, 0x05, 0x83, 0x0c, 0x84, 0x0b,
+        0x39, 0xb6, 0x3e, 0xb1, 0x37, 0xb8, 0x30, 0xbf, 0x25, 0xaa, 0x22, 0xad, 0x2b, 0xa4, 0x2c, 0xa3,
+        0x01, 0x8e, 0x06, 0x89, 0x0f, 0x80, 0x08, 0x87, 0x1d, 0x92, 0x1a, 0x95, 0x13, 0x9c, 0x14, 0x9b,
+        0x49, 0xc6, 0x4e, 0xc1, 0x47, 0xc8, 0x40, 0xcf, 0x55, 0xda, 0x52, 0xdd, 0x5b, 0xd4, 0x5c, 0xd3,
+        0x71, 0xfe, 0x76, 0xf9, 0x7f, 0xf0, 0x78, 0xf7, 0x6d, 0xe2, 0x6a, 0xe5, 0x63, 0xec, 0x64, 0xeb
+    },
+#if TF_CRC_SLICING == 8
+    {
+        0x00, 0xcd, 0x83, 0x4e, 0x1f, 0xd2, 0x9c, 0x51, 0x3e, 0xf3, 0xbd, 0x70, 0x21, 0xec, 0xa2, 0x6f,
+        0x7c, 0xb1, 0xff, 0x32, 0x63, 0xae, 0xe0, 0x2d, 0x42, 0x8f, 0xc1, 0x0c, 0x5d, 0x90, 0xde, 0x13,
+        0xf8, 0x35, 0x7b, 0xb6, 0xe7, 0x2a, 0x64, 0xa9, 0xc6, 0x0b, 0x45, 0x88, 0xd9, 0x14, 0x5a, 0x97,
+        0x84, 0x49, 0x07, 0xca, 0x9b, 0x56, 0x18, 0xd5, 0xba, 0x77, 0x39, 0xf4, 0xa5, 0x68, 0x26, 0xeb,
+        0xe9, 0x24, 0x6a, 0xa7, 0xf6, 0x3b, 0x75, 0xb8, 0xd7, 0x1a, 0x54, 0x99, 0xc8, 0x05, 0x4b, 0x86,
+        0x95, 0x58, 0x16, 0xdb, 0x8a, 0x47, 0x09, 0xc4, 0xab, 0x66, 0x28, 0xe5, 0xb4, 0x79, 0x37, 0xfa,
+        0x11, 0xdc, 0x92, 0x5f, 0x0e, 0xc3, 0x8d, 0x40, 0x2f, 0xe2, 0xac, 0x61, 0x30, 0xfd, 0xb3, 0x7e,
+        0x6d, 0xa0, 0xee, 0x23, 0x72, 0xbf, 0xf1, 0x3c, 0x53, 0x9e, 0xd0, 0x1d, 0x4c, 0x81, 0xcf, 0x02,
+        0xcb, 0x06, 0x48, 0x85, 0xd4, 0x19, 0x57, 0x9a, 0xf5, 0x38, 0x76, 0xbb, 0xea, 0x27, 0x69, 0xa4,
+        0xb7, 0x7a, 0x34, 0xf9, 0xa8, 0x65, 0x2b, 0xe6, 0x89, 0x44, 0x0a, 0xc7, 0x96, 0x5b, 0x15, 0xd8,
+        0x33, 0xfe, 0xb0, 0x7d, 0x2c, 0xe1, 0xaf, 0x62, 0x0d, 0xc0, 0x8e, 0x43, 0x12, 0xdf, 0x91, 0x5c,
+        0x4f, 0x82, 0xcc, 0x01, 0x50, 0x9d, 0xd3, 0x1e, 0x71, 0xbc, 0xf2, 0x3f, 0x6e, 0xa3, 0xed, 0x20,
+        0x22, 0xef, 0xa1, 0x6c, 0x3d, 0xf0, 0xbe, 0x73, 0x1c, 0xd1, 0x9f, 0x52, 0x03, 0xce, 0x80, 0x4d,
+        0x5e, 0x93, 0xdd, 0x10, 0x41, 0x8c, 0xc2, 0x0f, 0x60, 0xad, 0xe3, 0x2e, 0x7f, 0xb2, 0xfc, 0x31,
+        0xda, 0x17, 0x59, 0x94, 0xc5, 0x08, 0x46, 0x8b, 0xe4, 0x29, 0x67, 0xaa, 0xfb, 0x36, 0x78, 0xb5,
+        0xa6, 0x6b, 0x25, 0xe8, 0xb9, 0x74, 0x3a, 0xf7, 0x98, 0x55, 0x1b, 0xd6, 0x87, 0x4a, 0x04, 0xc9
+    },
+    {
+        0x00, 0x37, 0x6e, 0x59, 0xdc, 0xeb, 0xb2, 0x85, 0xa1, 0x96, 0xcf, 0xf8, 0x7d, 0x4a, 0x13, 0x24,
+        0x5b, 0x6c, 0x35, 0x02, 0x87, 0xb0, 0xe9, 0xde, 0xfa, 0xcd, 0x94, 0xa3, 0x26, 0x11, 0x48, 0x7f,
+        0xb6, 0x81, 0xd8, 0xef, 0x6a, 0x5d, 0x04, 0x33, 0x17, 0x20, 0x79, 0x4e, 0xcb, 0xfc, 0xa5, 0x92,
+        0xed, 0xda, 0x83, 0xb4, 0x31, 0x06, 0x5f, 0x68, 0x4c, 0x7b, 0x22, 0x15, 0x90, 0xa7, 0xfe, 0xc9,
+        0x75, 0x42, 0x1b, 0x2c, 0xa9, 0x9e, 0xc7, 0xf0, 0xd4, 0xe3, 0xba, 0x8d, 0x08, 0x3f, 0x66, 0x51,
+        0x2e, 0x19, 0x40, 0x77, 0xf2, 0xc5, 0x9c, 0xab, 0x8f, 0xb8, 0xe1, 0xd6, 0x53, 0x64, 0x3d, 0x0a,
+        0xc3, 0xf4, 0xad, 0x9a, 0x1f, 0x28, 0x71, 0x46, 0x62, 0x55, 0x0c, 0x3b, 0xbe, 0x89, 0xd0, 0xe7,
+        0x98, 0xaf, 0xf6, 0xc1, 0x44, 0x73, 0x2a, 0x1d, 0x39, 0x0e, 0x57, 0x60, 0xe5, 0xd2, 0x8b, 0xbc,
+        0xea, 0xdd, 0x84, 0xb3, 0x36, 0x01, 0x58, 0x6f, 0x4b, 0x7c, 0x25, 0x12, 0x97, 0xa0, 0xf9, 0xce,
+        0xb1, 0x86, 0xdf, 0xe8, 0x6d, 0x5a, 0x03, 0x34, 0x10, 0x27, 0x7e, 0x49, 0xcc, 0xfb, 0xa2, 0x95,
+        0x5c, 0x6b, 0x32, 0x05, 0x80, 0xb7, 0xee, 0xd9, 0xfd, 0xca, 0x93, 0xa4, 0x21, 0x16, 0x4f, 0x78,
+        0x07, 0x30, 0x69, 0x5e, 0xdb, 0xec, 0xb5, 0x82, 0xa6, 0x91, 0xc8, 0xff, 0x7a, 0x4d, 0x14, 0x23,
+        0x9f, 0xa8, 0xf1, 0xc6, 0x43, 0x74, 0x2d, 0x1a, 0x3e, 0x09, 0x50, 0x67, 0xe2, 0xd5, 0x8c, 0xbb,
+        0xc4, 0xf3, 0xaa, 0x9d, 0x18, 0x2f, 0x76, 0x41, 0x65, 0x52, 0x0b, 0x3c, 0xb9, 0x8e, 0xd7, 0xe0,
+        0x29, 0x1e, 0x47, 0x70, 0xf5, 0xc2, 0x9b, 0xac, 0x88, 0xbf, 0xe6, 0xd1, 0x54, 0x63, 0x3a, 0x0d,
+        0x72, 0x45, 0x1c, 0x2b, 0xae, 0x99, 0xc0, 0xf7, 0xd3, 0xe4, 0xbd, 0x8a, 0x0f, 0x38, 0x61, 0x56
+    },
+    {
+        0x00, 0x3d, 0x7a, 0x47, 0xf4, 0xc9, 0x8e, 0xb3, 0xf1, 0xcc, 0x8b, 0xb6, 0x05, 0x38, 0x7f, 0x42,
+        0xfb, 0xc6, 0x81, 0xbc, 0x0f, 0x32, 0x75, 0x48, 0x0a, 0x37, 0x70, 0x4d, 0xfe, 0xc3, 0x84, 0xb9,
+        0xef, 0xd2, 0x95, 0xa8, 0x1b, 0x26, 0x61, 0x5c, 0x1e, 0x23, 0x64, 0x59, 0xea, 0xd7, 0x90, 0xad,
+        0x14, 0x29, 0x6e, 0x53, 0xe0, 0xdd, 0x9a, 0xa7, 0xe5, 0xd8, 0x9f, 0xa2, 0x11, 0x2c, 0x6b, 0x56,
+        0xc7, 0xfa, 0xbd, 0x80, 0x33, 0x0e, 0x49, 0x74, 0x36, 0x0b, 0x4c, 0x71, 0xc2, 0xff, 0xb8, 0x85,
+        0x3c, 0x01, 0x46, 0x7b, 0xc8, 0xf5, 0xb2, 0x8f, 0xcd, 0xf0, 0xb7, 0x8a, 0x39, 0x04, 0x43, 0x7e,
+        0x28, 0x15, 0x52, 0x6f, 0xdc, 0xe1, 0xa6, 0x9b, 0xd9, 0xe4, 0xa3, 0x9e, 0x2d, 0x10, 0x57, 0x6a,
+        0xd3, 0xee, 0xa9, 0x94, 0x27, 0x1a, 0x5d, 0x60, 0x22, 0x1f, 0x58, 0x65, 0xd6, 0xeb, 0xac, 0x91,
+        0x97, 0xaa, 0xed, 0xd0, 0x63, 0x5e, 0x19, 0x24, 0x66, 0x5b, 0x1c, 0x21, 0x92, 0xaf, 0xe8, 0xd5,
+        0x6c, 0x51, 0x16, 0x2b, 0x98, 0xa5, 0xe2, 0xdf, 0x9d, 0xa0, 0xe7, 0xda, 0x69, 0x54, 0x13, 0x2e,
+        0x78, 0x45, 0x02, 0x3f, 0x8c, 0xb1, 0xf6, 0xcb, 0x89, 0xb4, 0xf3, 0xce, 0x7d, 0x40, 0x07, 0x3a,
+        0x83, 0xbe, 0xf9, 0xc4, 0x77, 0x4a, 0x0d, 0x30, 0x72, 0x4f, 0x08, 0x35, 0x86, 0xbb, 0xfc, 0xc1,
+        0x50, 0x6d, 0x2a, 0x17, 0xa4, 0x99, 0xde, 0xe3, 0xa1, 0x9c, 0xdb, 0xe6, 0x55, 0x68, 0x2f, 0x12,
+        0xab, 0x96, 0xd1, 0xec, 0x5f, 0x62, 0x25, 0x18, 0x5a, 0x67, 0x20, 0x1d, 0xae, 0x93, 0xd4, 0xe9,
+        0xbf, 0x82, 0xc5, 0xf8, 0x4b, 0x76, 0x31, 0x0c, 0x4e, 0x73, 0x34, 0x09, 0xba, 0x87, 0xc0, 0xfd,
+        0x44, 0x79, 0x3e, 0x03, 0xb0, 0x8d, 0xca, 0xf7, 0xb5, 0x88, 0xcf, 0xf2, 0x41, 0x7c, 0x3b, 0x06
+    },
+    {
+        0x00, 0x43, 0x86, 0xc5, 0x15, 0x56, 0x93, 0xd0, 0x2a, 0x69, 0xac, 0xef, 0x3f, 0x7c, 0xb9, 0xfa,
+        0x54, 0x17, 0xd2, 0x91, 0x41, 0x02, 0xc7, 0x84, 0x7e, 0x3d, 0xf8, 0xbb, 0x6b, 0x28, 0xed, 0xae,
+        0xa8, 0xeb, 0x2e, 0x6d, 0xbd, 0xfe, 0x3b, 0x78, 0x82, 0xc1, 0x04, 0x47, 0x97, 0xd4, 0x11, 0x52,
+        0xfc, 0xbf, 0x7a, 0x39, 0xe9, 0xaa, 0x6f, 0x2c, 0xd6, 0x95, 0x50, 0x13, 0xc3, 0x80, 0x45, 0x06,
+        0x49, 0x0a, 0xcf, 0x8c, 0x5c, 0x1f, 0xda, 0x99, 0x63, 0x20, 0xe5, 0xa6, 0x76, 0x35, 0xf0, 0xb3,
+        0x1d, 0x5e, 0x9b, 0xd8, 0x08, 0x4b, 0x8e, 0xcd, 0x37, 0x74, 0xb1, 0xf2, 0x22, 0x61, 0xa4, 0xe7,
+        0xe1, 0xa2, 0x67, 0x24, 0xf4, 0xb7, 0x72, 0x31, 0xcb, 0x88, 0x4d, 0x0e, 0xde, 0x9d, 0x58, 0x1b,
+        0xb5, 0xf6, 0x33, 0x70, 0xa0, 0xe3, 0x26, 0x65, 0x9f, 0xdc, 0x19, 0x5a, 0x8a, 0xc9, 0x0c, 0x4f,
+        0x92, 0xd1, 0x14, 0x57, 0x87, 0xc4, 0x01, 0x42, 0xb8, 0xfb, 0x3e, 0x7d, 0xad, 0xee, 0x2b, 0x68,
+        0xc6, 0x85, 0x40, 0x03, 0xd3, 0x90, 0x55, 0x16, 0xec, 0xaf, 0x6a, 0x29, 0xf9, 0xba, 0x7f, 0x3c,
+        0x3a, 0x79, 0xbc, 0xff, 0x2f, 0x6c, 0xa9, 0xea, 0x10, 0x53, 0x96, 0xd5, 0x05, 0x46, 0x83, 0xc0,
+        0x6e, 0x2d, 0xe8, 0xab, 0x7b, 0x38, 0xfd, 0xbe, 0x44, 0x07, 0xc2, 0x81, 0x51, 0x12, 0xd7, 0x94,
+        0xdb, 0x98, 0x5d, 0x1e, 0xce, 0x8d, 0x48, 0x0b, 0xf1, 0xb2, 0x77, 0x34, 0xe4, 0xa7, 0x62, 0x21,
+        0x8f, 0xcc, 0x09, 0x4a, 0x9a, 0xd9, 0x1c, 0x5f, 0xa5, 0xe6, 0x23, 0x60, 0xb0, 0xf3, 0x36, 0x75,
+        0x73, 0x30, 0xf5, 0xb6, 0x66, 0x25, 0xe0, 0xa3, 0x59, 0x1a, 0xdf, 0x9c, 0x4c, 0x0f, 0xca, 0x89,
+        0x27, 0x64, 0xa1, 0xe2, 0x32, 0x71, 0xb4, 0xf7, 0x0d, 0x4e, 0x8b, 0xc8, 0x18, 0x5b, 0x9e, 0xdd
+    },
+#endif
+};
+#endif
 
 static TF_CKSUM TF_CksumStart(void)
 {
@@ -122,9 +419,38 @@ static TF_CKSUM TF_CksumStart(void)
 
 static TF_CKSUM TF_CksumAdd(TF_CKSUM cksum, uint8_t byte)
 {
-    return crc8_bits(byte ^ cksum);
+    return crc8_table[cksum ^ byte];
 } // Cập nhật CRC8 | Update CRC8
 
+#if TF_CRC_SLICING > 1
+#define TF_HAS_CKSUM_BLOCK
+
+/** Add a block of bytes, 8 or 4 per step */
+static TF_CKSUM TF_CksumAddBlock(TF_CKSUM c, const uint8_t *buf, uint32_t len)
+{
+#if TF_CRC_SLICING == 8
+    while (len >= 8)
+    {
+        c = crc8_slice[6][c ^ buf[0]] ^ crc8_slice[5][buf[1]] ^ crc8_slice[4][buf[2]] ^ crc8_slice[3][buf[3]] ^
+            crc8_slice[2][buf[4]] ^ crc8_slice[1][buf[5]] ^ crc8_slice[0][buf[6]] ^ crc8_table[buf[7]];
+        buf += 8;
+        len -= 8;
+    }
+#endif
+    while (len >= 4)
+    {
+        c = crc8_slice[2][c ^ buf[0]] ^ crc8_slice[1][buf[1]] ^ crc8_slice[0][buf[2]] ^ crc8_table[buf[3]];
+        buf += 4;
+        len -= 4;
+    }
+    while (len--)
+    {
+        c = crc8_table[c ^ *buf++];
+    }
+    return c;
+}
+#endif
+
 static TF_CKSUM TF_CksumEnd(TF_CKSUM cksum)
 {
     return cksum;
@@ -168,6 +494,253 @@ static const uint16_t crc16_table[256] = {
     0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
     0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040};
 
+#if TF_CRC_SLICING > 1
+// Tables for slicing-by-4/8: crc16_slice[k - 1][i] is the CRC of byte i followed by k zero bytes,
+// generated as T[k][i] = (T[k-1][i] >> 8) ^ crc16_table[T[k-1][i] & 0xff]
+static const uint16_t crc16_slice[TF_CRC_SLICING - 1][256] = {
+    {
+        0x0000, 0x9001, 0x6001, 0xF000, 0xC002, 0x5003, 0xA003, 0x3002,
+        0xC007, 0x5006, 0xA006, 0x3007, 0x0005, 0x9004, 0x6004, 0xF005,
+        0xC00D, 0x500C, 0xA00C, 0x300D, 0x000F, 0x900E, 0x600E, 0xF00F,
+        0x000A, 0x900B, 0x600B, 0xF00A, 0xC008, 0x5009, 0xA009, 0x3008,
+        0xC019, 0x5018, 0xA018, 0x3019, 0x001B, 0x901A, 0x601A, 0xF01B,
+        0x001E, 0x901F, 0x601F, 0xF01E, 0xC01C, 0x501D, 0xA01D, 0x301C,
+        0x0014, 0x9015, 0x6015, 0xF014, 0xC016, 0x5017, 0xA017, 0x3016,
+        0xC013, 0x5012, 0xA012, 0x3013, 0x0011, 0x9010, 0x6010, 0xF011,
+        0xC031, 0x5030, 0xA030, 0x3031, 0x0033, 0x9032, 0x6032, 0xF033,
+        0x0036, 0x9037, 0x6037, 0xF036, 0xC034, 0x5035, 0xA035, 0x3034,
+        0x003C, 0x903D, 0x603D, 0xF03C, 0xC03E, 0x503F, 0xA03F, 0x303E,
+        0xC03B, 0x503A, 0xA03A, 0x303B, 0x0039, 0x9038, 0x6038, 0xF039,
+        0x0028, 0x9029, 0x6029, 0xF028, 0xC02A, 0x502B, 0xA02B, 0x302A,
+        0xC02F, 0x502E, 0xA02E, 0x302F, 0x002D, 0x902C, 0x602C, 0xF02D,
+        0xC025, 0x5024, 0xA024, 0x3025, 0x0027, 0x9026, 0x6026, 0xF027,
+        0x0022, 0x9023, 0x6023, 0xF022, 0xC020, 0x5021, 0xA021, 0x3020,
+        0xC061, 0x5060, 0xA060, 0x3061, 0x0063, 0x9062, 0x6062, 0xF063,
+        0x0066, 0x9067, 0x6067, 0xF066, 0xC064, 0x5065, 0xA065, 0x3064,
+        0x006C, 0x906D, 0x606D, 0xF06C, 0xC06E, 0x506F, 0xA06F, 0x306E,
+        0xC06B, 0x506A, 0xA06A, 0x306B, 0x0069, 0x9068, 0x6068, 0xF069,
+        0x0078, 0x9079, 0x6079, 0xF078, 0xC07A, 0x507B, 0xA07B, 0x307A,
+        0xC07F, 0x507E, 0xA07E, 0x307F, 0x007D, 0x907C, 0x607C, 0xF07D,
+        0xC075, 0x5074, 0xA074, 0x3075, 0x0077, 0x9076, 0x6076, 0xF077,
+        0x0072, 0x9073, 0x6073, 0xF072, 0xC070, 0x5071, 0xA071, 0x3070,
+        0x0050, 0x9051, 0x6051, 0xF050, 0xC052, 0x5053, 0xA053, 0x3052,
+        0xC057, 0x5056, 0xA056, 0x3057, 0x0055, 0x9054, 0x6054, 0xF055,
+        0xC05D, 0x505C, 0xA05C, 0x305D, 0x005F, 0x905E, 0x605E, 0xF05F,
+        0x005A, 0x905B, 0x605B, 0xF05A, 0xC058, 0x5059, 0xA059, 0x3058,
+        0xC049, 0x5048, 0xA048, 0x3049, 0x004B, 0x904A, 0x604A, 0xF04B,
+        0x004E, 0x904F, 0x604F, 0xF04E, 0xC04C, 0x504D, 0xA04D, 0x304C,
+        0x0044, 0x9045, 0x6045, 0xF044, 0xC046, 0x5047, 0xA047, 0x3046,
+        0xC043, 0x5042, 0xA042, 0x3043, 0x0041, 0x9040, 0x6040, 0xF041
+    },
+    {
+        0x0000, 0xC051, 0xC0A1, 0x00F0, 0xC141, 0x0110, 0x01E0, 0xC1B1,
+        0xC281, 0x02D0, 0x0220, 0xC271, 0x03C0, 0xC391, 0xC361, 0x0330,
+        0xC501, 0x0550, 0x05A0, 0xC5F1, 0x0440, 0xC411, 0xC4E1, 0x04B0,
+        0x0780, 0xC7D1, 0xC721, 0x0770, 0xC6C1, 0x0690, 0x0660, 0xC631,
+        0xCA01, 0x0A50, 0x0AA0, 0xCAF1, 0x0B40, 0xCB11, 0xCBE1, 0x0BB0,
+        0x0880, 0xC8D1, 0xC821, 0x0870, 0xC9C1, 0x0990, 0x0960, 0xC931,
+        0x0F00, 0xCF51, 0xCFA1, 0x0FF0, 0xCE41, 0x0E10, 0x0EE0, 0xCEB1,
+        0xCD81, 0x0DD0, 0x0D20, 0xCD71, 0x0CC0, 0xCC91, 0xCC61, 0x0C30,
+        0xD401, 0x1450, 0x14A0, 0xD4F1, 0x1540, 0xD511, 0xD5E1, 0x15B0,
+        0x1680, 0xD6D1, 0xD621, 0x1670, 0xD7C1, 0x1790, 0x1760, 0xD731,
+        0x1100, 0xD151, 0xD1A1, 0x11F0, 0xD041, 0x1010, 0x10E0, 0xD0B1,
+        0xD381, 0x13D0, 0x1320, 0xD371, 0x12C0, 0xD291, 0xD261, 0x1230,
+        0x1E00, 0xDE51, 0xDEA1, 0x1EF0, 0xDF41, 0x1F10, 0x1FE0, 0xDFB1,
+        0xDC81, 0x1CD0, 0x1C20, 0xDC71, 0x1DC0, 0xDD91, 0xDD61, 0x1D30,
+        0xDB01, 0x1B50, 0x1BA0, 0xDBF1, 0x1A40, 0xDA11, 0xDAE1, 0x1AB0,
+        0x1980, 0xD9D1, 0xD921, 0x1970, 0xD8C1, 0x1890, 0x1860, 0xD831,
+        0xE801, 0x2850, 0x28A0, 0xE8F1, 0x2940, 0xE911, 0xE9E1, 0x29B0,
+        0x2A80, 0xEAD1, 0xEA21, 0x2A70, 0xEBC1, 0x2B90, 0x2B60, 0xEB31,
+        0x2D00, 0xED51, 0xEDA1, 0x2DF0, 0xEC41, 0x2C10, 0x2CE0, 0xECB1,
+        0xEF81, 0x2FD0, 0x2F20, 0xEF71, 0x2EC0, 0xEE91, 0xEE61, 0x2E30,
+        0x2200, 0xE251, 0xE2A1, 0x22F0, 0xE341, 0x2310, 0x23E0, 0xE3B1,
+        0xE081, 0x20D0, 0x2020, 0xE071, 0x21C0, 0xE191, 0xE161, 0x2130,
+        0xE701, 0x2750, 0x27A0, 0xE7F1, 0x2640, 0xE611, 0xE6E1, 0x26B0,
+        0x2580, 0xE5D1, 0xE521, 0x2570, 0xE4C1, 0x2490, 0x2460, 0xE431,
+        0x3C00, 0xFC51, 0xFCA1, 0x3CF0, 0xFD41, 0x3D10, 0x3DE0, 0xFDB1,
+        0xFE81, 0x3ED0, 0x3E20, 0xFE71, 0x3FC0, 0xFF91, 0xFF61, 0x3F30,
+        0xF901, 0x3950, 0x39A0, 0xF9F1, 0x3840, 0xF811, 0xF8E1, 0x38B0,
+        0x3B80, 0xFBD1, 0xFB21, 0x3B70, 0xFAC1, 0x3A90, 0x3A60, 0xFA31,
+        0xF601, 0x3650, 0x36A0, 0xF6F1, 0x3740, 0xF711, 0xF7E1, 0x37B0,
+        0x3480, 0xF4D1, 0xF421, 0x3470, 0xF5C1, 0x3590, 0x3560, 0xF531,
+        0x3300, 0xF351, 0xF3A1, 0x33F0, 0xF241, 0x3210, 0x32E0, 0xF2B1,
+        0xF181, 0x31D0, 0x3120, 0xF171, 0x30C0, 0xF091, 0xF061, 0x3030
+    },
+    {
+        0x0000, 0xFC01, 0xB801, 0x4400, 0x3001, 0xCC00, 0x8800, 0x7401,
+        0x6002, 0x9C03, 0xD803, 0x2402, 0x5003, 0xAC02, 0xE802, 0x1403,
+        0xC004, 0x3C05, 0x7805, 0x8404, 0xF005, 0x0C04, 0x4804, 0xB405,
+        0xA006, 0x5C07, 0x1807, 0xE406, 0x9007, 0x6C06, 0x2806, 0xD407,
+        0xC00B, 0x3C0A, 0x780A, 0x840B, 0xF00A, 0x0C0B, 0x480B, 0xB40A,
+        0xA009, 0x5C08, 0x1808, 0xE409, 0x9008, 0x6C09, 0x2809, 0xD408,
+        0x000F, 0xFC0E, 0xB80E, 0x440F, 0x300E, 0xCC0F, 0x880F, 0x740E,
+        0x600D, 0x9C0C, 0xD80C, 0x240D, 0x500C, 0xAC0D, 0xE80D, 0x140C,
+        0xC015, 0x3C14, 0x7814, 0x8415, 0xF014, 0x0C15, 0x4815, 0xB414,
+        0xA017, 0x5C16, 0x1816, 0xE417, 0x9016, 0x6C17, 0x2817, 0xD416,
+        0x0011, 0xFC10, 0xB810, 0x4411, 0x3010, 0xCC11, 0x8811, 0x7410,
+        0x6013, 0x9C12, 0xD812, 0x2413, 0x5012, 0xAC13, 0xE813, 0x1412,
+        0x001E, 0xFC1F, 0xB81F, 0x441E, 0x301F, 0xCC1E, 0x881E, 0x741F,
+        0x601C, 0x9C1D, 0xD81D, 0x241C, 0x501D, 0xAC1C, 0xE81C, 0x141D,
+        0xC01A, 0x3C1B, 0x781B, 0x841A, 0xF01B, 0x0C1A, 0x481A, 0xB41B,
+        0xA018, 0x5C19, 0x1819, 0xE418, 0x9019, 0x6C18, 0x2818, 0xD419,
+        0xC029, 0x3C28, 0x7828, 0x8429, 0xF028, 0x0C29, 0x4829, 0xB428,
+        0xA02B, 0x5C2A, 0x182A, 0xE42B, 0x902A, 0x6C2B, 0x282B, 0xD42A,
+        0x002D, 0xFC2C, 0xB82C, 0x442D, 0x302C, 0xCC2D, 0x882D, 0x742C,
+        0x602F, 0x9C2E, 0xD82E, 0x242F, 0x502E, 0xAC2F, 0xE82F, 0x142E,
+        0x0022, 0xFC23, 0xB823, 0x4422, 0x3023, 0xCC22, 0x8822, 0x7423,
+        0x6020, 0x9C21, 0xD821, 0x2420, 0x5021, 0xAC20, 0xE820, 0x1421,
+        0xC026, 0x3C27, 0x7827, 0x8426, 0xF027, 0x0C26, 0x4826, 0xB427,
+        0xA024, 0x5C25, 0x1825, 0xE424, 0x9025, 0x6C24, 0x2824, 0xD425,
+        0x003C, 0xFC3D, 0xB83D, 0x443C, 0x303D, 0xCC3C, 0x883C, 0x743D,
+        0x603E, 0x9C3F, 0xD83F, 0x243E, 0x503F, 0xAC3E, 0xE83E, 0x143F,
+        0xC038, 0x3C39, 0x7839, 0x8438, 0xF039, 0x0C38, 0x4838, 0xB439,
+        0xA03A, 0x5C3B, 0x183B, 0xE43A, 0x903B, 0x6C3A, 0x283A, 0xD43B,
+        0xC037, 0x3C36, 0x7836, 0x8437, 0xF036, 0x0C37, 0x4837, 0xB436,
+        0xA035, 0x5C34, 0x1834, 0xE435, 0x9034, 0x6C35, 0x2835, 0xD434,
+        0x0033, 0xFC32, 0xB832, 0x4433, 0x3032, 0xCC33, 0x8833, 0x7432,
+        0x6031, 0x9C30, 0xD830, 0x2431, 0x5030, 0xAC31, 0xE831, 0x1430
+    },
+#if TF_CRC_SLICING == 8
+    {
+        0x0000, 0xC03D, 0xC079, 0x0044, 0xC0F1, 0x00CC, 0x0088, 0xC0B5,
+        0xC1E1, 0x01DC, 0x0198, 0xC1A5, 0x0110, 0xC12D, 0xC169, 0x0154,
+        0xC3C1, 0x03FC, 0x03B8, 0xC385, 0x0330, 0xC30D, 0xC349, 0x0374,
+        0x0220, 0xC21D, 0xC259, 0x0264, 0xC2D1, 0x02EC, 0x02A8, 0xC295,
+        0xC781, 0x07BC, 0x07F8, 0xC7C5, 0x0770, 0xC74D, 0xC709, 0x0734,
+        0x0660, 0xC65D, 0xC619, 0x0624, 0xC691, 0x06AC, 0x06E8, 0xC6D5,
+        0x0440, 0xC47D, 0xC439, 0x0404, 0xC4B1, 0x048C, 0x04C8, 0xC4F5,
+        0xC5A1, 0x059C, 0x05D8, 0xC5E5, 0x0550, 0xC56D, 0xC529, 0x0514,
+        0xCF01, 0x0F3C, 0x0F78, 0xCF45, 0x0FF0, 0xCFCD, 0xCF89, 0x0FB4,
+        0x0EE0, 0xCEDD, 0xCE99, 0x0EA4, 0xCE11, 0x0E2C, 0x0E68, 0xCE55,
+        0x0CC0, 0xCCFD, 0xCCB9, 0x0C84, 0xCC31, 0x0C0C, 0x0C48, 0xCC75,
+        0xCD21, 0x0D1C, 0x0D58, 0xCD65, 0x0DD0, 0xCDED, 0xCDA9, 0x0D94,
+        0x0880, 0xC8BD, 0xC8F9, 0x08C4, 0xC871, 0x084C, 0x0808, 0xC835,
+        0xC961, 0x095C, 0x0918, 0xC925, 0x0990, 0xC9AD, 0xC9E9, 0x09D4,
+        0xCB41, 0x0B7C, 0x0B38, 0xCB05, 0x0BB0, 0xCB8D, 0xCBC9, 0x0BF4,
+        0x0AA0, 0xCA9D, 0xCAD9, 0x0AE4, 0xCA51, 0x0A6C, 0x0A28, 0xCA15,
+        0xDE01, 0x1E3C, 0x1E78, 0xDE45, 0x1EF0, 0xDECD, 0xDE89, 0x1EB4,
+        0x1FE0, 0xDFDD, 0xDF99, 0x1FA4, 0xDF11, 0x1F2C, 0x1F68, 0xDF55,
+        0x1DC0, 0xDDFD, 0xDDB9, 0x1D84, 0xDD31, 0x1D0C, 0x1D48, 0xDD75,
+        0xDC21, 0x1C1C, 0x1C58, 0xDC65, 0x1CD0, 0xDCED, 0xDCA9, 0x1C94,
+        0x1980, 0xD9BD, 0xD9F9, 0x19C4, 0xD971, 0x194C, 0x1908, 0xD935,
+        0xD861, 0x185C, 0x1818, 0xD825, 0x1890, 0xD8AD, 0xD8E9, 0x18D4,
+        0xDA41, 0x1A7C, 0x1A38, 0xDA05, 0x1AB0, 0xDA8D, 0xDAC9, 0x1AF4,
+        0x1BA0, 0xDB9D, 0xDBD9, 0x1BE4, 0xDB51, 0x1B6C, 0x1B28, 0xDB15,
+        0x1100, 0xD13D, 0xD179, 0x1144, 0xD1F1, 0x11CC, 0x1188, 0xD1B5,
+        0xD0E1, 0x10DC, 0x1098, 0xD0A5, 0x1010, 0xD02D, 0xD069, 0x1054,
+        0xD2C1, 0x12FC, 0x12B8, 0xD285, 0x1230, 0xD20D, 0xD249, 0x1274,
+        0x1320, 0xD31D, 0xD359, 0x1364, 0xD3D1, 0x13EC, 0x13A8, 0xD395,
+        0xD681, 0x16BC, 0x16F8, 0xD6C5, 0x1670, 0xD64D, 0xD609, 0x1634,
+        0x1760, 0xD75D, 0xD719, 0x1724, 0xD791, 0x17AC, 0x17E8, 0xD7D5,
+        0x1540, 0xD57D, 0xD539, 0x1504, 0xD5B1, 0x158C, 0x15C8, 0xD5F5,
+        0xD4A1, 0x149C, 0x14D8, 0xD4E5, 0x1450, 0xD46D, 0xD429, 0x1414
+    },
+    {
+        0x0000, 0xD101, 0xE201, 0x3300, 0x8401, 0x5500, 0x6600, 0xB701,
+        0x4801, 0x9900, 0xAA00, 0x7B01, 0xCC00, 0x1D01, 0x2E01, 0xFF00,
+        0x9002, 0x4103, 0x7203, 0xA302, 0x1403, 0xC502, 0xF602, 0x2703,
+        0xD803, 0x0902, 0x3A02, 0xEB03, 0x5C02, 0x8D03, 0xBE03, 0x6F02,
+        0x6007, 0xB106, 0x8206, 0x5307, 0xE406, 0x3507, 0x0607, 0xD706,
+        0x2806, 0xF907, 0xCA07, 0x1B06, 0xAC07, 0x7D06, 0x4E06, 0x9F07,
+        0xF005, 0x2104, 0x1204, 0xC305, 0x7404, 0xA505, 0x9605, 0x4704,
+        0xB804, 0x6905, 0x5A05, 0x8B04, 0x3C05, 0xED04, 0xDE04, 0x0F05,
+        0xC00E, 0x110F, 0x220F, 0xF30E, 0x440F, 0x950E, 0xA60E, 0x770F,
+        0x880F, 0x590E, 0x6A0E, 0xBB0F, 0x0C0E, 0xDD0F, 0xEE0F, 0x3F0E,
+        0x500C, 0x810D, 0xB20D, 0x630C, 0xD40D, 0x050C, 0x360C, 0xE70D,
+        0x180D, 0xC90C, 0xFA0C, 0x2B0D, 0x9C0C, 0x4D0D, 0x7E0D, 0xAF0C,
+        0xA009, 0x7108, 0x4208, 0x9309, 0x2408, 0xF509, 0xC609, 0x1708,
+        0xE808, 0x3909, 0x0A09, 0xDB08, 0x6C09, 0xBD08, 0x8E08, 0x5F09,
+        0x300B, 0xE10A, 0xD20A, 0x030B, 0xB40A, 0x650B, 0x560B, 0x870A,
+        0x780A, 0xA90B, 0x9A0B, 0x4B0A, 0xFC0B, 0x2D0A, 0x1E0A, 0xCF0B,
+        0xC01F, 0x111E, 0x221E, 0xF31F, 0x441E, 0x951F, 0xA61F, 0x771E,
+        0x881E, 0x591F, 0x6A1F, 0xBB1E, 0x0C1F, 0xDD1E, 0xEE1E, 0x3F1F,
+        0x501D, 0x811C, 0xB21C, 0x631D, 0xD41C, 0x051D, 0x361D, 0xE71C,
+        0x181C, 0xC91D, 0xFA1D, 0x2B1C, 0x9C1D, 0x4D1C, 0x7E1C, 0xAF1D,
+        0xA018, 0x7119, 0x4219, 0x9318, 0x2419, 0xF518, 0xC618, 0x1719,
+        0xE819, 0x3918, 0x0A18, 0xDB19, 0x6C18, 0xBD19, 0x8E19, 0x5F18,
+        0x301A, 0xE11B, 0xD21B, 0x031A, 0xB41B, 0x651A, 0x561A, 0x871B,
+        0x781B, 0xA91A, 0x9A1A, 0x4B1B, 0xFC1A, 0x2D1B, 0x1E1B, 0xCF1A,
+        0x0011, 0xD110, 0xE210, 0x3311, 0x8410, 0x5511, 0x6611, 0xB710,
+        0x4810, 0x9911, 0xAA11, 0x7B10, 0xCC11, 0x1D10, 0x2E10, 0xFF11,
+        0x9013, 0x4112, 0x7212, 0xA313, 0x1412, 0xC513, 0xF613, 0x2712,
+        0xD812, 0x0913, 0x3A13, 0xEB12, 0x5C13, 0x8D12, 0xBE12, 0x6F13,
+        0x6016, 0xB117, 0x8217, 0x5316, 0xE417, 0x3516, 0x0616, 0xD717,
+        0x2817, 0xF916, 0xCA16, 0x1B17, 0xAC16, 0x7D17, 0x4E17, 0x9F16,
+        0xF014, 0x2115, 0x1215, 0xC314, 0x7415, 0xA514, 0x9614, 0x4715,
+        0xB815, 0x6914, 0x5A14, 0x8B15, 0x3C14, 0xED15, 0xDE15, 0x0F14
+    },
+    {
+        0x0000, 0xC010, 0xC023, 0x0033, 0xC045, 0x0055, 0x0066, 0xC076,
+        0xC089, 0x0099, 0x00AA, 0xC0BA, 0x00CC, 0xC0DC, 0xC0EF, 0x00FF,
+        0xC111, 0x0101, 0x0132, 0xC122, 0x0154, 0xC144, 0xC177, 0x0167,
+        0x0198, 0xC188, 0xC1BB, 0x01AB, 0xC1DD, 0x01CD, 0x01FE, 0xC1EE,
+        0xC221, 0x0231, 0x0202, 0xC212, 0x0264, 0xC274, 0xC247, 0x0257,
+        0x02A8, 0xC2B8, 0xC28B, 0x029B, 0xC2ED, 0x02FD, 0x02CE, 0xC2DE,
+        0x0330, 0xC320, 0xC313, 0x0303, 0xC375, 0x0365, 0x0356, 0xC346,
+        0xC3B9, 0x03A9, 0x039A, 0xC38A, 0x03FC, 0xC3EC, 0xC3DF, 0x03CF,
+        0xC441, 0x0451, 0x0462, 0xC472, 0x0404, 0xC414, 0xC427, 0x0437,
+        0x04C8, 0xC4D8, 0xC4EB, 0x04FB, 0xC48D, 0x049D, 0x04AE, 0xC4BE,
+        0x0550, 0xC540, 0xC573, 0x0563, 0xC515, 0x0505, 0x0536, 0xC526,
+        0xC5D9, 0x05C9, 0x05FA, 0xC5EA, 0x059C, 0xC58C, 0xC5BF, 0x05AF,
+        0x0660, 0xC670, 0xC643, 0x0653, 0xC625, 0x0635, 0x0606, 0xC616,
+        0xC6E9, 0x06F9, 0x06CA, 0xC6DA, 0x06AC, 0xC6BC, 0xC68F, 0x069F,
+        0xC771, 0x0761, 0x0752, 0xC742, 0x0734, 0xC724, 0xC717, 0x0707,
+        0x07F8, 0xC7E8, 0xC7DB, 0x07CB, 0xC7BD, 0x07AD, 0x079E, 0xC78E,
+        0xC881, 0x0891, 0x08A2, 0xC8B2, 0x08C4, 0xC8D4, 0xC8E7, 0x08F7,
+        0x0808, 0xC818, 0xC82B, 0x083B, 0xC84D, 0x085D, 0x086E, 0xC87E,
+        0x0990, 0xC980, 0xC9B3, 0x09A3, 0xC9D5, 0x09C5, 0x09F6, 0xC9E6,
+        0xC919, 0x0909, 0x093A, 0xC92A, 0x095C, 0xC94C, 0xC97F, 0x096F,
+        0x0AA0, 0xCAB0, 0xCA83, 0x0A93, 0xCAE5, 0x0AF5, 0x0AC6, 0xCAD6,
+        0xCA29, 0x0A39, 0x0A0A, 0xCA1A, 0x0A6C, 0xCA7C, 0xCA4F, 0x0A5F,
+        0xCBB1, 0x0BA1, 0x0B92, 0xCB82, 0x0BF4, 0xCBE4, 0xCBD7, 0x0BC7,
+        0x0B38, 0xCB28, 0xCB1B, 0x0B0B, 0xCB7D, 0x0B6D, 0x0B5E, 0xCB4E,
+        0x0CC0, 0xCCD0, 0xCCE3, 0x0CF3, 0xCC85, 0x0C95, 0x0CA6, 0xCCB6,
+        0xCC49, 0x0C59, 0x0C6A, 0xCC7A, 0x0C0C, 0xCC1C, 0xCC2F, 0x0C3F,
+        0xCDD1, 0x0DC1, 0x0DF2, 0xCDE2, 0x0D94, 0xCD84, 0xCDB7, 0x0DA7,
+        0x0D58, 0xCD48, 0xCD7B, 0x0D6B, 0xCD1D, 0x0D0D, 0x0D3E, 0xCD2E,
+        0xCEE1, 0x0EF1, 0x0EC2, 0xCED2, 0x0EA4, 0xCEB4, 0xCE87, 0x0E97,
+        0x0E68, 0xCE78, 0xCE4B, 0x0E5B, 0xCE2D, 0x0E3D, 0x0E0E, 0xCE1E,
+        0x0FF0, 0xCFE0, 0xCFD3, 0x0FC3, 0xCFB5, 0x0FA5, 0x0F96, 0xCF86,
+        0xCF79, 0x0F69, 0x0F5A, 0xCF4A, 0x0F3C, 0xCF2C, 0xCF1F, 0x0F0F
+    },
+    {
+        0x0000, 0xCCC1, 0xD981, 0x1540, 0xF301, 0x3FC0, 0x2A80, 0xE641,
+        0xA601, 0x6AC0, 0x7F80, 0xB341, 0x5500, 0x99C1, 0x8C81, 0x4040,
+        0x0C01, 0xC0C0, 0xD580, 0x1941, 0xFF00, 0x33C1, 0x2681, 0xEA40,
+        0xAA00, 0x66C1, 0x7381, 0xBF40, 0x5901, 0x95C0, 0x8080, 0x4C41,
+        0x1802, 0xD4C3, 0xC183, 0x0D42, 0xEB03, 0x27C2, 0x3282, 0xFE43,
+        0xBE03, 0x72C2, 0x6782, 0xAB43, 0x4D02, 0x81C3, 0x9483, 0x5842,
+        0x1403, 0xD8C2, 0xCD82, 0x0143, 0xE702, 0x2BC3, 0x3E83, 0xF242,
+        0xB202, 0x7EC3, 0x6B83, 0xA742, 0x4103, 0x8DC2, 0x9882, 0x5443,
+        0x3004, 0xFCC5, 0xE985, 0x2544, 0xC305, 0x0FC4, 0x1A84, 0xD645,
+        0x9605, 0x5AC4, 0x4F84, 0x8345, 0x6504, 0xA9C5, 0xBC85, 0x7044,
+        0x3C05, 0xF0C4, 0xE584, 0x2945, 0xCF04, 0x03C5, 0x1685, 0xDA44,
+        0x9A04, 0x56C5, 0x4385, 0x8F44, 0x6905, 0xA5C4, 0xB084, 0x7C45,
+        0x2806, 0xE4C7, 0xF187, 0x3D46, 0xDB07, 0x17C6, 0x0286, 0xCE47,
+        0x8E07, 0x42C6, 0x5786, 0x9B47, 0x7D06, 0xB1C7, 0xA487, 0x6846,
+        0x2407, 0xE8C6, 0xFD86, 0x3147, 0xD706, 0x1BC7, 0x0E87, 0xC246,
+        0x8206, 0x4EC7, 0x5B87, 0x9746, 0x7107, 0xBDC6, 0xA886, 0x6447,
+        0x6008, 0xACC9, 0xB989, 0x7548, 0x9309, 0x5FC8, 0x4A88, 0x8649,
+        0xC609, 0x0AC8, 0x1F88, 0xD349, 0x3508, 0xF9C9, 0xEC89, 0x2048,
+        0x6C09, 0xA0C8, 0xB588, 0x7949, 0x9F08, 0x53C9, 0x4689, 0x8A48,
+        0xCA08, 0x06C9, 0x1389, 0xDF48, 0x3909, 0xF5C8, 0xE088, 0x2C49,
+        0x780A, 0xB4CB, 0xA18B, 0x6D4A, 0x8B0B, 0x47CA, 0x528A, 0x9E4B,
+        0xDE0B, 0x12CA, 0x078A, 0xCB4B, 0x2D0A, 0xE1CB, 0xF48B, 0x384A,
+        0x740B, 0xB8CA, 0xAD8A, 0x614B, 0x870A, 0x4BCB, 0x5E8B, 0x924A,
+        0xD20A, 0x1ECB, 0x0B8B, 0xC74A, 0x210B, 0xEDCA, 0xF88A, 0x344B,
+        0x500C, 0x9CCD, 0x898D, 0x454C, 0xA30D, 0x6FCC, 0x7A8C, 0xB64D,
+        0xF60D, 0x3ACC, 0x2F8C, 0xE34D, 0x050C, 0xC9CD, 0xDC8D, 0x104C,
+        0x5C0D, 0x90CC, 0x858C, 0x494D, 0xAF0C, 0x63CD, 0x768D, 0xBA4C,
+        0xFA0C, 0x36CD, 0x238D, 0xEF4C, 0x090D, 0xC5CC, 0xD08C, 0x1C4D,
+        0x480E, 0x84CF, 0x918F, 0x5D4E, 0xBB0F, 0x77CE, 0x628E, 0xAE4F,
+        0xEE0F, 0x22CE, 0x378E, 0xFB4F, 0x1D0E, 0xD1CF, 0xC48F, 0x084E,
+        0x440F, 0x88CE, 0x9D8E, 0x514F, 0xB70E, 0x7BCF, 0x6E8F, 0xA24E,
+        0xE20E, 0x2ECF, 0x3B8F, 0xF74E, 0x110F, 0xDDCE, 0xC88E, 0x044F
+    },
+#endif
+};
+#endif
+
 static TF_CKSUM TF_CksumStart(void)
 {
     return 0;
@@ -183,6 +756,59 @@ static TF_CKSUM TF_CksumEnd(TF_CKSUM cksum)
     return cksum;
 }
 
+#if TF_CRC_SLICING > 1 || defined(TF_CRC_CLMUL)
+#define TF_HAS_CKSUM_BLOCK
+
+/** Add a block of bytes in software, 8 or 4 per step with slicing */
+static uint16_t crc16_block(uint16_t c, const uint8_t *buf, uint32_t len)
+{
+#if TF_CRC_SLICING == 8
+    while (len >= 8)
+    {
+        c ^= (uint16_t)(buf[0] | (buf[1] << 8));
+        c = crc16_slice[6][c & 0xff] ^ crc16_slice[5][c >> 8] ^ crc16_slice[4][buf[2]] ^ crc16_slice[3][buf[3]] ^
+            crc16_slice[2][buf[4]] ^ crc16_slice[1][buf[5]] ^ crc16_slice[0][buf[6]] ^ crc16_table[buf[7]];
+        buf += 8;
+        len -= 8;
+    }
+#endif
+#if TF_CRC_SLICING > 1
+    while (len >= 4)
+    {
+        c ^= (uint16_t)(buf[0] | (buf[1] << 8));
+        c = crc16_slice[2][c & 0xff] ^ crc16_slice[1][c >> 8] ^ crc16_slice[0][buf[2]] ^ crc16_table[buf[3]];
+        buf += 4;
+        len -= 4;
+    }
+#endif
+    while (len--)
+    {
+        c = TF_CksumAdd(c, *buf++);
+    }
+    return c;
+}
+
+/** Add a block of bytes */
+static TF_CKSUM TF_CksumAddBlock(TF_CKSUM cksum, const uint8_t *buf, uint32_t len)
+{
+#if defined(TF_CRC_CLMUL)
+    // x^575, x^511, x^191, x^127 mod 0x18005, bit-reflected
+    static const uint64_t k[4] = {0xc450000000000000, 0x8101000000000000, 0xccd0000000000000, 0xc100000000000000};
+    uint8_t rem[16];
+    uint32_t n;
+
+    if (len >= 64 && have_pclmul())
+    {
+        n = crc_fold_clmul(cksum, buf, len, k, rem);
+        cksum = crc16_block(0, rem, 16);
+        buf += n;
+        len -= n;
+    }
+#endif
+    return crc16_block(cksum, buf, len);
+}
+#endif
+
 #elif TF_CKSUM_TYPE == TF_CKSUM_CRC32
 
 // TODO try to replace with an algorithm
@@ -231,6 +857,253 @@ static const uint32_t crc32_table[] = {/* CRC polynomial 0xedb88320 */
                                        0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
                                        0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d};
 
+#if TF_CRC_SLICING > 1
+// Tables for slicing-by-4/8: crc32_slice[k - 1][i] is the CRC of byte i followed by k zero bytes,
+// generated as T[k][i] = (T[k-1][i] >> 8) ^ crc32_table[T[k-1][i] & 0xff]
+static const uint32_t crc32_slice[TF_CRC_SLICING - 1][256] = {
+    {
+        0x00000000, 0x191b3141, 0x32366282, 0x2b2d53c3, 0x646cc504, 0x7d77f445, 0x565aa786, 0x4f4196c7,
+        0xc8d98a08, 0xd1c2bb49, 0xfaefe88a, 0xe3f4d9cb, 0xacb54f0c, 0xb5ae7e4d, 0x9e832d8e, 0x87981ccf,
+        0x4ac21251, 0x53d92310, 0x78f470d3, 0x61ef4192, 0x2eaed755, 0x37b5e614, 0x1c98b5d7, 0x05838496,
+        0x821b9859, 0x9b00a918, 0xb02dfadb, 0xa936cb9a, 0xe6775d5d, 0xff6c6c1c, 0xd4413fdf, 0xcd5a0e9e,
+        0x958424a2, 0x8c9f15e3, 0xa7b24620, 0xbea97761, 0xf1e8e1a6, 0xe8f3d0e7, 0xc3de8324, 0xdac5b265,
+        0x5d5daeaa, 0x44469feb, 0x6f6bcc28, 0x7670fd69, 0x39316bae, 0x202a5aef, 0x0b07092c, 0x121c386d,
+        0xdf4636f3, 0xc65d07b2, 0xed705471, 0xf46b6530, 0xbb2af3f7, 0xa231c2b6, 0x891c9175, 0x9007a034,
+        0x179fbcfb, 0x0e848dba, 0x25a9de79, 0x3cb2ef38, 0x73f379ff, 0x6ae848be, 0x41c51b7d, 0x58de2a3c,
+        0xf0794f05, 0xe9627e44, 0xc24f2d87, 0xdb541cc6, 0x94158a01, 0x8d0ebb40, 0xa623e883, 0xbf38d9c2,
+        0x38a0c50d, 0x21bbf44c, 0x0a96a78f, 0x138d96ce, 0x5ccc0009, 0x45d73148, 0x6efa628b, 0x77e153ca,
+        0xbabb5d54, 0xa3a06c15, 0x888d3fd6, 0x91960e97, 0xded79850, 0xc7cca911, 0xece1fad2, 0xf5facb93,
+        0x7262d75c, 0x6b79e61d, 0x4054b5de, 0x594f849f, 0x160e1258, 0x0f152319, 0x243870da, 0x3d23419b,
+        0x65fd6ba7, 0x7ce65ae6, 0x57cb0925, 0x4ed03864, 0x0191aea3, 0x188a9fe2, 0x33a7cc21, 0x2abcfd60,
+        0xad24e1af, 0xb43fd0ee, 0x9f12832d, 0x8609b26c, 0xc94824ab, 0xd05315ea, 0xfb7e4629, 0xe2657768,
+        0x2f3f79f6, 0x362448b7, 0x1d091b74, 0x04122a35, 0x4b53bcf2, 0x52488db3, 0x7965de70, 0x607eef31,
+        0xe7e6f3fe, 0xfefdc2bf, 0xd5d0917c, 0xcccba03d, 0x838a36fa, 0x9a9107bb, 0xb1bc5478, 0xa8a76539,
+        0x3b83984b, 0x2298a90a, 0x09b5fac9, 0x10aecb88, 0x5fef5d4f, 0x46f46c0e, 0x6dd93fcd, 0x74c20e8c,
+        0xf35a1243, 0xea412302, 0xc16c70c1, 0xd8774180, 0x9736d747, 0x8e2de606, 0xa500b5c5, 0xbc1b8484,
+        0x71418a1a, 0x685abb5b, 0x4377e898, 0x5a6cd9d9, 0x152d4f1e, 0x0c367e5f, 0x271b2d9c, 0x3e001cdd,
+        0xb9980012, 0xa0833153, 0x8bae6290, 0x92b553d1, 0xddf4c516, 0xc4eff457, 0xefc2a794, 0xf6d996d5,
+        0xae07bce9, 0xb71c8da8, 0x9c31de6b, 0x852aef2a, 0xca6b79ed, 0xd37048ac, 0xf85d1b6f, 0xe1462a2e,
+        0x66de36e1, 0x7fc507a0, 0x54e85463, 0x4df36522, 0x02b2f3e5, 0x1ba9c2a4, 0x30849167, 0x299fa026,
+        0xe4c5aeb8, 0xfdde9ff9, 0xd6f3cc3a, 0xcfe8fd7b, 0x80a96bbc, 0x99b25afd, 0xb29f093e, 0xab84387f,
+        0x2c1c24b0, 0x350715f1, 0x1e2a4632, 0x07317773, 0x4870e1b4, 0x516bd0f5, 0x7a468336, 0x635db277,
+        0xcbfad74e, 0xd2e1e60f, 0xf9ccb5cc, 0xe0d7848d, 0xaf96124a, 0xb68d230b, 0x9da070c8, 0x84bb4189,
+        0x03235d46, 0x1a386c07, 0x31153fc4, 0x280e0e85, 0x674f9842, 0x7e54a903, 0x5579fac0, 0x4c62cb81,
+        0x8138c51f, 0x9823f45e, 0xb30ea79d, 0xaa1596dc, 0xe554001b, 0xfc4f315a, 0xd7626299, 0xce7953d8,
+        0x49e14f17, 0x50fa7e56, 0x7bd72d95, 0x62cc1cd4, 0x2d8d8a13, 0x3496bb52, 0x1fbbe891, 0x06a0d9d0,
+        0x5e7ef3ec, 0x4765c2ad, 0x6c48916e, 0x7553a02f, 0x3a1236e8, 0x230907a9, 0x0824546a, 0x113f652b,
+        0x96a779e4, 0x8fbc48a5, 0xa4911b66, 0xbd8a2a27, 0xf2cbbce0, 0xebd08da1, 0xc0fdde62, 0xd9e6ef23,
+        0x14bce1bd, 0x0da7d0fc, 0x268a833f, 0x3f91b27e, 0x70d024b9, 0x69cb15f8, 0x42e6463b, 0x5bfd777a,
+        0xdc656bb5, 0xc57e5af4, 0xee530937, 0xf7483876, 0xb809aeb1, 0xa1129ff0, 0x8a3fcc33, 0x9324fd72
+    },
+    {
+        0x00000000, 0x01c26a37, 0x0384d46e, 0x0246be59, 0x0709a8dc, 0x06cbc2eb, 0x048d7cb2, 0x054f1685,
+        0x0e1351b8, 0x0fd13b8f, 0x0d9785d6, 0x0c55efe1, 0x091af964, 0x08d89353, 0x0a9e2d0a, 0x0b5c473d,
+        0x1c26a370, 0x1de4c947, 0x1fa2771e, 0x1e601d29, 0x1b2f0bac, 0x1aed619b, 0x18abdfc2, 0x1969b5f5,
+        0x1235f2c8, 0x13f798ff, 0x11b126a6, 0x10734c91, 0x153c5a14, 0x14fe3023, 0x16b88e7a, 0x177ae44d,
+        0x384d46e0, 0x398f2cd7, 0x3bc9928e, 0x3a0bf8b9, 0x3f44ee3c, 0x3e86840b, 0x3cc03a52, 0x3d025065,
+        0x365e1758, 0x379c7d6f, 0x35dac336, 0x3418a901, 0x3157bf84, 0x3095d5b3, 0x32d36bea, 0x331101dd,
+        0x246be590, 0x25a98fa7, 0x27ef31fe, 0x262d5bc9, 0x23624d4c, 0x22a0277b, 0x20e69922, 0x2124f315,
+        0x2a78b428, 0x2bbade1f, 0x29fc6046, 0x283e0a71, 0x2d711cf4, 0x2cb376c3, 0x2ef5c89a, 0x2f37a2ad,
+        0x709a8dc0, 0x7158e7f7, 0x731e59ae, 0x72dc3399, 0x7793251c, 0x76514f2b, 0x7417f172, 0x75d59b45,
+        0x7e89dc78, 0x7f4bb64f, 0x7d0d0816, 0x7ccf6221, 0x798074a4, 0x78421e93, 0x7a04a0ca, 0x7bc6cafd,
+        0x6cbc2eb0, 0x6d7e4487, 0x6f38fade, 0x6efa90e9, 0x6bb5866c, 0x6a77ec5b, 0x68315202, 0x69f33835,
+        0x62af7f08, 0x636d153f, 0x612bab66, 0x60e9c151, 0x65a6d7d4, 0x6464bde3, 0x662203ba, 0x67e0698d,
+        0x48d7cb20, 0x4915a117, 0x4b531f4e, 0x4a917579, 0x4fde63fc, 0x4e1c09cb, 0x4c5ab792, 0x4d98dda5,
+        0x46c49a98, 0x4706f0af, 0x45404ef6, 0x448224c1, 0x41cd3244, 0x400f5873, 0x4249e62a, 0x438b8c1d,
+        0x54f16850, 0x55330267, 0x5775bc3e, 0x56b7d609, 0x53f8c08c, 0x523aaabb, 0x507c14e2, 0x51be7ed5,
+        0x5ae239e8, 0x5b2053df, 0x5966ed86, 0x58a487b1, 0x5deb9134, 0x5c29fb03, 0x5e6f455a, 0x5fad2f6d,
+        0xe1351b80, 0xe0f771b7, 0xe2b1cfee, 0xe373a5d9, 0xe63cb35c, 0xe7fed96b, 0xe5b86732, 0xe47a0d05,
+        0xef264a38, 0xeee4200f, 0xeca29e56, 0xed60f461, 0xe82fe2e4, 0xe9ed88d3, 0xebab368a, 0xea695cbd,
+        0xfd13b8f0, 0xfcd1d2c7, 0xfe976c9e, 0xff5506a9, 0xfa1a102c, 0xfbd87a1b, 0xf99ec442, 0xf85cae75,
+        0xf300e948, 0xf2c2837f, 0xf0843d26, 0xf1465711, 0xf4094194, 0xf5cb2ba3, 0xf78d95fa, 0xf64fffcd,
+        0xd9785d60, 0xd8ba3757, 0xdafc890e, 0xdb3ee339, 0xde71f5bc, 0xdfb39f8b, 0xddf521d2, 0xdc374be5,
+        0xd76b0cd8, 0xd6a966ef, 0xd4efd8b6, 0xd52db281, 0xd062a404, 0xd1a0ce33, 0xd3e6706a, 0xd2241a5d,
+        0xc55efe10, 0xc49c9427, 0xc6da2a7e, 0xc7184049, 0xc25756cc, 0xc3953cfb, 0xc1d382a2, 0xc011e895,
+        0xcb4dafa8, 0xca8fc59f, 0xc8c97bc6, 0xc90b11f1, 0xcc440774, 0xcd866d43, 0xcfc0d31a, 0xce02b92d,
+        0x91af9640, 0x906dfc77, 0x922b422e, 0x93e92819, 0x96a63e9c, 0x976454ab, 0x9522eaf2, 0x94e080c5,
+        0x9fbcc7f8, 0x9e7eadcf, 0x9c381396, 0x9dfa79a1, 0x98b56f24, 0x99770513, 0x9b31bb4a, 0x9af3d17d,
+        0x8d893530, 0x8c4b5f07, 0x8e0de15e, 0x8fcf8b69, 0x8a809dec, 0x8b42f7db, 0x89044982, 0x88c623b5,
+        0x839a6488, 0x82580ebf, 0x801eb0e6, 0x81dcdad1, 0x8493cc54, 0x8551a663, 0x8717183a, 0x86d5720d,
+        0xa9e2d0a0, 0xa820ba97, 0xaa6604ce, 0xaba46ef9, 0xaeeb787c, 0xaf29124b, 0xad6fac12, 0xacadc625,
+        0xa7f18118, 0xa633eb2f, 0xa4755576, 0xa5b73f41, 0xa0f829c4, 0xa13a43f3, 0xa37cfdaa, 0xa2be979d,
+        0xb5c473d0, 0xb40619e7, 0xb640a7be, 0xb782cd89, 0xb2cddb0c, 0xb30fb13b, 0xb1490f62, 0xb08b6555,
+        0xbbd72268, 0xba15485f, 0xb853f606, 0xb9919c31, 0xbcde8ab4, 0xbd1ce083, 0xbf5a5eda, 0xbe9834ed
+    },
+    {
+        0x00000000, 0xb8bc6765, 0xaa09c88b, 0x12b5afee, 0x8f629757, 0x37def032, 0x256b5fdc, 0x9dd738b9,
+        0xc5b428ef, 0x7d084f8a, 0x6fbde064, 0xd7018701, 0x4ad6bfb8, 0xf26ad8dd, 0xe0df7733, 0x58631056,
+        0x5019579f, 0xe8a530fa, 0xfa109f14, 0x42acf871, 0xdf7bc0c8, 0x67c7a7ad, 0x75720843, 0xcdce6f26,
+        0x95ad7f70, 0x2d111815, 0x3fa4b7fb, 0x8718d09e, 0x1acfe827, 0xa2738f42, 0xb0c620ac, 0x087a47c9,
+        0xa032af3e, 0x188ec85b, 0x0a3b67b5, 0xb28700d0, 0x2f503869, 0x97ec5f0c, 0x8559f0e2, 0x3de59787,
+        0x658687d1, 0xdd3ae0b4, 0xcf8f4f5a, 0x7733283f, 0xeae41086, 0x525877e3, 0x40edd80d, 0xf851bf68,
+        0xf02bf8a1, 0x48979fc4, 0x5a22302a, 0xe29e574f, 0x7f496ff6, 0xc7f50893, 0xd540a77d, 0x6dfcc018,
+        0x359fd04e, 0x8d23b72b, 0x9f9618c5, 0x272a7fa0, 0xbafd4719, 0x0241207c, 0x10f48f92, 0xa848e8f7,
+        0x9b14583d, 0x23a83f58, 0x311d90b6, 0x89a1f7d3, 0x1476cf6a, 0xaccaa80f, 0xbe7f07e1, 0x06c36084,
+        0x5ea070d2, 0xe61c17b7, 0xf4a9b859, 0x4c15df3c, 0xd1c2e785, 0x697e80e0, 0x7bcb2f0e, 0xc377486b,
+        0xcb0d0fa2, 0x73b168c7, 0x6104c729, 0xd9b8a04c, 0x446f98f5, 0xfcd3ff90, 0xee66507e, 0x56da371b,
+        0x0eb9274d, 0xb6054028, 0xa4b0efc6, 0x1c0c88a3, 0x81dbb01a, 0x3967d77f, 0x2bd27891, 0x936e1ff4,
+        0x3b26f703, 0x839a9066, 0x912f3f88, 0x299358ed, 0xb4446054, 0x0cf80731, 0x1e4da8df, 0xa6f1cfba,
+        0xfe92dfec, 0x462eb889, 0x549b1767, 0xec277002, 0x71f048bb, 0xc94c2fde, 0xdbf98030, 0x6345e755,
+        0x6b3fa09c, 0xd383c7f9, 0xc1366817, 0x798a0f72, 0xe45d37cb, 0x5ce150ae, 0x4e54ff40, 0xf6e89825,
+        0xae8b8873, 0x1637ef16, 0x048240f8, 0xbc3e279d, 0x21e91f24, 0x99557841, 0x8be0d7af, 0x335cb0ca,
+        0xed59b63b, 0x55e5d15e, 0x47507eb0, 0xffec19d5, 0x623b216c, 0xda874609, 0xc832e9e7, 0x708e8e82,
+        0x28ed9ed4, 0x9051f9b1, 0x82e4565f, 0x3a58313a, 0xa78f0983, 0x1f336ee6, 0x0d86c108, 0xb53aa66d,
+        0xbd40e1a4, 0x05fc86c1, 0x1749292f, 0xaff54e4a, 0x322276f3, 0x8a9e1196, 0x982bbe78, 0x2097d91d,
+        0x78f4c94b, 0xc048ae2e, 0xd2fd01c0, 0x6a4166a5, 0xf7965e1c, 0x4f2a3979, 0x5d9f9697, 0xe523f1f2,
+        0x4d6b1905, 0xf5d77e60, 0xe762d18e, 0x5fdeb6eb, 0xc2098e52, 0x7ab5e937, 0x680046d9, 0xd0bc21bc,
+        0x88df31ea, 0x3063568f, 0x22d6f961, 0x9a6a9e04, 0x07bda6bd, 0xbf01c1d8, 0xadb46e36, 0x15080953,
+        0x1d724e9a, 0xa5ce29ff, 0xb77b8611, 0x0fc7e174, 0x9210d9cd, 0x2aacbea8, 0x38191146, 0x80a57623,
+        0xd8c66675, 0x607a0110, 0x72cfaefe, 0xca73c99b, 0x57a4f122, 0xef189647, 0xfdad39a9, 0x45115ecc,
+        0x764dee06, 0xcef18963, 0xdc44268d, 0x64f841e8, 0xf92f7951, 0x41931e34, 0x5326b1da, 0xeb9ad6bf,
+        0xb3f9c6e9, 0x0b45a18c, 0x19f00e62, 0xa14c6907, 0x3c9b51be, 0x842736db, 0x96929935, 0x2e2efe50,
+        0x2654b999, 0x9ee8defc, 0x8c5d7112, 0x34e11677, 0xa9362ece, 0x118a49ab, 0x033fe645, 0xbb838120,
+        0xe3e09176, 0x5b5cf613, 0x49e959fd, 0xf1553e98, 0x6c820621, 0xd43e6144, 0xc68bceaa, 0x7e37a9cf,
+        0xd67f4138, 0x6ec3265d, 0x7c7689b3, 0xc4caeed6, 0x591dd66f, 0xe1a1b10a, 0xf3141ee4, 0x4ba87981,
+        0x13cb69d7, 0xab770eb2, 0xb9c2a15c, 0x017ec639, 0x9ca9fe80, 0x241599e5, 0x36a0360b, 0x8e1c516e,
+        0x866616a7, 0x3eda71c2, 0x2c6fde2c, 0x94d3b949, 0x090481f0, 0xb1b8e695, 0xa30d497b, 0x1bb12e1e,
+        0x43d23e48, 0xfb6e592d, 0xe9dbf6c3, 0x516791a6, 0xccb0a91f, 0x740cce7a, 0x66b96194, 0xde0506f1
+    },
+#if TF_CRC_SLICING == 8
+    {
+        0x00000000, 0x3d6029b0, 0x7ac05360, 0x47a07ad0, 0xf580a6c0, 0xc8e08f70, 0x8f40f5a0, 0xb220dc10,
+        0x30704bc1, 0x0d106271, 0x4ab018a1, 0x77d03111, 0xc5f0ed01, 0xf890c4b1, 0xbf30be61, 0x825097d1,
+        0x60e09782, 0x5d80be32, 0x1a20c4e2, 0x2740ed52, 0x95603142, 0xa80018f2, 0xefa06222, 0xd2c04b92,
+        0x5090dc43, 0x6df0f5f3, 0x2a508f23, 0x1730a693, 0xa5107a83, 0x98705333, 0xdfd029e3, 0xe2b00053,
+        0xc1c12f04, 0xfca106b4, 0xbb017c64, 0x866155d4, 0x344189c4, 0x0921a074, 0x4e81daa4, 0x73e1f314,
+        0xf1b164c5, 0xccd14d75, 0x8b7137a5, 0xb6111e15, 0x0431c205, 0x3951ebb5, 0x7ef19165, 0x4391b8d5,
+        0xa121b886, 0x9c419136, 0xdbe1ebe6, 0xe681c256, 0x54a11e46, 0x69c137f6, 0x2e614d26, 0x13016496,
+        0x9151f347, 0xac31daf7, 0xeb91a027, 0xd6f18997, 0x64d15587, 0x59b17c37, 0x1e1106e7, 0x23712f57,
+        0x58f35849, 0x659371f9, 0x22330b29, 0x1f532299, 0xad73fe89, 0x9013d739, 0xd7b3ade9, 0xead38459,
+        0x68831388, 0x55e33a38, 0x124340e8, 0x2f236958, 0x9d03b548, 0xa0639cf8, 0xe7c3e628, 0xdaa3cf98,
+        0x3813cfcb, 0x0573e67b, 0x42d39cab, 0x7fb3b51b, 0xcd93690b, 0xf0f340bb, 0xb7533a6b, 0x8a3313db,
+        0x0863840a, 0x3503adba, 0x72a3d76a, 0x4fc3feda, 0xfde322ca, 0xc0830b7a, 0x872371aa, 0xba43581a,
+        0x9932774d, 0xa4525efd, 0xe3f2242d, 0xde920d9d, 0x6cb2d18d, 0x51d2f83d, 0x167282ed, 0x2b12ab5d,
+        0xa9423c8c, 0x9422153c, 0xd3826fec, 0xeee2465c, 0x5cc29a4c, 0x61a2b3fc, 0x2602c92c, 0x1b62e09c,
+        0xf9d2e0cf, 0xc4b2c97f, 0x8312b3af, 0xbe729a1f, 0x0c52460f, 0x31326fbf, 0x7692156f, 0x4bf23cdf,
+        0xc9a2ab0e, 0xf4c282be, 0xb362f86e, 0x8e02d1de, 0x3c220dce, 0x0142247e, 0x46e25eae, 0x7b82771e,
+        0xb1e6b092, 0x8c869922, 0xcb26e3f2, 0xf646ca42, 0x44661652, 0x79063fe2, 0x3ea64532, 0x03c66c82,
+        0x8196fb53, 0xbcf6d2e3, 0xfb56a833, 0xc6368183, 0x74165d93, 0x49767423, 0x0ed60ef3, 0x33b62743,
+        0xd1062710, 0xec660ea0, 0xabc67470, 0x96a65dc0, 0x248681d0, 0x19e6a860, 0x5e46d2b0, 0x6326fb00,
+        0xe1766cd1, 0xdc164561, 0x9bb63fb1, 0xa6d61601, 0x14f6ca11, 0x2996e3a1, 0x6e369971, 0x5356b0c1,
+        0x70279f96, 0x4d47b626, 0x0ae7ccf6, 0x3787e546, 0x85a73956, 0xb8c710e6, 0xff676a36, 0xc2074386,
+        0x4057d457, 0x7d37fde7, 0x3a978737, 0x07f7ae87, 0xb5d77297, 0x88b75b27, 0xcf1721f7, 0xf2770847,
+        0x10c70814, 0x2da721a4, 0x6a075b74, 0x576772c4, 0xe547aed4, 0xd8278764, 0x9f87fdb4, 0xa2e7d404,
+        0x20b743d5, 0x1dd76a65, 0x5a7710b5, 0x67173905, 0xd537e515, 0xe857cca5, 0xaff7b675, 0x92979fc5,
+        0xe915e8db, 0xd475c16b, 0x93d5bbbb, 0xaeb5920b, 0x1c954e1b, 0x21f567ab, 0x66551d7b, 0x5b3534cb,
+        0xd965a31a, 0xe4058aaa, 0xa3a5f07a, 0x9ec5d9ca, 0x2ce505da, 0x11852c6a, 0x562556ba, 0x6b457f0a,
+        0x89f57f59, 0xb49556e9, 0xf3352c39, 0xce550589, 0x7c75d999, 0x4115f029, 0x06b58af9, 0x3bd5a349,
+        0xb9853498, 0x84e51d28, 0xc34567f8, 0xfe254e48, 0x4c059258, 0x7165bbe8, 0x36c5c138, 0x0ba5e888,
+        0x28d4c7df, 0x15b4ee6f, 0x521494bf, 0x6f74bd0f, 0xdd54611f, 0xe03448af, 0xa794327f, 0x9af41bcf,
+        0x18a48c1e, 0x25c4a5ae, 0x6264df7e, 0x5f04f6ce, 0xed242ade, 0xd044036e, 0x97e479be, 0xaa84500e,
+        0x4834505d, 0x755479ed, 0x32f4033d, 0x0f942a8d, 0xbdb4f69d, 0x80d4df2d, 0xc774a5fd, 0xfa148c4d,
+        0x78441b9c, 0x4524322c, 0x028448fc, 0x3fe4614c, 0x8dc4bd5c, 0xb0a494ec, 0xf704ee3c, 0xca64c78c
+    },
+    {
+        0x00000000, 0xcb5cd3a5, 0x4dc8a10b, 0x869472ae, 0x9b914216, 0x50cd91b3, 0xd659e31d, 0x1d0530b8,
+        0xec53826d, 0x270f51c8, 0xa19b2366, 0x6ac7f0c3, 0x77c2c07b, 0xbc9e13de, 0x3a0a6170, 0xf156b2d5,
+        0x03d6029b, 0xc88ad13e, 0x4e1ea390, 0x85427035, 0x9847408d, 0x531b9328, 0xd58fe186, 0x1ed33223,
+        0xef8580f6, 0x24d95353, 0xa24d21fd, 0x6911f258, 0x7414c2e0, 0xbf481145, 0x39dc63eb, 0xf280b04e,
+        0x07ac0536, 0xccf0d693, 0x4a64a43d, 0x81387798, 0x9c3d4720, 0x57619485, 0xd1f5e62b, 0x1aa9358e,
+        0xebff875b, 0x20a354fe, 0xa6372650, 0x6d6bf5f5, 0x706ec54d, 0xbb3216e8, 0x3da66446, 0xf6fab7e3,
+        0x047a07ad, 0xcf26d408, 0x49b2a6a6, 0x82ee7503, 0x9feb45bb, 0x54b7961e, 0xd223e4b0, 0x197f3715,
+        0xe82985c0, 0x23755665, 0xa5e124cb, 0x6ebdf76e, 0x73b8c7d6, 0xb8e41473, 0x3e7066dd, 0xf52cb578,
+        0x0f580a6c, 0xc404d9c9, 0x4290ab67, 0x89cc78c2, 0x94c9487a, 0x5f959bdf, 0xd901e971, 0x125d3ad4,
+        0xe30b8801, 0x28575ba4, 0xaec3290a, 0x659ffaaf, 0x789aca17, 0xb3c619b2, 0x35526b1c, 0xfe0eb8b9,
+        0x0c8e08f7, 0xc7d2db52, 0x4146a9fc, 0x8a1a7a59, 0x971f4ae1, 0x5c439944, 0xdad7ebea, 0x118b384f,
+        0xe0dd8a9a, 0x2b81593f, 0xad152b91, 0x6649f834, 0x7b4cc88c, 0xb0101b29, 0x36846987, 0xfdd8ba22,
+        0x08f40f5a, 0xc3a8dcff, 0x453cae51, 0x8e607df4, 0x93654d4c, 0x58399ee9, 0xdeadec47, 0x15f13fe2,
+        0xe4a78d37, 0x2ffb5e92, 0xa96f2c3c, 0x6233ff99, 0x7f36cf21, 0xb46a1c84, 0x32fe6e2a, 0xf9a2bd8f,
+        0x0b220dc1, 0xc07ede64, 0x46eaacca, 0x8db67f6f, 0x90b34fd7, 0x5bef9c72, 0xdd7beedc, 0x16273d79,
+        0xe7718fac, 0x2c2d5c09, 0xaab92ea7, 0x61e5fd02, 0x7ce0cdba, 0xb7bc1e1f, 0x31286cb1, 0xfa74bf14,
+        0x1eb014d8, 0xd5ecc77d, 0x5378b5d3, 0x98246676, 0x852156ce, 0x4e7d856b, 0xc8e9f7c5, 0x03b52460,
+        0xf2e396b5, 0x39bf4510, 0xbf2b37be, 0x7477e41b, 0x6972d4a3, 0xa22e0706, 0x24ba75a8, 0xefe6a60d,
+        0x1d661643, 0xd63ac5e6, 0x50aeb748, 0x9bf264ed, 0x86f75455, 0x4dab87f0, 0xcb3ff55e, 0x006326fb,
+        0xf135942e, 0x3a69478b, 0xbcfd3525, 0x77a1e680, 0x6aa4d638, 0xa1f8059d, 0x276c7733, 0xec30a496,
+        0x191c11ee, 0xd240c24b, 0x54d4b0e5, 0x9f886340, 0x828d53f8, 0x49d1805d, 0xcf45f2f3, 0x04192156,
+        0xf54f9383, 0x3e134026, 0xb8873288, 0x73dbe12d, 0x6eded195, 0xa5820230, 0x2316709e, 0xe84aa33b,
+        0x1aca1375, 0xd196c0d0, 0x5702b27e, 0x9c5e61db, 0x815b5163, 0x4a0782c6, 0xcc93f068, 0x07cf23cd,
+        0xf6999118, 0x3dc542bd, 0xbb513013, 0x700de3b6, 0x6d08d30e, 0xa65400ab, 0x20c07205, 0xeb9ca1a0,
+        0x11e81eb4, 0xdab4cd11, 0x5c20bfbf, 0x977c6c1a, 0x8a795ca2, 0x41258f07, 0xc7b1fda9, 0x0ced2e0c,
+        0xfdbb9cd9, 0x36e74f7c, 0xb0733dd2, 0x7b2fee77, 0x662adecf, 0xad760d6a, 0x2be27fc4, 0xe0beac61,
+        0x123e1c2f, 0xd962cf8a, 0x5ff6bd24, 0x94aa6e81, 0x89af5e39, 0x42f38d9c, 0xc467ff32, 0x0f3b2c97,
+        0xfe6d9e42, 0x35314de7, 0xb3a53f49, 0x78f9ecec, 0x65fcdc54, 0xaea00ff1, 0x28347d5f, 0xe368aefa,
+        0x16441b82, 0xdd18c827, 0x5b8cba89, 0x90d0692c, 0x8dd55994, 0x46898a31, 0xc01df89f, 0x0b412b3a,
+        0xfa1799ef, 0x314b4a4a, 0xb7df38e4, 0x7c83eb41, 0x6186dbf9, 0xaada085c, 0x2c4e7af2, 0xe712a957,
+        0x15921919, 0xdececabc, 0x585ab812, 0x93066bb7, 0x8e035b0f, 0x455f88aa, 0xc3cbfa04, 0x089729a1,
+        0xf9c19b74, 0x329d48d1, 0xb4093a7f, 0x7f55e9da, 0x6250d962, 0xa90c0ac7, 0x2f987869, 0xe4c4abcc
+    },
+    {
+        0x00000000, 0xa6770bb4, 0x979f1129, 0x31e81a9d, 0xf44f2413, 0x52382fa7, 0x63d0353a, 0xc5a73e8e,
+        0x33ef4e67, 0x959845d3, 0xa4705f4e, 0x020754fa, 0xc7a06a74, 0x61d761c0, 0x503f7b5d, 0xf64870e9,
+        0x67de9cce, 0xc1a9977a, 0xf0418de7, 0x56368653, 0x9391b8dd, 0x35e6b369, 0x040ea9f4, 0xa279a240,
+        0x5431d2a9, 0xf246d91d, 0xc3aec380, 0x65d9c834, 0xa07ef6ba, 0x0609fd0e, 0x37e1e793, 0x9196ec27,
+        0xcfbd399c, 0x69ca3228, 0x582228b5, 0xfe552301, 0x3bf21d8f, 0x9d85163b, 0xac6d0ca6, 0x0a1a0712,
+        0xfc5277fb, 0x5a257c4f, 0x6bcd66d2, 0xcdba6d66, 0x081d53e8, 0xae6a585c, 0x9f8242c1, 0x39f54975,
+        0xa863a552, 0x0e14aee6, 0x3ffcb47b, 0x998bbfcf, 0x5c2c8141, 0xfa5b8af5, 0xcbb39068, 0x6dc49bdc,
+        0x9b8ceb35, 0x3dfbe081, 0x0c13fa1c, 0xaa64f1a8, 0x6fc3cf26, 0xc9b4c492, 0xf85cde0f, 0x5e2bd5bb,
+        0x440b7579, 0xe27c7ecd, 0xd3946450, 0x75e36fe4, 0xb044516a, 0x16335ade, 0x27db4043, 0x81ac4bf7,
+        0x77e43b1e, 0xd19330aa, 0xe07b2a37, 0x460c2183, 0x83ab1f0d, 0x25dc14b9, 0x14340e24, 0xb2430590,
+        0x23d5e9b7, 0x85a2e203, 0xb44af89e, 0x123df32a, 0xd79acda4, 0x71edc610, 0x4005dc8d, 0xe672d739,
+        0x103aa7d0, 0xb64dac64, 0x87a5b6f9, 0x21d2bd4d, 0xe47583c3, 0x42028877, 0x73ea92ea, 0xd59d995e,
+        0x8bb64ce5, 0x2dc14751, 0x1c295dcc, 0xba5e5678, 0x7ff968f6, 0xd98e6342, 0xe86679df, 0x4e11726b,
+        0xb8590282, 0x1e2e0936, 0x2fc613ab, 0x89b1181f, 0x4c162691, 0xea612d25, 0xdb8937b8, 0x7dfe3c0c,
+        0xec68d02b, 0x4a1fdb9f, 0x7bf7c102, 0xdd80cab6, 0x1827f438, 0xbe50ff8c, 0x8fb8e511, 0x29cfeea5,
+        0xdf879e4c, 0x79f095f8, 0x48188f65, 0xee6f84d1, 0x2bc8ba5f, 0x8dbfb1eb, 0xbc57ab76, 0x1a20a0c2,
+        0x8816eaf2, 0x2e61e146, 0x1f89fbdb, 0xb9fef06f, 0x7c59cee1, 0xda2ec555, 0xebc6dfc8, 0x4db1d47c,
+        0xbbf9a495, 0x1d8eaf21, 0x2c66b5bc, 0x8a11be08, 0x4fb68086, 0xe9c18b32, 0xd82991af, 0x7e5e9a1b,
+        0xefc8763c, 0x49bf7d88, 0x78576715, 0xde206ca1, 0x1b87522f, 0xbdf0599b, 0x8c184306, 0x2a6f48b2,
+        0xdc27385b, 0x7a5033ef, 0x4bb82972, 0xedcf22c6, 0x28681c48, 0x8e1f17fc, 0xbff70d61, 0x198006d5,
+        0x47abd36e, 0xe1dcd8da, 0xd034c247, 0x7643c9f3, 0xb3e4f77d, 0x1593fcc9, 0x247be654, 0x820cede0,
+        0x74449d09, 0xd23396bd, 0xe3db8c20, 0x45ac8794, 0x800bb91a, 0x267cb2ae, 0x1794a833, 0xb1e3a387,
+        0x20754fa0, 0x86024414, 0xb7ea5e89, 0x119d553d, 0xd43a6bb3, 0x724d6007, 0x43a57a9a, 0xe5d2712e,
+        0x139a01c7, 0xb5ed0a73, 0x840510ee, 0x22721b5a, 0xe7d525d4, 0x41a22e60, 0x704a34fd, 0xd63d3f49,
+        0xcc1d9f8b, 0x6a6a943f, 0x5b828ea2, 0xfdf58516, 0x3852bb98, 0x9e25b02c, 0xafcdaab1, 0x09baa105,
+        0xfff2d1ec, 0x5985da58, 0x686dc0c5, 0xce1acb71, 0x0bbdf5ff, 0xadcafe4b, 0x9c22e4d6, 0x3a55ef62,
+        0xabc30345, 0x0db408f1, 0x3c5c126c, 0x9a2b19d8, 0x5f8c2756, 0xf9fb2ce2, 0xc813367f, 0x6e643dcb,
+        0x982c4d22, 0x3e5b4696, 0x0fb35c0b, 0xa9c457bf, 0x6c636931, 0xca146285, 0xfbfc7818, 0x5d8b73ac,
+        0x03a0a617, 0xa5d7ada3, 0x943fb73e, 0x3248bc8a, 0xf7ef8204, 0x519889b0, 0x6070932d, 0xc6079899,
+        0x304fe870, 0x9638e3c4, 0xa7d0f959, 0x01a7f2ed, 0xc400cc63, 0x6277c7d7, 0x539fdd4a, 0xf5e8d6fe,
+        0x647e3ad9, 0xc209316d, 0xf3e12bf0, 0x55962044, 0x90311eca, 0x3646157e, 0x07ae0fe3, 0xa1d90457,
+        0x579174be, 0xf1e67f0a, 0xc00e6597, 0x66796e23, 0xa3de50ad, 0x05a95b19, 0x34414184, 0x92364a30
+    },
+    {
+        0x00000000, 0xccaa009e, 0x4225077d, 0x8e8f07e3, 0x844a0efa, 0x48e00e64, 0xc66f0987, 0x0ac50919,
+        0xd3e51bb5, 0x1f4f1b2b, 0x91c01cc8, 0x5d6a1c56, 0x57af154f, 0x9b0515d1, 0x158a1232, 0xd92012ac,
+        0x7cbb312b, 0xb01131b5, 0x3e9e3656, 0xf23436c8, 0xf8f13fd1, 0x345b3f4f, 0xbad438ac, 0x767e3832,
+        0xaf5e2a9e, 0x63f42a00, 0xed7b2de3, 0x21d12d7d, 0x2b142464, 0xe7be24fa, 0x69312319, 0xa59b2387,
+        0xf9766256, 0x35dc62c8, 0xbb53652b, 0x77f965b5, 0x7d3c6cac, 0xb1966c32, 0x3f196bd1, 0xf3b36b4f,
+        0x2a9379e3, 0xe639797d, 0x68b67e9e, 0xa41c7e00, 0xaed97719, 0x62737787, 0xecfc7064, 0x205670fa,
+        0x85cd537d, 0x496753e3, 0xc7e85400, 0x0b42549e, 0x01875d87, 0xcd2d5d19, 0x43a25afa, 0x8f085a64,
+        0x562848c8, 0x9a824856, 0x140d4fb5, 0xd8a74f2b, 0xd2624632, 0x1ec846ac, 0x9047414f, 0x5ced41d1,
+        0x299dc2ed, 0xe537c273, 0x6bb8c590, 0xa712c50e, 0xadd7cc17, 0x617dcc89, 0xeff2cb6a, 0x2358cbf4,
+        0xfa78d958, 0x36d2d9c6, 0xb85dde25, 0x74f7debb, 0x7e32d7a2, 0xb298d73c, 0x3c17d0df, 0xf0bdd041,
+        0x5526f3c6, 0x998cf358, 0x1703f4bb, 0xdba9f425, 0xd16cfd3c, 0x1dc6fda2, 0x9349fa41, 0x5fe3fadf,
+        0x86c3e873, 0x4a69e8ed, 0xc4e6ef0e, 0x084cef90, 0x0289e689, 0xce23e617, 0x40ace1f4, 0x8c06e16a,
+        0xd0eba0bb, 0x1c41a025, 0x92cea7c6, 0x5e64a758, 0x54a1ae41, 0x980baedf, 0x1684a93c, 0xda2ea9a2,
+        0x030ebb0e, 0xcfa4bb90, 0x412bbc73, 0x8d81bced, 0x8744b5f4, 0x4beeb56a, 0xc561b289, 0x09cbb217,
+        0xac509190, 0x60fa910e, 0xee7596ed, 0x22df9673, 0x281a9f6a, 0xe4b09ff4, 0x6a3f9817, 0xa6959889,
+        0x7fb58a25, 0xb31f8abb, 0x3d908d58, 0xf13a8dc6, 0xfbff84df, 0x37558441, 0xb9da83a2, 0x7570833c,
+        0x533b85da, 0x9f918544, 0x111e82a7, 0xddb48239, 0xd7718b20, 0x1bdb8bbe, 0x95548c5d, 0x59fe8cc3,
+        0x80de9e6f, 0x4c749ef1, 0xc2fb9912, 0x0e51998c, 0x04949095, 0xc83e900b, 0x46b197e8, 0x8a1b9776,
+        0x2f80b4f1, 0xe32ab46f, 0x6da5b38c, 0xa10fb312, 0xabcaba0b, 0x6760ba95, 0xe9efbd76, 0x2545bde8,
+        0xfc65af44, 0x30cfafda, 0xbe40a839, 0x72eaa8a7, 0x782fa1be, 0xb485a120, 0x3a0aa6c3, 0xf6a0a65d,
+        0xaa4de78c, 0x66e7e712, 0xe868e0f1, 0x24c2e06f, 0x2e07e976, 0xe2ade9e8, 0x6c22ee0b, 0xa088ee95,
+        0x79a8fc39, 0xb502fca7, 0x3b8dfb44, 0xf727fbda, 0xfde2f2c3, 0x3148f25d, 0xbfc7f5be, 0x736df520,
+        0xd6f6d6a7, 0x1a5cd639, 0x94d3d1da, 0x5879d144, 0x52bcd85d, 0x9e16d8c3, 0x1099df20, 0xdc33dfbe,
+        0x0513cd12, 0xc9b9cd8c, 0x4736ca6f, 0x8b9ccaf1, 0x8159c3e8, 0x4df3c376, 0xc37cc495, 0x0fd6c40b,
+        0x7aa64737, 0xb60c47a9, 0x3883404a, 0xf42940d4, 0xfeec49cd, 0x32464953, 0xbcc94eb0, 0x70634e2e,
+        0xa9435c82, 0x65e95c1c, 0xeb665bff, 0x27cc5b61, 0x2d095278, 0xe1a352e6, 0x6f2c5505, 0xa386559b,
+        0x061d761c, 0xcab77682, 0x44387161, 0x889271ff, 0x825778e6, 0x4efd7878, 0xc0727f9b, 0x0cd87f05,
+        0xd5f86da9, 0x19526d37, 0x97dd6ad4, 0x5b776a4a, 0x51b26353, 0x9d1863cd, 0x1397642e, 0xdf3d64b0,
+        0x83d02561, 0x4f7a25ff, 0xc1f5221c, 0x0d5f2282, 0x079a2b9b, 0xcb302b05, 0x45bf2ce6, 0x89152c78,
+        0x50353ed4, 0x9c9f3e4a, 0x121039a9, 0xdeba3937, 0xd47f302e, 0x18d530b0, 0x965a3753, 0x5af037cd,
+        0xff6b144a, 0x33c114d4, 0xbd4e1337, 0x71e413a9, 0x7b211ab0, 0xb78b1a2e, 0x39041dcd, 0xf5ae1d53,
+        0x2c8e0fff, 0xe0240f61, 0x6eab0882, 0xa201081c, 0xa8c40105, 0x646e019b, 0xeae10678, 0x264b06e6
+    },
+#endif
+};
+#endif
+
 static TF_CKSUM TF_CksumStart(void)
 {
     return (TF_CKSUM)0xFFFFFFFF;
@@ -246,439 +1119,2175 @@ static TF_CKSUM TF_CksumEnd(TF_CKSUM cksum)
     return (TF_CKSUM)~cksum;
 }
 
-#endif
-
-#define CKSUM_RESET(cksum)         \
-    do                             \
-    {                              \
-        (cksum) = TF_CksumStart(); \
-    } while (0)
-#define CKSUM_ADD(cksum, byte)                  \
-    do                                          \
-    {                                           \
-        (cksum) = TF_CksumAdd((cksum), (byte)); \
-    } while (0)
-#define CKSUM_FINALIZE(cksum)           \
-    do                                  \
-    {                                   \
-        (cksum) = TF_CksumEnd((cksum)); \
-    } while (0)
-
-// endregion
-
-// region Init
+#if TF_CRC_SLICING > 1 || defined(TF_CRC_CLMUL)
+#define TF_HAS_CKSUM_BLOCK
 
-/** Init with a user-allocated buffer */
-bool _TF_FN TF_InitStatic(TinyFrame *tf, TF_Peer peer_bit)
+/** Add a block of bytes in software, 8 or 4 per step with slicing */
+static uint32_t crc32_block(uint32_t c, const uint8_t *buf, uint32_t len)
 {
-    if (tf == NULL)
+#if TF_CRC_SLICING == 8
+    while (len >= 8)
     {
-        TF_Error("TF_InitStatic() failed, tf is null.");
-        return false;
+        c ^= (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+        c = crc32_slice[6][c & 0xff] ^ crc32_slice[5][(c >> 8) & 0xff] ^ crc32_slice[4][(c >> 16) & 0xff] ^
+            crc32_slice[3][c >> 24] ^ crc32_slice[2][buf[4]] ^ crc32_slice[1][buf[5]] ^ crc32_slice[0][buf[6]] ^
+            crc32_table[buf[7]];
+        buf += 8;
+        len -= 8;
     }
-
-    // Zero it out, keeping user config
-    uint32_t usertag = tf->usertag;
-    void *userdata = tf->userdata;
-
-    memset(tf, 0, sizeof(struct TinyFrame_));
-
-    tf->usertag = usertag;
-    tf->userdata = userdata;
-
-    tf->peer_bit = peer_bit;
-    return true;
+#endif
+#if TF_CRC_SLICING > 1
+    while (len >= 4)
+    {
+        c ^= (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+        c = crc32_slice[2][c & 0xff] ^ crc32_slice[1][(c >> 8) & 0xff] ^ crc32_slice[0][(c >> 16) & 0xff] ^
+            crc32_table[c >> 24];
+        buf += 4;
+        len -= 4;
+    }
+#endif
+    while (len--)
+    {
+        c = TF_CksumAdd(c, *buf++);
+    }
+    return c;
 }
 
-/** Init with malloc */
-TinyFrame *_TF_FN TF_Init(TF_Peer peer_bit)
+/** Add a block of bytes */
+static TF_CKSUM TF_CksumAddBlock(TF_CKSUM cksum, const uint8_t *buf, uint32_t len)
 {
-    TinyFrame *tf = malloc(sizeof(TinyFrame));
-    if (!tf)
+#if defined(TF_CRC_CLMUL)
+    // x^575, x^511, x^191, x^127 mod 0x104c11db7, bit-reflected
+    static const uint64_t k[4] = {0x653d982200000000, 0xcad38e8f00000000, 0x65673b4600000000, 0x9ba54c6f00000000};
+    uint8_t rem[16];
+    uint32_t n;
+
+    if (len >= 64 && have_pclmul())
     {
-        TF_Error("TF_Init() failed, out of memory.");
-        return NULL;
+        n = crc_fold_clmul(cksum, buf, len, k, rem);
+        cksum = crc32_block(0, rem, 16);
+        buf += n;
+        len -= n;
     }
-
-    TF_InitStatic(tf, peer_bit);
-    return tf;
+#endif
+    return crc32_block(cksum, buf, len);
 }
+#endif
 
-/** Release the struct */
-void TF_DeInit(TinyFrame *tf)
+#elif TF_CKSUM_TYPE == TF_CKSUM_CRC32C
+
+/** CRC table for the CRC-32C (Castagnoli). The reflected poly is 0x82f63b78 */
+static const uint32_t crc32c_table[256] = {
+    0x00000000, 0xf26b8303, 0xe13b70f7, 0x1350f3f4, 0xc79a971f, 0x35f1141c, 0x26a1e7e8, 0xd4ca64eb,
+    0x8ad958cf, 0x78b2dbcc, 0x6be22838, 0x9989ab3b, 0x4d43cfd0, 0xbf284cd3, 0xac78bf27, 0x5e133c24,
+    0x105ec76f, 0xe235446c, 0xf165b798, 0x030e349b, 0xd7c45070, 0x25afd373, 0x36ff2087, 0xc494a384,
+    0x9a879fa0, 0x68ec1ca3, 0x7bbcef57, 0x89d76c54, 0x5d1d08bf, 0xaf768bbc, 0xbc267848, 0x4e4dfb4b,
+    0x20bd8ede, 0xd2d60ddd, 0xc186fe29, 0x33ed7d2a, 0xe72719c1, 0x154c9ac2, 0x061c6936, 0xf477ea35,
+    0xaa64d611, 0x580f5512, 0x4b5fa6e6, 0xb93425e5, 0x6dfe410e, 0x9f95c20d, 0x8cc531f9, 0x7eaeb2fa,
+    0x30e349b1, 0xc288cab2, 0xd1d83946, 0x23b3ba45, 0xf779deae, 0x05125dad, 0x1642ae59, 0xe4292d5a,
+    0xba3a117e, 0x4851927d, 0x5b016189, 0xa96ae28a, 0x7da08661, 0x8fcb0562, 0x9c9bf696, 0x6ef07595,
+    0x417b1dbc, 0xb3109ebf, 0xa0406d4b, 0x522bee48, 0x86e18aa3, 0x748a09a0, 0x67dafa54, 0x95b17957,
+    0xcba24573, 0x39c9c670, 0x2a993584, 0xd8f2b687, 0x0c38d26c, 0xfe53516f, 0xed03a29b, 0x1f682198,
+    0x5125dad3, 0xa34e59d0, 0xb01eaa24, 0x42752927, 0x96bf4dcc, 0x64d4cecf, 0x77843d3b, 0x85efbe38,
+    0xdbfc821c, 0x2997011f, 0x3ac7f2eb, 0xc8ac71e8, 0x1c661503, 0xee0d9600, 0xfd5d65f4, 0x0f36e6f7,
+    0x61c69362, 0x93ad1061, 0x80fde395, 0x72966096, 0xa65c047d, 0x5437877e, 0x4767748a, 0xb50cf789,
+    0xeb1fcbad, 0x197448ae, 0x0a24bb5a, 0xf84f3859, 0x2c855cb2, 0xdeeedfb1, 0xcdbe2c45, 0x3fd5af46,
+    0x7198540d, 0x83f3d70e, 0x90a324fa, 0x62c8a7f9, 0xb602c312, 0x44694011, 0x5739b3e5, 0xa55230e6,
+    0xfb410cc2, 0x092a8fc1, 0x1a7a7c35, 0xe811ff36, 0x3cdb9bdd, 0xceb018de, 0xdde0eb2a, 0x2f8b6829,
+    0x82f63b78, 0x709db87b, 0x63cd4b8f, 0x91a6c88c, 0x456cac67, 0xb7072f64, 0xa457dc90, 0x563c5f93,
+    0x082f63b7, 0xfa44e0b4, 0xe9141340, 0x1b7f9043, 0xcfb5f4a8, 0x3dde77ab, 0x2e8e845f, 0xdce5075c,
+    0x92a8fc17, 0x60c37f14, 0x73938ce0, 0x81f80fe3, 0x55326b08, 0xa759e80b, 0xb4091bff, 0x466298fc,
+    0x1871a4d8, 0xea1a27db, 0xf94ad42f, 0x0b21572c, 0xdfeb33c7, 0x2d80b0c4, 0x3ed04330, 0xccbbc033,
+    0xa24bb5a6, 0x502036a5, 0x4370c551, 0xb11b4652, 0x65d122b9, 0x97baa1ba, 0x84ea524e, 0x7681d14d,
+    0x2892ed69, 0xdaf96e6a, 0xc9a99d9e, 0x3bc21e9d, 0xef087a76, 0x1d63f975, 0x0e330a81, 0xfc588982,
+    0xb21572c9, 0x407ef1ca, 0x532e023e, 0xa145813d, 0x758fe5d6, 0x87e466d5, 0x94b49521, 0x66df1622,
+    0x38cc2a06, 0xcaa7a905, 0xd9f75af1, 0x2b9cd9f2, 0xff56bd19, 0x0d3d3e1a, 0x1e6dcdee, 0xec064eed,
+    0xc38d26c4, 0x31e6a5c7, 0x22b65633, 0xd0ddd530, 0x0417b1db, 0xf67c32d8, 0xe52cc12c, 0x1747422f,
+    0x49547e0b, 0xbb3ffd08, 0xa86f0efc, 0x5a048dff, 0x8ecee914, 0x7ca56a17, 0x6ff599e3, 0x9d9e1ae0,
+    0xd3d3e1ab, 0x21b862a8, 0x32e8915c, 0xc083125f, 0x144976b4, 0xe622f5b7, 0xf5720643, 0x07198540,
+    0x590ab964, 0xab613a67, 0xb831c993, 0x4a5a4a90, 0x9e902e7b, 0x6cfbad78, 0x7fab5e8c, 0x8dc0dd8f,
+    0xe330a81a, 0x115b2b19, 0x020bd8ed, 0xf0605bee, 0x24aa3f05, 0xd6c1bc06, 0xc5914ff2, 0x37faccf1,
+    0x69e9f0d5, 0x9b8273d6, 0x88d28022, 0x7ab90321, 0xae7367ca, 0x5c18e4c9, 0x4f48173d, 0xbd23943e,
+    0xf36e6f75, 0x0105ec76, 0x12551f82, 0xe03e9c81, 0x34f4f86a, 0xc69f7b69, 0xd5cf889d, 0x27a40b9e,
+    0x79b737ba, 0x8bdcb4b9, 0x988c474d, 0x6ae7c44e, 0xbe2da0a5, 0x4c4623a6, 0x5f16d052, 0xad7d5351};
+
+static TF_CKSUM TF_CksumStart(void)
 {
-    if (tf == NULL)
-        return;
-    free(tf);
+    return (TF_CKSUM)0xFFFFFFFF;
 }
 
-// endregion Init
-
-// region Listeners
-
-/** Reset ID listener's timeout to the original value */
-static inline void _TF_FN renew_id_listener(struct TF_IdListener_ *lst)
+static TF_CKSUM TF_CksumAdd(TF_CKSUM cksum, uint8_t byte)
 {
-    lst->timeout = lst->timeout_max;
+    return crc32c_table[(cksum ^ byte) & 0xff] ^ (cksum >> 8);
 }
 
-/** Notify callback about ID listener's demise & let it free any resources in userdata */
-static void _TF_FN cleanup_id_listener(TinyFrame *tf, TF_COUNT i, struct TF_IdListener_ *lst)
+static TF_CKSUM TF_CksumEnd(TF_CKSUM cksum)
 {
-    TF_Msg msg;
-    if (lst->fn == NULL)
-        return;
+    return (TF_CKSUM)~cksum;
+}
+
+#if TF_USE_CRC_HW && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define TF_CRC32C_SSE42
 
-    // Make user clean up their data - only if not NULL
-    if (lst->userdata != NULL || lst->userdata2 != NULL)
+/** CRC-32C with the SSE 4.2 crc32 instruction, only called if the CPU supports it */
+__attribute__((target("sse4.2"))) static uint32_t crc32c_sse42(uint32_t c, const uint8_t *buf, uint32_t len)
+{
+#if defined(__x86_64__)
+    uint64_t c64 = c;
+    uint64_t v64;
+    while (len >= 8)
     {
-        msg.userdata = lst->userdata;
-        msg.userdata2 = lst->userdata2;
-        msg.data = NULL;   // this is a signal that the listener should clean up
-        lst->fn(tf, &msg); // return value is ignored here - use TF_STAY or TF_CLOSE
+        memcpy(&v64, buf, 8);
+        c64 = _mm_crc32_u64(c64, v64);
+        buf += 8;
+        len -= 8;
     }
-
-    lst->fn = NULL; // Discard listener
-    lst->fn_timeout = NULL;
-
-    if (i == tf->count_id_lst - 1)
+    c = (uint32_t)c64;
+#endif
+    uint32_t v32;
+    while (len >= 4)
     {
-        tf->count_id_lst--;
+        memcpy(&v32, buf, 4);
+        c = _mm_crc32_u32(c, v32);
+        buf += 4;
+        len -= 4;
     }
-}
-
-/** Clean up Type listener */
-static inline void _TF_FN cleanup_type_listener(TinyFrame *tf, TF_COUNT i, struct TF_TypeListener_ *lst)
-{
-    lst->fn = NULL; // Discard listener
-    if (i == tf->count_type_lst - 1)
+    while (len--)
     {
-        tf->count_type_lst--;
+        c = _mm_crc32_u8(c, *buf++);
     }
+    return c;
 }
-
-/** Clean up Generic listener */
-static inline void _TF_FN cleanup_generic_listener(TinyFrame *tf, TF_COUNT i, struct TF_GenericListener_ *lst)
+#elif TF_USE_CRC_HW && defined(__ARM_FEATURE_CRC32) && defined(__BYTE_ORDER__) && \
+    (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+// The word loads below give the bytes in stream order only on little-endian
+#include <arm_acle.h>
+#define TF_CRC32C_ARM
+
+/** CRC-32C with the ARMv8 CRC extension (enabled by the compiler target) */
+static uint32_t crc32c_arm(uint32_t c, const uint8_t *buf, uint32_t len)
 {
-    lst->fn = NULL; // Discard listener
-    if (i == tf->count_generic_lst - 1)
+#if defined(__aarch64__)
+    uint64_t v64;
+    while (len >= 8)
+    {
+        memcpy(&v64, buf, 8);
+        c = __crc32cd(c, v64);
+        buf += 8;
+        len -= 8;
+    }
+#endif
+    uint32_t v32;
+    while (len >= 4)
+    {
+        memcpy(&v32, buf, 4);
+        c = __crc32cw(c, v32);
+        buf += 4;
+        len -= 4;
+    }
+    while (len--)
     {
-        tf->count_generic_lst--;
+        c = __crc32cb(c, *buf++);
     }
+    return c;
 }
+#endif
 
-/** Add a new ID listener. Returns 1 on success. */
-bool _TF_FN TF_AddIdListener(TinyFrame *tf, TF_Msg *msg, TF_Listener cb, TF_Listener_Timeout ftimeout, TF_TICKS timeout)
+#define TF_HAS_CKSUM_BLOCK
+
+/** Add a block of bytes - in hardware if available */
+static TF_CKSUM TF_CksumAddBlock(TF_CKSUM cksum, const uint8_t *buf, uint32_t len)
 {
-    TF_COUNT i;
-    struct TF_IdListener_ *lst;
-    for (i = 0; i < TF_MAX_ID_LST; i++)
+#if defined(TF_CRC32C_SSE42)
+    // 0 = not checked yet, 1 = no, 2 = yes; checked once, not on every (often short) block
+    static int sse42;
+    int has = __atomic_load_n(&sse42, __ATOMIC_RELAXED);
+    if (has == 0)
     {
-        lst = &tf->id_listeners[i];
-        // test for empty slot
-        if (lst->fn == NULL)
-        {
-            lst->fn = cb;
-            lst->fn_timeout = ftimeout;
-            lst->id = msg->frame_id;
-            lst->userdata = msg->userdata;
-            lst->userdata2 = msg->userdata2;
-            lst->timeout_max = lst->timeout = timeout;
-            if (i >= tf->count_id_lst)
-            {
-                tf->count_id_lst = (TF_COUNT)(i + 1);
-            }
-            return true;
-        }
+        has = __builtin_cpu_supports("sse4.2") ? 2 : 1;
+        __atomic_store_n(&sse42, has, __ATOMIC_RELAXED);
+    }
+    if (has == 2)
+    {
+        return crc32c_sse42(cksum, buf, len);
+    }
+#elif defined(TF_CRC32C_ARM)
+    return crc32c_arm(cksum, buf, len);
+#endif
+    while (len--)
+    {
+        cksum = TF_CksumAdd(cksum, *buf++);
     }
+    return cksum;
+}
 
-    TF_Error("Failed to add ID listener");
-    return false;
+// Fletcher-16 / Adler-32: two running sums, a = sum of bytes, b = sum of the a's
+#elif (TF_CKSUM_TYPE == TF_CKSUM_FLETCHER16) || (TF_CKSUM_TYPE == TF_CKSUM_ADLER32)
+
+#if TF_CKSUM_TYPE == TF_CKSUM_FLETCHER16
+#define TF_SUM_MOD 255u   // a, b mod 255, packed as (b << 8) | a
+#define TF_SUM_SHIFT 8
+#define TF_SUM_INIT 0u
+#else
+#define TF_SUM_MOD 65521u // a, b mod 65521 (largest prime < 2^16), packed as (b << 16) | a
+#define TF_SUM_SHIFT 16
+#define TF_SUM_INIT 1u
+#endif
+#define TF_SUM_MASK ((1u << TF_SUM_SHIFT) - 1)
+#define TF_SUM_LANES 16
+// Bytes summed before reducing; the lane sums stay below 2^32 (255 * K * (K + 1) / 2 for K = 256)
+#define TF_SUM_CHUNK (TF_SUM_LANES * 256)
+
+static TF_CKSUM TF_CksumStart(void)
+{
+    return (TF_CKSUM)TF_SUM_INIT;
 }
 
-/** Add a new Type listener. Returns 1 on success. */
-bool _TF_FN TF_AddTypeListener(TinyFrame *tf, TF_TYPE frame_type, TF_Listener cb)
+static TF_CKSUM TF_CksumAdd(TF_CKSUM cksum, uint8_t byte)
 {
-    TF_COUNT i;
-    struct TF_TypeListener_ *lst;
-    for (i = 0; i < TF_MAX_TYPE_LST; i++)
-    {
-        lst = &tf->type_listeners[i];
-        // test for empty slot
-        if (lst->fn == NULL)
-        {
-            lst->fn = cb;
-            lst->type = frame_type;
-            if (i >= tf->count_type_lst)
-            {
-                tf->count_type_lst = (TF_COUNT)(i + 1);
-            }
-            return true;
-        }
-    }
+    uint32_t a = (uint32_t)cksum & TF_SUM_MASK;
+    uint32_t b = (uint32_t)cksum >> TF_SUM_SHIFT;
+    a += byte;
+    if (a >= TF_SUM_MOD)
+        a -= TF_SUM_MOD;
+    b += a;
+    if (b >= TF_SUM_MOD)
+        b -= TF_SUM_MOD;
+    return (TF_CKSUM)((b << TF_SUM_SHIFT) | a);
+}
 
-    TF_Error("Failed to add type listener");
-    return false;
+static TF_CKSUM TF_CksumEnd(TF_CKSUM cksum)
+{
+    return cksum;
 }
 
-/** Add a new Generic listener. Returns 1 on success. */
-bool _TF_FN TF_AddGenericListener(TinyFrame *tf, TF_Listener cb)
+#define TF_HAS_CKSUM_BLOCK
+
+/**
+ * Add a block of bytes. Each chunk is summed in 16 independent lanes (A[j] += x, B[j] += A[j]),
+ * which the compiler turns into vector adds, and reduced only once per chunk:
+ * a += sum(A), b += n * a0 + 16 * sum(B) - sum(j * A[j])
+ */
+static TF_CKSUM TF_CksumAddBlock(TF_CKSUM cksum, const uint8_t *buf, uint32_t len)
 {
-    TF_COUNT i;
-    struct TF_GenericListener_ *lst;
-    for (i = 0; i < TF_MAX_GEN_LST; i++)
+    uint32_t a = (uint32_t)cksum & TF_SUM_MASK;
+    uint32_t b = (uint32_t)cksum >> TF_SUM_SHIFT;
+
+    while (len >= TF_SUM_LANES)
     {
-        lst = &tf->generic_listeners[i];
-        // test for empty slot
-        if (lst->fn == NULL)
+        uint32_t n = len < TF_SUM_CHUNK ? (len & ~(uint32_t)(TF_SUM_LANES - 1)) : TF_SUM_CHUNK;
+        uint32_t A[TF_SUM_LANES] = {0};
+        uint32_t B[TF_SUM_LANES] = {0};
+        uint64_t sa = 0, sb = 0, sj = 0;
+        uint32_t i, j;
+
+        for (i = 0; i < n; i += TF_SUM_LANES)
         {
-            lst->fn = cb;
-            if (i >= tf->count_generic_lst)
+            for (j = 0; j < TF_SUM_LANES; j++)
             {
-                tf->count_generic_lst = (TF_COUNT)(i + 1);
+                A[j] += buf[i + j];
+                B[j] += A[j];
             }
-            return true;
         }
+        for (j = 0; j < TF_SUM_LANES; j++)
+        {
+            sa += A[j];
+            sb += B[j];
+            sj += (uint64_t)j * A[j];
+        }
+        b = (uint32_t)(((uint64_t)b + (uint64_t)n * a + TF_SUM_LANES * sb - sj) % TF_SUM_MOD);
+        a = (uint32_t)((a + sa) % TF_SUM_MOD);
+        buf += n;
+        len -= n;
     }
-
-    TF_Error("Failed to add generic listener");
-    return false;
+    while (len--)
+    {
+        a += *buf++;
+        b += a;
+    }
+    a %= TF_SUM_MOD;
+    b %= TF_SUM_MOD;
+    return (TF_CKSUM)((b << TF_SUM_SHIFT) | a);
+}
+
+#endif
+
+#define CKSUM_RESET(cksum)         \
+    do                             \
+    {                              \
+        (cksum) = TF_CksumStart(); \
+    } while (0)
+#define CKSUM_ADD(cksum, byte)                  \
+    do                                          \
+    {                                           \
+        (cksum) = TF_CksumAdd((cksum), (byte)); \
+    } while (0)
+#define CKSUM_FINALIZE(cksum)           \
+    do                                  \
+    {                                   \
+        (cksum) = TF_CksumEnd((cksum)); \
+    } while (0)
+
+#if TF_CKSUM_CUSTOM_BLOCK && ((TF_CKSUM_TYPE == TF_CKSUM_CUSTOM8) || (TF_CKSUM_TYPE == TF_CKSUM_CUSTOM16) || \
+                              (TF_CKSUM_TYPE == TF_CKSUM_CUSTOM32))
+// Implemented by the user, see TinyFrame.h
+#define TF_HAS_CKSUM_BLOCK
+#endif
+
+#ifndef TF_HAS_CKSUM_BLOCK
+/** Add a block of bytes to a checksum */
+static inline TF_CKSUM TF_CksumAddBlock(TF_CKSUM cksum, const uint8_t *buf, uint32_t len)
+{
+    while (len--)
+    {
+        cksum = TF_CksumAdd(cksum, *buf++);
+    }
+    return cksum;
+}
+#endif
+
+#define CKSUM_ADD_BLOCK(cksum, buf, len)                    \
+    do                                                      \
+    {                                                       \
+        (cksum) = TF_CksumAddBlock((cksum), (buf), (len)); \
+    } while (0)
+
+/** Checksum of a whole buffer, as it would be sent in a frame */
+TF_CKSUM _TF_FN TF_Cksum(const uint8_t *buf, uint32_t len)
+{
+    TF_CKSUM cksum;
+    CKSUM_RESET(cksum);
+    CKSUM_ADD_BLOCK(cksum, buf, len);
+    CKSUM_FINALIZE(cksum);
+    return cksum;
+}
+
+#if (TF_CKSUM_TYPE == TF_CKSUM_CRC8) || (TF_CKSUM_TYPE == TF_CKSUM_CRC16) || (TF_CKSUM_TYPE == TF_CKSUM_CRC32) || \
+    (TF_CKSUM_TYPE == TF_CKSUM_CRC32C)
+
+// Reflected polynomial and the bit standing for x^0
+#if TF_CKSUM_TYPE == TF_CKSUM_CRC8
+#define TF_CRC_POLY 0x8Cu
+#elif TF_CKSUM_TYPE == TF_CKSUM_CRC16
+#define TF_CRC_POLY 0xA001u
+#elif TF_CKSUM_TYPE == TF_CKSUM_CRC32
+#define TF_CRC_POLY 0xEDB88320u
+#else
+#define TF_CRC_POLY 0x82F63B78u
+#endif
+#define TF_CRC_ONE ((uint32_t)1 << (sizeof(TF_CKSUM) * 8 - 1))
+
+/** a * b mod P (reflected, as in zlib) */
+static uint32_t crc_multmodp(uint32_t a, uint32_t b)
+{
+    uint32_t m = TF_CRC_ONE;
+    uint32_t p = 0;
+
+    for (;;)
+    {
+        if (a & m)
+        {
+            p ^= b;
+            if ((a & (m - 1)) == 0)
+                break;
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ TF_CRC_POLY : b >> 1;
+    }
+    return p;
+}
+
+/** x^(8 * n) mod P, by squaring */
+static uint32_t crc_x8nmodp(uint32_t n)
+{
+    uint32_t p = TF_CRC_ONE;
+    uint32_t q = TF_CRC_ONE >> 1; // x^1
+
+    q = crc_multmodp(q, q); // x^2
+    q = crc_multmodp(q, q); // x^4
+    q = crc_multmodp(q, q); // x^8
+    while (n)
+    {
+        if (n & 1)
+            p = crc_multmodp(q, p);
+        q = crc_multmodp(q, q);
+        n >>= 1;
+    }
+    return p;
+}
+
+/** Checksum of A followed by B, from the checksums of A and B. The pre- and post-inversion cancel out */
+TF_CKSUM _TF_FN TF_CksumCombine(TF_CKSUM cksum1, TF_CKSUM cksum2, uint32_t len2)
+{
+    return (TF_CKSUM)(crc_multmodp(crc_x8nmodp(len2), cksum1) ^ cksum2);
+}
+
+#elif (TF_CKSUM_TYPE == TF_CKSUM_FLETCHER16) || (TF_CKSUM_TYPE == TF_CKSUM_ADLER32)
+
+/** a = a1 + a2 - a0, b = b1 + b2 + len2 * (a1 - a0), all mod TF_SUM_MOD */
+TF_CKSUM _TF_FN TF_CksumCombine(TF_CKSUM cksum1, TF_CKSUM cksum2, uint32_t len2)
+{
+    uint32_t a1 = (uint32_t)cksum1 & TF_SUM_MASK;
+    uint32_t b1 = (uint32_t)cksum1 >> TF_SUM_SHIFT;
+    uint32_t a2 = (uint32_t)cksum2 & TF_SUM_MASK;
+    uint32_t b2 = (uint32_t)cksum2 >> TF_SUM_SHIFT;
+    uint32_t n = len2 % TF_SUM_MOD;
+    uint32_t a = (a1 + a2 + TF_SUM_MOD - TF_SUM_INIT) % TF_SUM_MOD;
+    uint32_t b = (uint32_t)((b1 + b2 + (uint64_t)n * (a1 + TF_SUM_MOD - TF_SUM_INIT)) % TF_SUM_MOD);
+
+    return (TF_CKSUM)((b << TF_SUM_SHIFT) | a);
+}
+
+#elif TF_CKSUM_TYPE == TF_CKSUM_XOR
+
+/** ~(x1 ^ x2) = ~(~c1 ^ ~c2) */
+TF_CKSUM _TF_FN TF_CksumCombine(TF_CKSUM cksum1, TF_CKSUM cksum2, uint32_t len2)
+{
+    (void)len2;
+    return (TF_CKSUM) ~(cksum1 ^ cksum2);
+}
+
+#elif TF_CKSUM_TYPE == TF_CKSUM_NONE
+
+TF_CKSUM _TF_FN TF_CksumCombine(TF_CKSUM cksum1, TF_CKSUM cksum2, uint32_t len2)
+{
+    (void)cksum1;
+    (void)cksum2;
+    (void)len2;
+    return 0;
+}
+
+#endif
+
+// endregion
+
+// region Init
+
+/** Init with a user-allocated buffer */
+bool _TF_FN TF_InitStatic(TinyFrame *tf, TF_Peer peer_bit)
+{
+    if (tf == NULL)
+    {
+        TF_Error("TF_InitStatic() failed, tf is null.");
+        return false;
+    }
+
+    // Zero it out, keeping user config and the buffers
+    uint32_t usertag = tf->usertag;
+    void *userdata = tf->userdata;
+    void (*dealloc)(void *ptr) = tf->dealloc;
+#if TF_USE_EXTERNAL_BUFFERS
+    uint8_t *data = tf->data;
+    uint32_t data_size = tf->data_size;
+    uint8_t *sendbuf = tf->sendbuf;
+    uint32_t sendbuf_size = tf->sendbuf_size;
+
+    if (data == NULL || sendbuf == NULL)
+    {
+        TF_Error("TF_InitStatic() failed, no buffers - use TF_InitStaticEx().");
+        return false;
+    }
+#endif
+#if TF_USE_EXTERNAL_LISTENERS
+    struct TF_IdListener_ *id_listeners = tf->id_listeners;
+    struct TF_TypeListener_ *type_listeners = tf->type_listeners;
+    struct TF_GenericListener_ *generic_listeners = tf->generic_listeners;
+    TF_COUNT max_id_lst = tf->max_id_lst;
+    TF_COUNT max_type_lst = tf->max_type_lst;
+    TF_COUNT max_generic_lst = tf->max_generic_lst;
+    TF_COUNT *id_index = tf->id_index;
+    uint32_t id_mask = tf->id_mask;
+#if TF_TYPE_BYTES > 1
+    TF_COUNT *type_index = tf->type_index;
+    uint32_t type_mask = tf->type_mask;
+#endif
+
+    if (id_listeners == NULL || type_listeners == NULL || generic_listeners == NULL || id_index == NULL
+#if TF_TYPE_BYTES > 1
+        || type_index == NULL
+#endif
+    )
+    {
+        TF_Error("TF_InitStatic() failed, no listener tables - use TF_InitStaticEx().");
+        return false;
+    }
+
+    // Remove all listeners
+    memset(id_listeners, 0, max_id_lst * sizeof(struct TF_IdListener_));
+    memset(type_listeners, 0, max_type_lst * sizeof(struct TF_TypeListener_));
+    memset(generic_listeners, 0, max_generic_lst * sizeof(struct TF_GenericListener_));
+    memset(id_index, 0, (id_mask + 1) * sizeof(TF_COUNT));
+#if TF_TYPE_BYTES > 1
+    memset(type_index, 0, (type_mask + 1) * sizeof(TF_COUNT));
+#endif
+#endif
+
+    memset(tf, 0, sizeof(struct TinyFrame_));
+
+    tf->usertag = usertag;
+    tf->userdata = userdata;
+    tf->dealloc = dealloc;
+#if TF_USE_EXTERNAL_BUFFERS
+    tf->data = data;
+    tf->data_size = data_size;
+    tf->sendbuf = sendbuf;
+    tf->sendbuf_size = sendbuf_size;
+#endif
+#if TF_USE_EXTERNAL_LISTENERS
+    tf->id_listeners = id_listeners;
+    tf->type_listeners = type_listeners;
+    tf->generic_listeners = generic_listeners;
+    tf->max_id_lst = max_id_lst;
+    tf->max_type_lst = max_type_lst;
+    tf->max_generic_lst = max_generic_lst;
+    tf->id_index = id_index;
+    tf->id_mask = id_mask;
+#if TF_TYPE_BYTES > 1
+    tf->type_index = type_index;
+    tf->type_mask = type_mask;
+#endif
+#endif
+
+    tf->peer_bit = peer_bit;
+    return true;
+}
+
+#if TF_USE_EXTERNAL_LISTENERS
+/** Nr of lookup buckets for a listener table, same as TF_INDEX_LEN() */
+static uint32_t _TF_FN index_len(uint32_t slots)
+{
+    uint32_t n = 8;
+    while (n < slots && n < 65536)
+    {
+        n <<= 1;
+    }
+    return n;
+}
+#endif
+
+/** Init with a user-allocated buffer and explicit configuration */
+bool _TF_FN TF_InitStaticEx(TinyFrame *tf, TF_Peer peer_bit, const TF_InitCfg *cfg)
+{
+    if (tf == NULL)
+    {
+        TF_Error("TF_InitStaticEx() failed, tf is null.");
+        return false;
+    }
+
+#if TF_USE_EXTERNAL_BUFFERS
+    if (cfg == NULL || cfg->rx_buf == NULL || cfg->tx_buf == NULL)
+    {
+        TF_Error("TF_InitStaticEx() failed, buffers missing.");
+        return false;
+    }
+
+    uint32_t rx_len = cfg->rx_len ? cfg->rx_len : TF_MAX_PAYLOAD_RX;
+    uint32_t tx_len = cfg->tx_len ? cfg->tx_len : TF_SENDBUF_LEN;
+
+    // The header is composed in one piece
+    if (tx_len < TF_USE_SOF_BYTE + TF_HEAD_BYTES)
+    {
+        TF_Error("TF_InitStaticEx() failed, tx buffer too small.");
+        return false;
+    }
+
+    tf->data = cfg->rx_buf;
+    tf->data_size = rx_len;
+    tf->sendbuf = cfg->tx_buf;
+    tf->sendbuf_size = tx_len;
+#endif
+#if TF_USE_EXTERNAL_LISTENERS
+    if (cfg == NULL || cfg->id_lst == NULL || cfg->type_lst == NULL || cfg->gen_lst == NULL || cfg->id_index == NULL
+#if TF_TYPE_BYTES > 1
+        || cfg->type_index == NULL
+#endif
+    )
+    {
+        TF_Error("TF_InitStaticEx() failed, listener tables missing.");
+        return false;
+    }
+
+    TF_COUNT id_lst_len = cfg->id_lst_len ? cfg->id_lst_len : TF_MAX_ID_LST;
+    TF_COUNT type_lst_len = cfg->type_lst_len ? cfg->type_lst_len : TF_MAX_TYPE_LST;
+    TF_COUNT gen_lst_len = cfg->gen_lst_len ? cfg->gen_lst_len : TF_MAX_GEN_LST;
+
+    // Slots are linked as slot + 1, which must fit in TF_COUNT
+    if (id_lst_len == (TF_COUNT)~0u || type_lst_len == (TF_COUNT)~0u || gen_lst_len == (TF_COUNT)~0u)
+    {
+        TF_Error("TF_InitStaticEx() failed, listener table too large for TF_COUNT.");
+        return false;
+    }
+
+    tf->id_listeners = cfg->id_lst;
+    tf->max_id_lst = id_lst_len;
+    tf->type_listeners = cfg->type_lst;
+    tf->max_type_lst = type_lst_len;
+    tf->generic_listeners = cfg->gen_lst;
+    tf->max_generic_lst = gen_lst_len;
+    tf->id_index = cfg->id_index;
+    tf->id_mask = index_len(id_lst_len) - 1;
+#if TF_TYPE_BYTES > 1
+    tf->type_index = cfg->type_index;
+    tf->type_mask = index_len(type_lst_len) - 1;
+#endif
+#endif
+#if !TF_USE_EXTERNAL_BUFFERS && !TF_USE_EXTERNAL_LISTENERS
+    (void)cfg;
+#endif
+
+    // Not ours to free
+    tf->dealloc = NULL;
+    return TF_InitStatic(tf, peer_bit);
+}
+
+/** Init with an allocator; missing buffers share the allocation with the struct */
+TinyFrame *_TF_FN TF_InitEx(TF_Peer peer_bit, const TF_InitCfg *cfg)
+{
+    TF_InitCfg c;
+    if (cfg != NULL)
+        c = *cfg;
+    else
+        memset(&c, 0, sizeof(c));
+
+    void *(*alloc)(size_t size) = c.alloc ? c.alloc : malloc;
+    void (*dealloc)(void *ptr) = c.dealloc ? c.dealloc : free;
+
+    size_t size = sizeof(TinyFrame);
+#if TF_USE_EXTERNAL_LISTENERS
+    // The tables go first, right after the struct, where they are aligned like it
+    if (c.id_lst_len == 0)
+        c.id_lst_len = TF_MAX_ID_LST;
+    if (c.type_lst_len == 0)
+        c.type_lst_len = TF_MAX_TYPE_LST;
+    if (c.gen_lst_len == 0)
+        c.gen_lst_len = TF_MAX_GEN_LST;
+    if (c.id_lst == NULL)
+        size += c.id_lst_len * sizeof(struct TF_IdListener_);
+    if (c.type_lst == NULL)
+        size += c.type_lst_len * sizeof(struct TF_TypeListener_);
+    if (c.gen_lst == NULL)
+        size += c.gen_lst_len * sizeof(struct TF_GenericListener_);
+    if (c.id_index == NULL)
+        size += index_len(c.id_lst_len) * sizeof(TF_COUNT);
+#if TF_TYPE_BYTES > 1
+    if (c.type_index == NULL)
+        size += index_len(c.type_lst_len) * sizeof(TF_COUNT);
+#endif
+#endif
+#if TF_USE_EXTERNAL_BUFFERS
+    if (c.rx_len == 0)
+        c.rx_len = TF_MAX_PAYLOAD_RX;
+    if (c.tx_len == 0)
+        c.tx_len = TF_SENDBUF_LEN;
+    if (c.rx_buf == NULL)
+        size += c.rx_len;
+    if (c.tx_buf == NULL)
+        size += c.tx_len;
+#endif
+
+    TinyFrame *tf = alloc(size);
+    if (!tf)
+    {
+        TF_Error("TF_InitEx() failed, out of memory.");
+        return NULL;
+    }
+
+    memset(tf, 0, sizeof(TinyFrame));
+
+    uint8_t *p = (uint8_t *)(tf + 1);
+#if TF_USE_EXTERNAL_LISTENERS
+    if (c.id_lst == NULL)
+    {
+        c.id_lst = (struct TF_IdListener_ *)(void *)p;
+        p += c.id_lst_len * sizeof(struct TF_IdListener_);
+    }
+    if (c.type_lst == NULL)
+    {
+        c.type_lst = (struct TF_TypeListener_ *)(void *)p;
+        p += c.type_lst_len * sizeof(struct TF_TypeListener_);
+    }
+    if (c.gen_lst == NULL)
+    {
+        c.gen_lst = (struct TF_GenericListener_ *)(void *)p;
+        p += c.gen_lst_len * sizeof(struct TF_GenericListener_);
+    }
+    // The bucket tables after the listener tables, TF_COUNT is aligned there
+    if (c.id_index == NULL)
+    {
+        c.id_index = (TF_COUNT *)(void *)p;
+        p += index_len(c.id_lst_len) * sizeof(TF_COUNT);
+    }
+#if TF_TYPE_BYTES > 1
+    if (c.type_index == NULL)
+    {
+        c.type_index = (TF_COUNT *)(void *)p;
+        p += index_len(c.type_lst_len) * sizeof(TF_COUNT);
+    }
+#endif
+#endif
+#if TF_USE_EXTERNAL_BUFFERS
+    if (c.rx_buf == NULL)
+    {
+        c.rx_buf = p;
+        p += c.rx_len;
+    }
+    if (c.tx_buf == NULL)
+        c.tx_buf = p;
+#else
+    (void)p;
+#endif
+
+    if (!TF_InitStaticEx(tf, peer_bit, &c))
+    {
+        dealloc(tf);
+        return NULL;
+    }
+
+    tf->dealloc = c.dealloc;
+    return tf;
+}
+
+/** Init with malloc */
+TinyFrame *_TF_FN TF_Init(TF_Peer peer_bit)
+{
+    return TF_InitEx(peer_bit, NULL);
+}
+
+/** Release the struct */
+void TF_DeInit(TinyFrame *tf)
+{
+    if (tf == NULL)
+        return;
+    if (tf->dealloc != NULL)
+        tf->dealloc(tf);
+    else
+        free(tf);
+}
+
+// endregion Init
+
+// region Listeners
+
+/**
+ * Take a slot of a listener array: one freed earlier, or the next never used one.
+ * 'kind' is id / type / generic / stream. Stores the slot in 'i', false if the array is full.
+ */
+#define TAKE_SLOT(tf, kind, max, i)                                                                                \
+    ((tf)->kind##_free != 0                                                                                        \
+         ? ((i) = (TF_COUNT)((tf)->kind##_free - 1), (tf)->kind##_free = (tf)->kind##_listeners[(i)].next, true) \
+         : (tf)->count_##kind##_lst < (max) ? ((i) = (tf)->count_##kind##_lst++, true) : false)
+
+/** Put a slot of a listener array on its free list (reuses ->next) */
+#define FREE_SLOT(tf, kind, i)                                            \
+    do                                                                    \
+    {                                                                     \
+        (tf)->kind##_listeners[(i)].next = (tf)->kind##_free;             \
+        (tf)->kind##_free = (TF_COUNT)((i) + 1);                          \
+    } while (0)
+
+/** Timing wheel slot of an expiry time */
+static inline uint32_t _TF_FN timer_slot(TF_TICKS t)
+{
+    return (uint32_t)t & (TF_TIMER_SLOTS - 1);
+}
+
+/** Append an ID listener to the ring of its timing wheel slot */
+static void _TF_FN timer_link(TinyFrame *tf, TF_COUNT i, struct TF_IdListener_ *lst)
+{
+    TF_COUNT *head = &tf->timer_wheel[timer_slot(lst->deadline)];
+    struct TF_IdListener_ *first;
+
+    if (*head == 0)
+    {
+        lst->wnext = (TF_COUNT)(i + 1);
+        lst->wprev = (TF_COUNT)(i + 1);
+        *head = (TF_COUNT)(i + 1);
+    }
+    else
+    {
+        // the ring is circular, the tail is head->wprev
+        first = &tf->id_listeners[*head - 1];
+        lst->wnext = *head;
+        lst->wprev = first->wprev;
+        tf->id_listeners[first->wprev - 1].wnext = (TF_COUNT)(i + 1);
+        first->wprev = (TF_COUNT)(i + 1);
+    }
+    tf->timer_count++;
+}
+
+/** Take an ID listener out of the timing wheel, or out of the list TF_Tick() is going through */
+static void _TF_FN timer_unlink(TinyFrame *tf, TF_COUNT i, struct TF_IdListener_ *lst)
+{
+    TF_COUNT next = 0; // new head if this one was the head
+    TF_COUNT *head;
+
+    if (lst->wnext == 0)
+        return; // not scheduled
+
+    if (lst->wnext != i + 1)
+    {
+        next = lst->wnext;
+        tf->id_listeners[lst->wprev - 1].wnext = lst->wnext;
+        tf->id_listeners[lst->wnext - 1].wprev = lst->wprev;
+    }
+
+    head = &tf->timer_wheel[timer_slot(lst->deadline)];
+    if (tf->timer_due == i + 1)
+    {
+        head = &tf->timer_due;
+    }
+    if (*head == i + 1)
+    {
+        *head = next;
+    }
+    lst->wnext = 0;
+    tf->timer_count--;
+}
+
+/** Reset ID listener's timeout to the original value - reschedules it in the timing wheel */
+static void _TF_FN renew_id_listener(TinyFrame *tf, TF_COUNT i, struct TF_IdListener_ *lst)
+{
+#if TF_USE_CLOCK
+    TF_TICKS now;
+#endif
+    timer_unlink(tf, i, lst);
+    if (lst->timeout_max == 0)
+        return; // no timeout
+
+#if TF_USE_CLOCK
+    now = TF_GetTime(tf);
+    if (tf->timer_count == 0)
+    {
+        // nothing is scheduled, the wheel can skip the time TF_Tick() was not called
+        tf->timer_now = now;
+    }
+    lst->deadline = (TF_TICKS)(now + lst->timeout_max);
+#else
+    lst->deadline = (TF_TICKS)(tf->timer_now + lst->timeout_max);
+#endif
+    timer_link(tf, i, lst);
+}
+
+/** Bucket of a frame ID in tf->id_index - IDs are sequential, so the low bits spread them best */
+static inline uint32_t _TF_FN id_bucket(TinyFrame *tf, TF_ID id)
+{
+    (void)tf; // the mask is a constant without TF_USE_EXTERNAL_LISTENERS
+    return (uint32_t)id & TF_ID_BUCKET_MASK(tf);
+}
+
+/** Find the first live ID listener for a frame ID */
+static struct TF_IdListener_ *_TF_FN find_id_listener(TinyFrame *tf, TF_ID id)
+{
+    TF_COUNT n;
+    struct TF_IdListener_ *lst;
+    for (n = tf->id_index[id_bucket(tf, id)]; n != 0; n = lst->next)
+    {
+        lst = &tf->id_listeners[n - 1];
+        if (lst->fn != NULL && lst->id == id)
+        {
+            return lst;
+        }
+    }
+    return NULL;
+}
+
+/** Notify callback about ID listener's demise & let it free any resources in userdata */
+static void _TF_FN cleanup_id_listener(TinyFrame *tf, TF_COUNT i, struct TF_IdListener_ *lst)
+{
+    TF_Msg msg;
+    TF_COUNT *link;
+    TF_Listener fn = lst->fn;
+
+    if (fn != NULL)
+    {
+        lst->fn = NULL; // Discard listener
+        lst->fn_timeout = NULL;
+        timer_unlink(tf, i, lst);
+
+        // Make user clean up their data - only if not NULL
+        if (lst->userdata != NULL || lst->userdata2 != NULL)
+        {
+            msg.userdata = lst->userdata;
+            msg.userdata2 = lst->userdata2;
+            msg.data = NULL; // this is a signal that the listener should clean up
+            lst->pins++;
+            fn(tf, &msg); // return value is ignored here - use TF_STAY or TF_CLOSE
+            lst->pins--;
+        }
+    }
+
+    // Removed while one of its callbacks runs - it stays in the bucket, so the slot is not reused
+    // and its ->next stays valid; the caller of the callback frees it when that returns
+    if (lst->pins != 0)
+        return;
+
+    // Unlink from the bucket and put the slot on the free list
+    link = &tf->id_index[id_bucket(tf, lst->id)];
+    while (*link != i + 1)
+    {
+        link = &tf->id_listeners[*link - 1].next;
+    }
+    *link = lst->next;
+    FREE_SLOT(tf, id, i);
+}
+
+/** Bucket of a frame type in tf->type_index */
+static inline uint32_t _TF_FN type_bucket(TinyFrame *tf, TF_TYPE type)
+{
+    (void)tf;
+#if TF_TYPE_BYTES == 1
+    return (uint32_t)type & (TF_TYPE_BUCKETS - 1);
+#else
+    uint32_t h = (uint32_t)type;
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return h & TF_TYPE_BUCKET_MASK(tf);
+#endif
+}
+
+/** Clean up Type listener - unlink it from its bucket and free the slot (once no callback runs it) */
+static void _TF_FN cleanup_type_listener(TinyFrame *tf, TF_COUNT i, struct TF_TypeListener_ *lst)
+{
+    TF_COUNT *link;
+    lst->fn = NULL; // Discard listener
+    if (lst->pins != 0)
+        return; // dispatch_msg() frees it when the last callback returns
+
+    link = &tf->type_index[type_bucket(tf, lst->type)];
+    while (*link != i + 1)
+    {
+        link = &tf->type_listeners[*link - 1].next;
+    }
+    *link = lst->next;
+    FREE_SLOT(tf, type, i);
+}
+
+/** Clean up Generic listener - unlink it from the list and free the slot (once no callback runs it) */
+static void _TF_FN cleanup_generic_listener(TinyFrame *tf, TF_COUNT i, struct TF_GenericListener_ *lst)
+{
+    TF_COUNT *link;
+    lst->fn = NULL; // Discard listener
+    if (lst->pins != 0)
+        return; // dispatch_msg() frees it when the last callback returns
+
+    link = &tf->generic_head;
+    while (*link != i + 1)
+    {
+        link = &tf->generic_listeners[*link - 1].next;
+    }
+    *link = lst->next;
+    FREE_SLOT(tf, generic, i);
+}
+
+/** Add a new ID listener. Returns 1 on success. */
+bool _TF_FN TF_AddIdListener(TinyFrame *tf, TF_Msg *msg, TF_Listener cb, TF_Listener_Timeout ftimeout, TF_TICKS timeout)
+{
+    TF_COUNT i;
+    TF_COUNT *link;
+    struct TF_IdListener_ *lst;
+
+    LST_LOCK(tf);
+    if (!TAKE_SLOT(tf, id, TF_ID_LST_CAP(tf), i))
+    {
+        TF_Error("Failed to add ID listener");
+        LST_UNLOCK(tf);
+        return false;
+    }
+
+    lst = &tf->id_listeners[i];
+    lst->fn = cb;
+    lst->fn_timeout = ftimeout;
+    lst->id = msg->frame_id;
+    lst->userdata = msg->userdata;
+    lst->userdata2 = msg->userdata2;
+    lst->timeout_max = timeout;
+    lst->wnext = 0; // not scheduled yet
+    lst->pins = 0;
+    renew_id_listener(tf, i, lst);
+
+    // Append to the bucket, listeners for the same ID run in the order they were added
+    link = &tf->id_index[id_bucket(tf, lst->id)];
+    while (*link != 0)
+    {
+        link = &tf->id_listeners[*link - 1].next;
+    }
+    lst->next = 0;
+    *link = (TF_COUNT)(i + 1);
+    LST_UNLOCK(tf);
+    return true;
+}
+
+/** Add a new Type listener. Returns 1 on success. */
+bool _TF_FN TF_AddTypeListener(TinyFrame *tf, TF_TYPE frame_type, TF_Listener cb)
+{
+    TF_COUNT i;
+    TF_COUNT *link;
+    struct TF_TypeListener_ *lst;
+
+    LST_LOCK(tf);
+    if (!TAKE_SLOT(tf, type, TF_TYPE_LST_CAP(tf), i))
+    {
+        TF_Error("Failed to add type listener");
+        LST_UNLOCK(tf);
+        return false;
+    }
+
+    lst = &tf->type_listeners[i];
+    lst->fn = cb;
+    lst->type = frame_type;
+    lst->pins = 0;
+
+    // Append to the bucket, listeners of one type run in the order they were added
+    link = &tf->type_index[type_bucket(tf, frame_type)];
+    while (*link != 0)
+    {
+        link = &tf->type_listeners[*link - 1].next;
+    }
+    lst->next = 0;
+    *link = (TF_COUNT)(i + 1);
+    LST_UNLOCK(tf);
+    return true;
+}
+
+/** Add a new Generic listener. Returns 1 on success. */
+bool _TF_FN TF_AddGenericListener(TinyFrame *tf, TF_Listener cb)
+{
+    TF_COUNT i;
+    TF_COUNT *link;
+    struct TF_GenericListener_ *lst;
+
+    LST_LOCK(tf);
+    if (!TAKE_SLOT(tf, generic, TF_GEN_LST_CAP(tf), i))
+    {
+        TF_Error("Failed to add generic listener");
+        LST_UNLOCK(tf);
+        return false;
+    }
+
+    lst = &tf->generic_listeners[i];
+    lst->fn = cb;
+    lst->pins = 0;
+
+    // Append to the list, generic listeners run in the order they were added
+    link = &tf->generic_head;
+    while (*link != 0)
+    {
+        link = &tf->generic_listeners[*link - 1].next;
+    }
+    lst->next = 0;
+    *link = (TF_COUNT)(i + 1);
+    LST_UNLOCK(tf);
+    return true;
+}
+
+/** Remove a ID listener by its frame ID. Returns 1 on success. */
+bool _TF_FN TF_RemoveIdListener(TinyFrame *tf, TF_ID frame_id)
+{
+    struct TF_IdListener_ *lst;
+
+    LST_LOCK(tf);
+    lst = find_id_listener(tf, frame_id);
+    if (lst != NULL)
+    {
+        cleanup_id_listener(tf, (TF_COUNT)(lst - tf->id_listeners), lst);
+        LST_UNLOCK(tf);
+        return true;
+    }
+
+    TF_Error("ID listener %d to remove not found", (int)frame_id);
+    LST_UNLOCK(tf);
+    return false;
+}
+
+/** Remove a type listener by its type. Returns 1 on success. */
+bool _TF_FN TF_RemoveTypeListener(TinyFrame *tf, TF_TYPE type)
+{
+    TF_COUNT n;
+    struct TF_TypeListener_ *lst;
+
+    LST_LOCK(tf);
+    for (n = tf->type_index[type_bucket(tf, type)]; n != 0; n = lst->next)
+    {
+        lst = &tf->type_listeners[n - 1];
+        // test if matching (skip a listener already removed while its callback runs)
+        if (lst->fn != NULL && lst->type == type)
+        {
+            cleanup_type_listener(tf, (TF_COUNT)(n - 1), lst);
+            LST_UNLOCK(tf);
+            return true;
+        }
+    }
+
+    TF_Error("Type listener %d to remove not found", (int)type);
+    LST_UNLOCK(tf);
+    return false;
+}
+
+/** Remove a generic listener by its function pointer. Returns 1 on success. */
+bool _TF_FN TF_RemoveGenericListener(TinyFrame *tf, TF_Listener cb)
+{
+    TF_COUNT n;
+    struct TF_GenericListener_ *lst;
+
+    LST_LOCK(tf);
+    for (n = tf->generic_head; n != 0; n = lst->next)
+    {
+        lst = &tf->generic_listeners[n - 1];
+        // test if matching (a listener removed while its callback runs has fn == NULL)
+        if (lst->fn == cb)
+        {
+            cleanup_generic_listener(tf, (TF_COUNT)(n - 1), lst);
+            LST_UNLOCK(tf);
+            return true;
+        }
+    }
+
+    TF_Error("Generic listener to remove not found");
+    LST_UNLOCK(tf);
+    return false;
+}
+
+#if TF_USE_RANGE_LST
+/** Check if a type is matched by a Range / Mask listener */
+static inline bool _TF_FN range_match(const struct TF_RangeListener_ *lst, TF_TYPE type)
+{
+    return type >= lst->lo && type <= lst->hi && (type & lst->mask) == lst->value;
+}
+
+/** Check if a Range / Mask listener may match some type with the low byte 'b' */
+static bool _TF_FN range_match_byte(const struct TF_RangeListener_ *lst, uint32_t b)
+{
+    if ((b & lst->mask & 0xFFu) != (lst->value & 0xFFu))
+        return false;
+#if TF_TYPE_BYTES == 1
+    return b >= lst->lo && b <= lst->hi;
+#else
+    // A range of 256 types or more covers every low byte, a shorter one may wrap past 0xFF
+    TF_TYPE span = (TF_TYPE)(lst->hi - lst->lo);
+    return span >= 0xFFu || ((b - (uint32_t)lst->lo) & 0xFFu) <= span;
+#endif
+}
+
+/** Clean up Range listener - move the index past it, unlink it from the list and free the slot (once no callback runs it) */
+static void _TF_FN cleanup_range_listener(TinyFrame *tf, TF_COUNT i, struct TF_RangeListener_ *lst)
+{
+    TF_COUNT *link = &tf->range_head;
+    TF_COUNT n;
+    uint32_t b;
+
+    lst->fn = NULL; // Discard listener
+    if (lst->pins != 0)
+        return; // dispatch_msg() frees it when the last callback returns, the index may point here until then
+
+    // Index entries pointing here go to the next listener that may match their byte
+    for (b = 0; b < 256; b++)
+    {
+        if (tf->range_index[b] != i + 1)
+            continue;
+        n = lst->next;
+        while (n != 0 && !range_match_byte(&tf->range_listeners[n - 1], b))
+        {
+            n = tf->range_listeners[n - 1].next;
+        }
+        tf->range_index[b] = n;
+    }
+
+    while (*link != i + 1)
+    {
+        link = &tf->range_listeners[*link - 1].next;
+    }
+    *link = lst->next;
+    FREE_SLOT(tf, range, i);
+}
+
+/** Add a Range / Mask listener and compile it into the index. Returns 1 on success. */
+static bool _TF_FN add_range_listener(TinyFrame *tf, TF_TYPE lo, TF_TYPE hi, TF_TYPE mask, TF_TYPE value, TF_Listener cb)
+{
+    TF_COUNT i;
+    TF_COUNT *link;
+    struct TF_RangeListener_ *lst;
+    uint32_t b;
+
+    LST_LOCK(tf);
+    if (!TAKE_SLOT(tf, range, TF_MAX_RANGE_LST, i))
+    {
+        TF_Error("Failed to add range listener");
+        LST_UNLOCK(tf);
+        return false;
+    }
+
+    lst = &tf->range_listeners[i];
+    lst->lo = lo;
+    lst->hi = hi;
+    lst->mask = mask;
+    lst->value = value;
+    lst->fn = cb;
+    lst->pins = 0;
+
+    // Append to the list, overlapping listeners run in the order they were added
+    link = &tf->range_head;
+    while (*link != 0)
+    {
+        link = &tf->range_listeners[*link - 1].next;
+    }
+    lst->next = 0;
+    *link = (TF_COUNT)(i + 1);
+
+    // Bytes already indexed start at an earlier listener, which runs first anyway
+    for (b = 0; b < 256; b++)
+    {
+        if (tf->range_index[b] == 0 && range_match_byte(lst, b))
+        {
+            tf->range_index[b] = (TF_COUNT)(i + 1);
+        }
+    }
+    LST_UNLOCK(tf);
+    return true;
+}
+
+/** Remove a Range / Mask listener by its lo, hi, mask and value. Returns 1 on success. */
+static bool _TF_FN remove_range_listener(TinyFrame *tf, TF_TYPE lo, TF_TYPE hi, TF_TYPE mask, TF_TYPE value)
+{
+    TF_COUNT n;
+    struct TF_RangeListener_ *lst;
+
+    LST_LOCK(tf);
+    for (n = tf->range_head; n != 0; n = lst->next)
+    {
+        lst = &tf->range_listeners[n - 1];
+        if (lst->fn != NULL && lst->lo == lo && lst->hi == hi && lst->mask == mask && lst->value == value)
+        {
+            cleanup_range_listener(tf, (TF_COUNT)(n - 1), lst);
+            LST_UNLOCK(tf);
+            return true;
+        }
+    }
+    LST_UNLOCK(tf);
+    return false;
+}
+
+bool _TF_FN TF_AddTypeRangeListener(TinyFrame *tf, TF_TYPE lo, TF_TYPE hi, TF_Listener cb)
+{
+    if (lo > hi)
+    {
+        TF_Error("Bad type range %d..%d", (int)lo, (int)hi);
+        return false;
+    }
+    return add_range_listener(tf, lo, hi, 0, 0, cb);
+}
+
+bool _TF_FN TF_AddTypeMaskListener(TinyFrame *tf, TF_TYPE mask, TF_TYPE value, TF_Listener cb)
+{
+    if ((value & mask) != value)
+    {
+        TF_Error("Type mask listener value %d has bits outside mask %d", (int)value, (int)mask);
+        return false;
+    }
+    return add_range_listener(tf, 0, (TF_TYPE)~(TF_TYPE)0, mask, value, cb);
+}
+
+bool _TF_FN TF_RemoveTypeRangeListener(TinyFrame *tf, TF_TYPE lo, TF_TYPE hi)
+{
+    if (remove_range_listener(tf, lo, hi, 0, 0))
+        return true;
+
+    TF_Error("Range listener %d..%d to remove not found", (int)lo, (int)hi);
+    return false;
+}
+
+bool _TF_FN TF_RemoveTypeMaskListener(TinyFrame *tf, TF_TYPE mask, TF_TYPE value)
+{
+    if (remove_range_listener(tf, 0, (TF_TYPE)~(TF_TYPE)0, mask, value))
+        return true;
+
+    TF_Error("Mask listener %d/%d to remove not found", (int)value, (int)mask);
+    return false;
+}
+#endif
+
+#if TF_USE_STREAM_RX
+/** Clean up Stream listener - unlink it from the list and free the slot (once no callback runs it) */
+static void _TF_FN cleanup_stream_listener(TinyFrame *tf, TF_COUNT i, struct TF_StreamListener_ *lst)
+{
+    TF_COUNT *link;
+    if (tf->stream == lst)
+    {
+        // Removed while receiving - consume the rest of the frame, but do not store.
+        tf->stream = NULL;
+        tf->discard_data = true;
+    }
+
+    lst->fn_chunk = NULL; // Discard listener
+    lst->fn_end = NULL;
+    if (lst->pins != 0)
+        return; // the parser frees it when the callback returns
+
+    link = &tf->stream_head;
+    while (*link != i + 1)
+    {
+        link = &tf->stream_listeners[*link - 1].next;
+    }
+    *link = lst->next;
+    FREE_SLOT(tf, stream, i);
+}
+
+/** Add a new Stream listener. Returns 1 on success. */
+bool _TF_FN TF_AddStreamListener(TinyFrame *tf, TF_TYPE frame_type, TF_StreamChunk chunk_cb, TF_StreamEnd end_cb)
+{
+    TF_COUNT i;
+    TF_COUNT *link;
+    struct TF_StreamListener_ *lst;
+    if (!TAKE_SLOT(tf, stream, TF_MAX_STREAM_LST, i))
+    {
+        TF_Error("Failed to add stream listener");
+        return false;
+    }
+
+    lst = &tf->stream_listeners[i];
+    lst->fn_chunk = chunk_cb;
+    lst->fn_end = end_cb;
+    lst->type = frame_type;
+    lst->pins = 0;
+
+    // Append to the list, the first one added for a type gets the frame
+    link = &tf->stream_head;
+    while (*link != 0)
+    {
+        link = &tf->stream_listeners[*link - 1].next;
+    }
+    lst->next = 0;
+    *link = (TF_COUNT)(i + 1);
+    return true;
+}
+
+/** Remove a stream listener by its type. Returns 1 on success. */
+bool _TF_FN TF_RemoveStreamListener(TinyFrame *tf, TF_TYPE type)
+{
+    TF_COUNT n;
+    struct TF_StreamListener_ *lst;
+    for (n = tf->stream_head; n != 0; n = lst->next)
+    {
+        lst = &tf->stream_listeners[n - 1];
+        // test if live & matching
+        if (lst->fn_chunk != NULL && lst->type == type)
+        {
+            cleanup_stream_listener(tf, (TF_COUNT)(n - 1), lst);
+            return true;
+        }
+    }
+
+    TF_Error("Stream listener %d to remove not found", (int)type);
+    return false;
+}
+#endif
+
+#if TF_USE_BATCH
+/** Deliver the queued messages to the batch listener */
+static void _TF_FN batch_flush(TinyFrame *tf)
+{
+    uint32_t n = tf->batch_count;
+    if (n == 0)
+    {
+        return;
+    }
+
+    tf->batch_count = 0;
+    tf->batch_fill = 0;
+    tf->batch_fn(tf, tf->batch, n);
+}
+
+/** Queue a message for the batch listener */
+static void _TF_FN batch_push(TinyFrame *tf, TF_Msg *msg)
+{
+    // tf->data is reused by the next frame, a payload in the TF_Accept() buffer stays valid
+    // until the batch is flushed at the end of the call
+    bool copy = (msg->data == tf->data && msg->len > 0);
+
+    if (tf->batch_count == TF_MAX_BATCH || (copy && msg->len > TF_BATCH_DATA_LEN - tf->batch_fill))
+    {
+        batch_flush(tf);
+    }
+
+    if (copy)
+    {
+        if (msg->len > TF_BATCH_DATA_LEN)
+        {
+            // Too long for the copy buffer - deliver on its own
+            tf->batch_fn(tf, msg, 1);
+            return;
+        }
+        memcpy(tf->batch_data + tf->batch_fill, msg->data, msg->len);
+        msg->data = tf->batch_data + tf->batch_fill;
+        tf->batch_fill += msg->len;
+    }
+
+    tf->batch[tf->batch_count++] = *msg;
+}
+
+/** Set the batch listener (NULL = none) */
+void _TF_FN TF_SetBatchListener(TinyFrame *tf, TF_BatchListener cb)
+{
+    // Messages queued so far belong to the old listener
+    batch_flush(tf);
+    tf->batch_fn = cb;
+}
+#endif
+
+/** Run the listeners for a received message */
+static void _TF_FN dispatch_msg(TinyFrame *tf, TF_Msg *msg)
+{
+    TF_COUNT n, next;
+    struct TF_IdListener_ *ilst;
+    struct TF_TypeListener_ *tlst;
+    struct TF_GenericListener_ *glst;
+#if TF_USE_RANGE_LST
+    struct TF_RangeListener_ *rlst;
+#endif
+    TF_Listener fn;
+    TF_Result res;
+
+    // Any listener can consume the message, or let someone else handle it.
+
+    // ID listeners run inside the lock, they share userdata and timeouts with the other threads
+    LST_LOCK(tf);
+
+    // ID listeners first - only the bucket of this ID
+    for (n = tf->id_index[id_bucket(tf, msg->frame_id)]; n != 0; n = next)
+    {
+        ilst = &tf->id_listeners[n - 1];
+        next = ilst->next;
+
+        if (ilst->fn != NULL && ilst->id == msg->frame_id)
+        {
+            msg->userdata = ilst->userdata; // pass userdata pointer to the callback
+            msg->userdata2 = ilst->userdata2;
+            // pinned: if the callback removes this listener, the slot stays in the bucket until it returns
+            ilst->pins++;
+            res = ilst->fn(tf, msg);
+            ilst->pins--;
+            next = ilst->next; // the callback may have removed the listeners after it
+            ilst->userdata = msg->userdata;   // put it back (may have changed the pointer or set to NULL)
+            ilst->userdata2 = msg->userdata2; // put it back (may have changed the pointer or set to NULL)
+
+            if (res == TF_CLOSE)
+            {
+                // if it's TF_CLOSE, we assume user already cleaned up userdata
+                // Set userdata to NULL to avoid calling user for cleanup
+                ilst->userdata = NULL;
+                ilst->userdata2 = NULL;
+            }
+
+            if (res == TF_RENEW && ilst->fn != NULL)
+            {
+                renew_id_listener(tf, (TF_COUNT)(n - 1), ilst);
+            }
+            else if (res == TF_CLOSE || (ilst->fn == NULL && ilst->pins == 0))
+            {
+                cleanup_id_listener(tf, (TF_COUNT)(n - 1), ilst); // also frees it if the callback removed it
+            }
+
+            if (res != TF_NEXT)
+            {
+                LST_UNLOCK(tf);
+                return;
+            }
+        }
+    }
+    // clean up for the following listeners that don't use userdata (this avoids data from
+    // an ID listener that returned TF_NEXT from leaking into Type and Generic listeners)
+    msg->userdata = NULL;
+    msg->userdata2 = NULL;
+
+#if TF_USE_BATCH
+    if (tf->batch_fn != NULL)
+    {
+        batch_push(tf, msg);
+        LST_UNLOCK(tf);
+        return;
+    }
+#endif
+
+    // Type listeners - only the bucket of this type, in the order they were added
+    for (n = tf->type_index[type_bucket(tf, msg->type)]; n != 0; n = next)
+    {
+        tlst = &tf->type_listeners[n - 1];
+        next = tlst->next;
+
+        if (tlst->fn != NULL && tlst->type == msg->type)
+        {
+            // The listener itself runs unlocked, in parallel with other lanes. It is pinned meanwhile:
+            // if it gets removed (by itself or another thread), the slot stays linked and isn't reused.
+            fn = tlst->fn;
+            tlst->pins++;
+            LST_UNLOCK(tf);
+            res = fn(tf, msg);
+            LST_LOCK(tf);
+            tlst->pins--;
+            next = tlst->next; // the listeners after it may have changed
+
+            // type listeners don't have userdata.
+            // TF_RENEW doesn't make sense here because type listeners don't expire = same as TF_STAY
+            if (res == TF_CLOSE || (tlst->fn == NULL && tlst->pins == 0))
+            {
+                cleanup_type_listener(tf, (TF_COUNT)(n - 1), tlst); // also frees one removed meanwhile
+            }
+
+            if (res != TF_NEXT)
+            {
+                LST_UNLOCK(tf);
+                return;
+            }
+        }
+    }
+
+#if TF_USE_RANGE_LST
+    // Range / Mask listeners - the index gives the first one that may match, then in registration order
+    for (n = tf->range_index[(uint32_t)msg->type & 0xFFu]; n != 0; n = next)
+    {
+        rlst = &tf->range_listeners[n - 1];
+        next = rlst->next;
+
+        if (rlst->fn != NULL && range_match(rlst, msg->type))
+        {
+            fn = rlst->fn;
+            rlst->pins++;
+            LST_UNLOCK(tf);
+            res = fn(tf, msg);
+            LST_LOCK(tf);
+            rlst->pins--;
+            next = rlst->next;
+
+            if (res == TF_CLOSE || (rlst->fn == NULL && rlst->pins == 0))
+            {
+                cleanup_range_listener(tf, (TF_COUNT)(n - 1), rlst);
+            }
+
+            if (res != TF_NEXT)
+            {
+                LST_UNLOCK(tf);
+                return;
+            }
+        }
+    }
+#endif
+
+    // Generic listeners - only the live ones, in the order they were added
+    for (n = tf->generic_head; n != 0; n = next)
+    {
+        glst = &tf->generic_listeners[n - 1];
+        next = glst->next;
+
+        if (glst->fn)
+        {
+            fn = glst->fn;
+            glst->pins++;
+            LST_UNLOCK(tf);
+            res = fn(tf, msg);
+            LST_LOCK(tf);
+            glst->pins--;
+            next = glst->next;
+
+            // generic listeners don't have userdata.
+            // TF_RENEW doesn't make sense here because generic listeners don't expire = same as TF_STAY
+
+            // note: It's not expected that user will have multiple generic listeners, or
+            // ever actually remove them. They're most useful as default callbacks if no other listener
+            // handled the message.
+
+            if (res == TF_CLOSE || (glst->fn == NULL && glst->pins == 0))
+            {
+                cleanup_generic_listener(tf, (TF_COUNT)(n - 1), glst);
+            }
+
+            if (res != TF_NEXT)
+            {
+                LST_UNLOCK(tf);
+                return;
+            }
+        }
+    }
+
+    LST_UNLOCK(tf);
+    TF_Error("Unhandled message, type %d", (int)msg->type);
 }
 
-/** Remove a ID listener by its frame ID. Returns 1 on success. */
-bool _TF_FN TF_RemoveIdListener(TinyFrame *tf, TF_ID frame_id)
+#if TF_USE_DISPATCH_QUEUE
+/**
+ * Lane of a received message. Replies to our own queries carry our peer bit and go by frame ID,
+ * everything else by type, so frames of one type or replies to one query stay in order.
+ */
+static inline uint32_t _TF_FN dispatch_lane(TinyFrame *tf, const TF_Msg *msg)
 {
-    TF_COUNT i;
-    struct TF_IdListener_ *lst;
-    for (i = 0; i < tf->count_id_lst; i++)
+#if TF_DISPATCH_LANES > 1
+    uint32_t h;
+    if (((msg->frame_id & TF_ID_PEERBIT) != 0) == (tf->peer_bit != 0))
     {
-        lst = &tf->id_listeners[i];
-        // test if live & matching
-        if (lst->fn != NULL && lst->id == frame_id)
+        return (uint32_t)msg->frame_id & (TF_DISPATCH_LANES - 1); // sequential, the low bits spread them best
+    }
+    h = (uint32_t)msg->type;
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return h & (TF_DISPATCH_LANES - 1);
+#else
+    (void)tf;
+    (void)msg;
+    return 0;
+#endif
+}
+
+/** Copy a message into its dispatch lane - runs in the parser, the only writer of the head positions */
+static void _TF_FN dispatch_push(TinyFrame *tf, const TF_Msg *msg)
+{
+    struct TF_DispatchLane_ *lane = &tf->dispatch[dispatch_lane(tf, msg)];
+    uint32_t head = lane->head;
+    uint32_t pos = lane->data_head;
+    uint32_t off = pos & (TF_DISPATCH_DATA_LEN - 1);
+    TF_Msg *qmsg;
+
+    // The payload must be contiguous - if it doesn't fit before the end of the ring, skip to its start
+    if (msg->len > TF_DISPATCH_DATA_LEN - off)
+    {
+        pos += TF_DISPATCH_DATA_LEN - off;
+        off = 0;
+    }
+
+    if (head - TF_QUEUE_LOAD(&lane->tail) == TF_DISPATCH_SLOTS ||
+        (uint32_t)(pos - TF_QUEUE_LOAD(&lane->data_tail)) + msg->len > TF_DISPATCH_DATA_LEN)
+    {
+        tf->dispatch_dropped++;
+        TF_Error("Dispatch queue full, frame type %d dropped", (int)msg->type);
+        return;
+    }
+
+    memcpy(lane->data + off, msg->data, msg->len);
+    qmsg = &lane->msg[head & (TF_DISPATCH_SLOTS - 1)];
+    *qmsg = *msg;
+    qmsg->data = lane->data + off;
+    lane->end[head & (TF_DISPATCH_SLOTS - 1)] = pos + msg->len;
+    lane->data_head = pos + msg->len;
+
+    // Publish the frame only after its contents are written
+    TF_QUEUE_STORE(&lane->head, head + 1);
+}
+
+/** Run the listeners for the frames queued in a lane - the caller holds the lane, the only writer of its tail positions */
+static uint32_t _TF_FN dispatch_drain(TinyFrame *tf, struct TF_DispatchLane_ *lane, uint32_t max)
+{
+    uint32_t tail = lane->tail;
+    uint32_t head = TF_QUEUE_LOAD(&lane->head);
+    uint32_t n = 0;
+    TF_Msg msg;
+
+    while (max == 0 || n < max)
+    {
+        if (tail == head)
         {
-            cleanup_id_listener(tf, i, lst);
-            return true;
+            // Take the frames queued while this ran too
+            head = TF_QUEUE_LOAD(&lane->head);
+            if (tail == head)
+                break;
+        }
+
+        msg = lane->msg[tail & (TF_DISPATCH_SLOTS - 1)];
+        dispatch_msg(tf, &msg);
+
+        // Give the slot and its payload back to the parser
+        TF_QUEUE_STORE(&lane->data_tail, lane->end[tail & (TF_DISPATCH_SLOTS - 1)]);
+        tail++;
+        TF_QUEUE_STORE(&lane->tail, tail);
+        n++;
+    }
+
+    return n;
+}
+
+/** Run the listeners for queued frames, one lane at a time */
+uint32_t _TF_FN TF_Dispatch(TinyFrame *tf, uint32_t max)
+{
+#if TF_DISPATCH_LANES > 1
+    struct TF_DispatchLane_ *lane;
+    uint32_t start, k, n = 0;
+
+    // Start each call at the next lane so the workers spread over the lanes. Two calls may
+    // occasionally read the same start, the lane claim below sorts that out.
+    start = TF_QUEUE_LOAD(&tf->dispatch_next);
+    TF_QUEUE_STORE(&tf->dispatch_next, start + 1);
+
+    for (k = 0; k < TF_DISPATCH_LANES && (max == 0 || n < max); k++)
+    {
+        lane = &tf->dispatch[(start + k) & (TF_DISPATCH_LANES - 1)];
+
+        // A lane is drained by one worker at a time, whole lanes move between workers
+        // and frames within a lane keep their order. A worker that finds the lane taken
+        // skips it, so the one holding it looks again after letting go: both flag updates
+        // are exchanges, so it sees every frame the skipping worker saw.
+        while (TF_QUEUE_LOAD(&lane->tail) != TF_QUEUE_LOAD(&lane->head) && (max == 0 || n < max) &&
+               TF_QUEUE_SWAP(&lane->busy, 1u) == 0)
+        {
+            n += dispatch_drain(tf, lane, max == 0 ? 0 : max - n);
+            (void)TF_QUEUE_SWAP(&lane->busy, 0u);
         }
     }
 
-    TF_Error("ID listener %d to remove not found", (int)frame_id);
+    return n;
+#else
+    return dispatch_drain(tf, &tf->dispatch[0], max);
+#endif
+}
+#endif
+
+/** Handle a message that was just collected & verified by the parser */
+static void _TF_FN TF_HandleReceivedMessage(TinyFrame *tf)
+{
+    // Prepare message object
+    TF_Msg msg;
+    TF_ClearMsg(&msg);
+    msg.frame_id = tf->id;
+    msg.is_response = false;
+    msg.type = tf->type;
+#if TF_USE_ZERO_COPY_RX
+    msg.data = tf->payload;
+#else
+    msg.data = tf->data;
+#endif
+    msg.len = tf->len;
+
+#if TF_USE_DISPATCH_QUEUE
+    dispatch_push(tf, &msg);
+#else
+    dispatch_msg(tf, &msg);
+#endif
+}
+
+/** Externally renew an ID listener */
+bool _TF_FN TF_RenewIdListener(TinyFrame *tf, TF_ID id)
+{
+    struct TF_IdListener_ *lst;
+
+    LST_LOCK(tf);
+    lst = find_id_listener(tf, id);
+    if (lst != NULL)
+    {
+        renew_id_listener(tf, (TF_COUNT)(lst - tf->id_listeners), lst);
+        LST_UNLOCK(tf);
+        return true;
+    }
+
+    TF_Error("Renew listener: not found (id %d)", (int)id);
+    LST_UNLOCK(tf);
     return false;
 }
 
-/** Remove a type listener by its type. Returns 1 on success. */
-bool _TF_FN TF_RemoveTypeListener(TinyFrame *tf, TF_TYPE type)
+// endregion Listeners
+
+// region Parser
+
+#if TF_USE_STREAM_RX
+/** Prepare the message object passed to stream listener callbacks */
+static inline void _TF_FN pars_stream_msg(TinyFrame *tf, TF_Msg *msg)
 {
-    TF_COUNT i;
-    struct TF_TypeListener_ *lst;
-    for (i = 0; i < tf->count_type_lst; i++)
+    TF_ClearMsg(msg);
+    msg->frame_id = tf->id;
+    msg->type = tf->type;
+    msg->len = tf->len; // total payload length, the chunks are passed separately
+}
+
+/** Pass payload bytes to the active stream listener */
+static void _TF_FN pars_stream_chunk(TinyFrame *tf, const uint8_t *chunk, uint32_t len, uint32_t offset)
+{
+    TF_Msg msg;
+    struct TF_StreamListener_ *lst = tf->stream;
+
+    pars_stream_msg(tf, &msg);
+    lst->pins++; // the callback may remove the listener, the slot is freed below
+    lst->fn_chunk(tf, &msg, offset, chunk, len);
+    lst->pins--;
+    if (lst->fn_chunk == NULL && lst->pins == 0)
+    {
+        cleanup_stream_listener(tf, (TF_COUNT)(lst - tf->stream_listeners), lst);
+    }
+}
+
+/** Pass the bytes staged in tf->data (by pars_accept_char) to the active stream listener */
+static void _TF_FN pars_stream_flush(TinyFrame *tf)
+{
+    TF_LEN fill = tf->stream_fill;
+    if (fill > 0)
+    {
+        tf->stream_fill = 0;
+        pars_stream_chunk(tf, tf->data, fill, (uint32_t)(tf->rxi - fill));
+    }
+}
+
+/** Finish the streamed frame and notify the listener */
+static void _TF_FN pars_stream_end(TinyFrame *tf, bool cksum_ok)
+{
+    TF_Msg msg;
+    TF_Result res;
+    struct TF_StreamListener_ *lst = tf->stream;
+
+    tf->stream = NULL;
+    pars_stream_msg(tf, &msg);
+    // the callback may remove the listener (and add a new one), the slot is not reused until it returns
+    lst->pins++;
+    res = lst->fn_end(tf, &msg, cksum_ok);
+    lst->pins--;
+    if (res == TF_CLOSE || (lst->fn_end == NULL && lst->pins == 0))
+    {
+        cleanup_stream_listener(tf, (TF_COUNT)(lst - tf->stream_listeners), lst);
+    }
+}
+
+/** Find a stream listener for the frame in the parser (the payload is too long for tf->data) */
+static void _TF_FN pars_stream_begin(TinyFrame *tf)
+{
+    TF_COUNT n;
+    struct TF_StreamListener_ *lst;
+    for (n = tf->stream_head; n != 0; n = lst->next)
+    {
+        lst = &tf->stream_listeners[n - 1];
+        if (lst->fn_chunk != NULL && lst->type == tf->type)
+        {
+            tf->stream = lst;
+            tf->stream_fill = 0;
+            return;
+        }
+    }
+}
+#endif
+
+/** Reset the parser's internal state. */
+void _TF_FN TF_ResetParser(TinyFrame *tf)
+{
+#if TF_USE_STREAM_RX
+    if (tf->stream != NULL)
+    {
+        // Frame abandoned before it was complete
+        pars_stream_end(tf, false);
+    }
+#endif
+    tf->state = TFState_SOF;
+    // more init will be done by the parser when the first byte is received
+}
+
+/** SOF was received - prepare for the frame */
+static void _TF_FN pars_begin_frame(TinyFrame *tf)
+{
+    // Reset state vars
+    CKSUM_RESET(tf->cksum);
+#if TF_USE_SOF_BYTE
+    CKSUM_ADD(tf->cksum, TF_SOF_BYTE);
+#endif
+
+    tf->discard_data = false;
+#if TF_LOOKBACK
+    tf->lookback_len = 0;
+#endif
+
+    // Enter ID state
+    tf->state = TFState_ID;
+    tf->rxi = 0;
+}
+
+/** The header was received and verified - prepare for the payload */
+static void _TF_FN pars_head_done(TinyFrame *tf)
+{
+#if TF_USE_ZERO_COPY_RX
+    tf->payload = tf->data;
+#endif
+
+    if (tf->len == 0)
+    {
+        // if the message has no body, we're done.
+        TF_HandleReceivedMessage(tf);
+        TF_ResetParser(tf);
+        return;
+    }
+
+    // Enter DATA state
+    tf->state = TFState_DATA;
+    tf->rxi = 0;
+
+    CKSUM_RESET(tf->cksum); // Start collecting the payload
+
+    if (tf->len > TF_RX_CAP(tf))
+    {
+#if TF_USE_STREAM_RX
+        // A stream listener takes the payload in chunks
+        pars_stream_begin(tf);
+        if (tf->stream != NULL)
+        {
+            return;
+        }
+#endif
+        TF_Error("Rx payload too long: %d", (int)tf->len);
+        // ERROR - frame too long. Consume, but do not store.
+        tf->discard_data = true;
+    }
+}
+
+/** Read a big-endian number of 1, 2 or 4 bytes */
+static inline uint32_t _TF_FN pars_read_num(const uint8_t *p, uint32_t size)
+{
+    switch (size)
+    {
+    case 1:
+        return p[0];
+    case 2:
+        return ((uint32_t)p[0] << 8) | p[1];
+    default:
+        return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    }
+}
+
+/**
+ * Decode the whole header in one step (used by TF_Accept when TF_HEAD_BYTES are available
+ * right after the SOF). Does the same as the ID, LEN, TYPE and HEAD_CKSUM states.
+ *
+ * @param tf - instance
+ * @param buffer - received bytes, starting with the frame ID
+ * @return nr of bytes consumed
+ */
+static uint32_t _TF_FN pars_collect_head(TinyFrame *tf, const uint8_t *buffer)
+{
+    const uint8_t *p = buffer;
+
+    tf->id = (TF_ID)pars_read_num(p, sizeof(TF_ID));
+    p += sizeof(TF_ID);
+    tf->len = (TF_LEN)pars_read_num(p, sizeof(TF_LEN));
+    p += sizeof(TF_LEN);
+    tf->type = (TF_TYPE)pars_read_num(p, sizeof(TF_TYPE));
+    p += sizeof(TF_TYPE);
+
+    CKSUM_ADD_BLOCK(tf->cksum, buffer, (uint32_t)(p - buffer));
+
+#if TF_CKSUM_TYPE != TF_CKSUM_NONE
+    tf->ref_cksum = (TF_CKSUM)pars_read_num(p, sizeof(TF_CKSUM));
+
+    // Check the header checksum against the computed value
+    CKSUM_FINALIZE(tf->cksum);
+
+    if (tf->cksum != tf->ref_cksum)
+    {
+        TF_Error("Rx head cksum mismatch");
+        TF_ResetParser(tf);
+#if TF_LOOKBACK
+        // A real frame may start inside the header, continue right after its first byte
+        // (or its SOF)
+        return TF_USE_SOF_BYTE ? 0 : 1;
+#else
+        return TF_HEAD_BYTES;
+#endif
+    }
+#endif
+
+    pars_head_done(tf);
+    return TF_HEAD_BYTES;
+}
+
+/** All payload bytes were received - verify the checksum or finish the frame */
+static void _TF_FN pars_data_done(TinyFrame *tf)
+{
+#if TF_CKSUM_TYPE == TF_CKSUM_NONE
+    // All done
+#if TF_USE_STREAM_RX
+    if (tf->stream != NULL)
+    {
+        pars_stream_end(tf, true);
+    }
+    else
+#endif
+    if (!tf->discard_data)
+    {
+        TF_HandleReceivedMessage(tf);
+    }
+    TF_ResetParser(tf);
+#else
+    // Enter DATA_CKSUM state
+    tf->state = TFState_DATA_CKSUM;
+    tf->rxi = 0;
+    tf->ref_cksum = 0;
+#endif
+}
+
+/**
+ * Collect payload bytes in bulk (used by TF_Accept in the DATA state)
+ *
+ * @param tf - instance
+ * @param buffer - received bytes, starting with the next payload byte
+ * @param count - nr of bytes in the buffer
+ * @return nr of bytes consumed
+ */
+static uint32_t _TF_FN pars_collect_data(TinyFrame *tf, const uint8_t *buffer, uint32_t count)
+{
+    uint32_t n = TF_MIN((uint32_t)(tf->len - tf->rxi), count);
+
+    if (tf->discard_data)
+    {
+        // skip
+    }
+#if TF_USE_STREAM_RX
+    else if (tf->stream != NULL)
+    {
+        // Bytes staged by pars_accept_char go first, the rest is passed straight from the caller's buffer
+        pars_stream_flush(tf);
+        CKSUM_ADD_BLOCK(tf->cksum, buffer, n);
+        // The chunk callback may have removed the listener - the rest is then discarded
+        if (tf->stream != NULL)
+        {
+            pars_stream_chunk(tf, buffer, n, tf->rxi);
+        }
+    }
+#endif
+    else
     {
-        lst = &tf->type_listeners[i];
-        // test if live & matching
-        if (lst->fn != NULL && lst->type == type)
+#if TF_USE_ZERO_COPY_RX
+        // If the payload and its checksum are all here, they stay in the caller's buffer
+        // until the frame is handled - the listener can read the payload from there.
+        if (tf->rxi == 0 && n == tf->len && n + TF_CKSUM_BYTES <= count)
         {
-            cleanup_type_listener(tf, i, lst);
-            return true;
+            tf->payload = buffer;
+        }
+        else
+#endif
+        {
+            memcpy(tf->data + tf->rxi, buffer, n);
         }
+        CKSUM_ADD_BLOCK(tf->cksum, buffer, n);
     }
+    tf->rxi = (TF_LEN)(tf->rxi + n);
 
-    TF_Error("Type listener %d to remove not found", (int)type);
-    return false;
+    if (tf->rxi == tf->len)
+    {
+        pars_data_done(tf);
+    }
+    return n;
 }
 
-/** Remove a generic listener by its function pointer. Returns 1 on success. */
-bool _TF_FN TF_RemoveGenericListener(TinyFrame *tf, TF_Listener cb)
+static void _TF_FN pars_accept_char(TinyFrame *tf, unsigned char c);
+
+#if TF_USE_CLOCK
+/** Reset the parser if too much time passed since the previous received bytes */
+static void _TF_FN pars_check_timeout(TinyFrame *tf)
 {
-    TF_COUNT i;
-    struct TF_GenericListener_ *lst;
-    for (i = 0; i < tf->count_generic_lst; i++)
+    TF_TICKS now = TF_GetTime(tf);
+    if (tf->state != TFState_SOF && (TF_TICKS)(now - tf->parser_timeout_ticks) >= TF_PARSER_TIMEOUT_TICKS)
     {
-        lst = &tf->generic_listeners[i];
-        // test if live & matching
-        if (lst->fn == cb)
-        {
-            cleanup_generic_listener(tf, i, lst);
-            return true;
-        }
+        TF_ResetParser(tf);
+        TF_Error("Parser timeout");
     }
-
-    TF_Error("Generic listener to remove not found");
-    return false;
+    tf->parser_timeout_ticks = now;
 }
+#endif
 
-/** Handle a message that was just collected & verified by the parser */
-static void _TF_FN TF_HandleReceivedMessage(TinyFrame *tf)
+/** Handle a received byte buffer */
+void _TF_FN TF_Accept(TinyFrame *tf, const uint8_t *buffer, uint32_t count)
 {
-    TF_COUNT i;
-    struct TF_IdListener_ *ilst;
-    struct TF_TypeListener_ *tlst;
-    struct TF_GenericListener_ *glst;
-    TF_Result res;
-
-    // Prepare message object
-    TF_Msg msg;
-    TF_ClearMsg(&msg);
-    msg.frame_id = tf->id;
-    msg.is_response = false;
-    msg.type = tf->type;
-    msg.data = tf->data;
-    msg.len = tf->len;
-
-    // Any listener can consume the message, or let someone else handle it.
+    uint32_t i = 0;
+#if TF_USE_SOF_BYTE
+    const uint8_t *sof;
+#endif
 
-    // The loop upper bounds are the highest currently used slot index
-    // (or close to it, depending on the order of listener removals).
+#if TF_USE_CLOCK
+    pars_check_timeout(tf);
+#endif
 
-    // ID listeners first
-    for (i = 0; i < tf->count_id_lst; i++)
+    while (i < count)
     {
-        ilst = &tf->id_listeners[i];
-
-        if (ilst->fn && ilst->id == msg.frame_id)
+#if TF_USE_SOF_BYTE
+        if (tf->state == TFState_SOF)
         {
-            msg.userdata = ilst->userdata; // pass userdata pointer to the callback
-            msg.userdata2 = ilst->userdata2;
-            res = ilst->fn(tf, &msg);
-            ilst->userdata = msg.userdata;   // put it back (may have changed the pointer or set to NULL)
-            ilst->userdata2 = msg.userdata2; // put it back (may have changed the pointer or set to NULL)
-
-            if (res != TF_NEXT)
+            // Skip everything up to the next SOF candidate in one step (noise, a broken frame,
+            // traffic of another protocol). memchr() is vectorized by most C libraries.
+            PARS_TOUCH(tf);
+            sof = memchr(buffer + i, TF_SOF_BYTE, count - i);
+            if (sof == NULL)
             {
-                // if it's TF_CLOSE, we assume user already cleaned up userdata
-                if (res == TF_RENEW)
-                {
-                    renew_id_listener(ilst);
-                }
-                else if (res == TF_CLOSE)
-                {
-                    // Set userdata to NULL to avoid calling user for cleanup
-                    ilst->userdata = NULL;
-                    ilst->userdata2 = NULL;
-                    cleanup_id_listener(tf, i, ilst);
-                }
-                return;
+                break;
             }
+            i = (uint32_t)(sof - buffer) + 1;
+            pars_begin_frame(tf);
+            continue;
         }
-    }
-    // clean up for the following listeners that don't use userdata (this avoids data from
-    // an ID listener that returned TF_NEXT from leaking into Type and Generic listeners)
-    msg.userdata = NULL;
-    msg.userdata2 = NULL;
-
-    // Type listeners
-    for (i = 0; i < tf->count_type_lst; i++)
-    {
-        tlst = &tf->type_listeners[i];
+#endif
 
-        if (tlst->fn && tlst->type == msg.type)
+#if !TF_USE_SOF_BYTE
+        if (tf->state == TFState_SOF)
         {
-            res = tlst->fn(tf, &msg);
-
-            if (res != TF_NEXT)
-            {
-                // type listeners don't have userdata.
-                // TF_RENEW doesn't make sense here because type listeners don't expire = same as TF_STAY
-
-                if (res == TF_CLOSE)
-                {
-                    cleanup_type_listener(tf, i, tlst);
-                }
-                return;
-            }
+            PARS_TOUCH(tf);
+            pars_begin_frame(tf);
         }
-    }
-
-    // Generic listeners
-    for (i = 0; i < tf->count_generic_lst; i++)
-    {
-        glst = &tf->generic_listeners[i];
+#endif
 
-        if (glst->fn)
+        // A complete header and the payload are consumed in one step, the rest (buffer edges)
+        // goes through the state machine. A timed out parser is left to pars_accept_char(),
+        // which resets it.
+        if (!PARS_TIMED_OUT(tf))
         {
-            res = glst->fn(tf, &msg);
-
-            if (res != TF_NEXT)
+            if (tf->state == TFState_ID && tf->rxi == 0 && count - i >= TF_HEAD_BYTES)
             {
-                // generic listeners don't have userdata.
-                // TF_RENEW doesn't make sense here because generic listeners don't expire = same as TF_STAY
-
-                // note: It's not expected that user will have multiple generic listeners, or
-                // ever actually remove them. They're most useful as default callbacks if no other listener
-                // handled the message.
+                PARS_TOUCH(tf);
+                i += pars_collect_head(tf, buffer + i);
+                continue;
+            }
 
-                if (res == TF_CLOSE)
-                {
-                    cleanup_generic_listener(tf, i, glst);
-                }
-                return;
+            if (tf->state == TFState_DATA)
+            {
+                PARS_TOUCH(tf);
+                i += pars_collect_data(tf, buffer + i, count - i);
+                continue;
             }
         }
+
+        pars_accept_char(tf, buffer[i++]);
     }
 
-    TF_Error("Unhandled message, type %d", (int)msg.type);
+#if TF_USE_BATCH
+    batch_flush(tf);
+#endif
 }
 
-/** Externally renew an ID listener */
-bool _TF_FN TF_RenewIdListener(TinyFrame *tf, TF_ID id)
+/** Handle a received char */
+void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
 {
-    TF_COUNT i;
-    struct TF_IdListener_ *lst;
-    for (i = 0; i < tf->count_id_lst; i++)
-    {
-        lst = &tf->id_listeners[i];
-        // test if live & matching
-        if (lst->fn != NULL && lst->id == id)
-        {
-            renew_id_listener(lst);
-            return true;
-        }
-    }
+#if TF_USE_CLOCK
+    pars_check_timeout(tf);
+#endif
+    pars_accept_char(tf, c);
 
-    TF_Error("Renew listener: not found (id %d)", (int)id);
-    return false;
+#if TF_USE_BATCH
+    batch_flush(tf);
+#endif
 }
 
-// endregion Listeners
+#if TF_LOOKBACK
+/** Header checksum failed - rescan the header bytes, a real frame may start inside them */
+static void _TF_FN pars_resync(TinyFrame *tf)
+{
+    uint8_t buf[sizeof(tf->lookback)];
+    uint8_t n = tf->lookback_len;
+    uint8_t k;
 
-// region Parser
+    memcpy(buf, tf->lookback, n);
+    TF_ResetParser(tf);
 
-/** Handle a received byte buffer */
-void _TF_FN TF_Accept(TinyFrame *tf, const uint8_t *buffer, uint32_t count)
-{
-    uint32_t i;
-    for (i = 0; i < count; i++)
+    // The replayed bytes are fewer than a header, so this can't fail again recursively.
+    // Without SOF, the next frame is tried from the second byte.
+    for (k = TF_USE_SOF_BYTE ? 0 : 1; k < n; k++)
     {
-        TF_AcceptChar(tf, buffer[i]);
+        pars_accept_char(tf, buf[k]);
     }
 }
-
-/** Reset the parser's internal state. */
-void _TF_FN TF_ResetParser(TinyFrame *tf)
-{
-    tf->state = TFState_SOF;
-    // more init will be done by the parser when the first byte is received
-}
-
-/** SOF was received - prepare for the frame */
-static void _TF_FN pars_begin_frame(TinyFrame *tf)
-{
-    // Reset state vars
-    CKSUM_RESET(tf->cksum);
-#if TF_USE_SOF_BYTE
-    CKSUM_ADD(tf->cksum, TF_SOF_BYTE);
 #endif
 
-    tf->discard_data = false;
-
-    // Enter ID state
-    tf->state = TFState_ID;
-    tf->rxi = 0;
-}
-
-/** Handle a received char - here's the main state machine */
-void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
+/** Parse one byte - here's the main state machine */
+static void _TF_FN pars_accept_char(TinyFrame *tf, unsigned char c)
 {
     // Parser timeout - clear
-    if (tf->parser_timeout_ticks >= TF_PARSER_TIMEOUT_TICKS)
+    if (PARS_TIMED_OUT(tf))
     {
         if (tf->state != TFState_SOF)
         {
@@ -686,7 +3295,7 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
             TF_Error("Parser timeout");
         }
     }
-    tf->parser_timeout_ticks = 0;
+    PARS_TOUCH(tf);
 
 // DRY snippet - collect multi-byte number from the input stream, byte by byte
 // This is a little dirty, but makes the code easier to read. It's used like e.g. if(),
@@ -703,6 +3312,14 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
     }
 #endif
 
+#if TF_LOOKBACK
+    if (tf->state == TFState_ID || tf->state == TFState_LEN || tf->state == TFState_TYPE ||
+        tf->state == TFState_HEAD_CKSUM)
+    {
+        tf->lookback[tf->lookback_len++] = c;
+    }
+#endif
+
     //@formatter:off
     switch (tf->state)
     {
@@ -738,8 +3355,7 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
         COLLECT_NUMBER(tf->type, TF_TYPE)
         {
 #if TF_CKSUM_TYPE == TF_CKSUM_NONE
-            tf->state = TFState_DATA;
-            tf->rxi = 0;
+            pars_head_done(tf);
 #else
             // enter HEAD_CKSUM state
             tf->state = TFState_HEAD_CKSUM;
@@ -758,30 +3374,15 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
             if (tf->cksum != tf->ref_cksum)
             {
                 TF_Error("Rx head cksum mismatch");
+#if TF_LOOKBACK
+                pars_resync(tf);
+#else
                 TF_ResetParser(tf);
+#endif
                 break;
             }
 
-            if (tf->len == 0)
-            {
-                // if the message has no body, we're done.
-                TF_HandleReceivedMessage(tf);
-                TF_ResetParser(tf);
-                break;
-            }
-
-            // Enter DATA state
-            tf->state = TFState_DATA;
-            tf->rxi = 0;
-
-            CKSUM_RESET(tf->cksum); // Start collecting the payload
-
-            if (tf->len > TF_MAX_PAYLOAD_RX)
-            {
-                TF_Error("Rx payload too long: %d", (int)tf->len);
-                // ERROR - frame too long. Consume, but do not store.
-                tf->discard_data = true;
-            }
+            pars_head_done(tf);
         }
         break;
 
@@ -790,6 +3391,20 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
         {
             tf->rxi++;
         }
+#if TF_USE_STREAM_RX
+        else if (tf->stream != NULL)
+        {
+            // Stage the bytes in tf->data, pass them on when it's full or the payload is complete
+            CKSUM_ADD(tf->cksum, c);
+            tf->data[tf->stream_fill++] = c;
+            tf->rxi++;
+
+            if (tf->stream_fill == TF_RX_CAP(tf) || tf->rxi == tf->len)
+            {
+                pars_stream_flush(tf);
+            }
+        }
+#endif
         else
         {
             CKSUM_ADD(tf->cksum, c);
@@ -798,16 +3413,7 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
 
         if (tf->rxi == tf->len)
         {
-#if TF_CKSUM_TYPE == TF_CKSUM_NONE
-            // All done
-            TF_HandleReceivedMessage(tf);
-            TF_ResetParser(tf);
-#else
-            // Enter DATA_CKSUM state
-            tf->state = TFState_DATA_CKSUM;
-            tf->rxi = 0;
-            tf->ref_cksum = 0;
-#endif
+            pars_data_done(tf);
         }
         break;
 
@@ -816,6 +3422,13 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
         {
             // Check the header checksum against the computed value
             CKSUM_FINALIZE(tf->cksum);
+#if TF_USE_STREAM_RX
+            if (tf->stream != NULL)
+            {
+                pars_stream_end(tf, tf->cksum == tf->ref_cksum);
+            }
+            else
+#endif
             if (!tf->discard_data)
             {
                 if (tf->cksum == tf->ref_cksum)
@@ -870,14 +3483,6 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
  */
 #define WRITENUM(type, num) WRITENUM_BASE(type, num, _NOOP())
 
-/**
- * Write a number AND add its bytes to the checksum
- *
- * @param type - data type
- * @param num - number to write
- */
-#define WRITENUM_CKSUM(type, num) WRITENUM_BASE(type, num, CKSUM_ADD(cksum, b))
-
 /**
  * Compose a frame (used internally by TF_Send and TF_Respond).
  * The frame can be sent using TF_WriteImpl(), or received by TF_Accept()
@@ -919,14 +3524,14 @@ static inline uint32_t _TF_FN TF_ComposeHead(TinyFrame *tf, uint8_t *outbuff, TF
 
 #if TF_USE_SOF_BYTE
     outbuff[pos++] = TF_SOF_BYTE;
-    CKSUM_ADD(cksum, TF_SOF_BYTE);
 #endif
 
-    WRITENUM_CKSUM(TF_ID, id);
-    WRITENUM_CKSUM(TF_LEN, msg->len);
-    WRITENUM_CKSUM(TF_TYPE, msg->type);
+    WRITENUM(TF_ID, id);
+    WRITENUM(TF_LEN, msg->len);
+    WRITENUM(TF_TYPE, msg->type);
 
 #if TF_CKSUM_TYPE != TF_CKSUM_NONE
+    CKSUM_ADD_BLOCK(cksum, outbuff, pos);
     CKSUM_FINALIZE(cksum);
     WRITENUM(TF_CKSUM, cksum);
 #endif
@@ -942,42 +3547,39 @@ static inline uint32_t _TF_FN TF_ComposeHead(TinyFrame *tf, uint8_t *outbuff, TF
  * @param data - data buffer
  * @param data_len - data buffer len
  * @param cksum - checksum variable, used for all calls to TF_ComposeBody. Must be reset before first use! (CKSUM_RESET(cksum);)
+ *                NULL to copy the data without checksumming it
  * @return nr of bytes in outbuff used
  */
 static inline uint32_t _TF_FN TF_ComposeBody(uint8_t *outbuff,
                                              const uint8_t *data, TF_LEN data_len,
                                              TF_CKSUM *cksum)
 {
-    TF_LEN i = 0;
-    uint8_t b = 0;
-    uint32_t pos = 0;
-
-    for (i = 0; i < data_len; i++)
+    memcpy(outbuff, data, data_len);
+    if (cksum)
     {
-        b = data[i];
-        outbuff[pos++] = b;
-        CKSUM_ADD(*cksum, b);
+        CKSUM_ADD_BLOCK(*cksum, data, data_len);
     }
 
-    return pos;
+    return data_len;
 }
 
 /**
  * Finalize a frame
  *
  * @param outbuff - buffer to store the result in
- * @param cksum - checksum variable used for the body
+ * @param cksum - finalized checksum of the body
  * @return nr of bytes in outbuff used
  */
-static inline uint32_t _TF_FN TF_ComposeTail(uint8_t *outbuff, TF_CKSUM *cksum)
+static inline uint32_t _TF_FN TF_ComposeTail(uint8_t *outbuff, TF_CKSUM cksum)
 {
     int8_t si = 0; // signed small int
     uint8_t b = 0;
     uint32_t pos = 0;
 
 #if TF_CKSUM_TYPE != TF_CKSUM_NONE
-    CKSUM_FINALIZE(*cksum);
-    WRITENUM(TF_CKSUM, *cksum);
+    WRITENUM(TF_CKSUM, cksum);
+#else
+    (void)cksum;
 #endif
     return pos;
 }
@@ -994,14 +3596,30 @@ static inline uint32_t _TF_FN TF_ComposeTail(uint8_t *outbuff, TF_CKSUM *cksum)
  */
 static bool _TF_FN TF_SendFrame_Begin(TinyFrame *tf, TF_Msg *msg, TF_Listener listener, TF_Listener_Timeout ftimeout, TF_TICKS timeout)
 {
-    TF_TRY(TF_ClaimTx(tf));
+    bool ok;
+
+    // The listener tables are locked before Tx, in the same order as an ID listener that sends a frame
+    if (listener)
+    {
+        LST_LOCK(tf);
+    }
+    if (!TF_ClaimTx(tf))
+    {
+        if (listener)
+        {
+            LST_UNLOCK(tf);
+        }
+        return false;
+    }
 
     tf->tx_pos = (uint32_t)TF_ComposeHead(tf, tf->sendbuf, msg); // frame ID is incremented here if it's not a response
     tf->tx_len = msg->len;
 
     if (listener)
     {
-        if (!TF_AddIdListener(tf, msg, listener, ftimeout, timeout))
+        ok = TF_AddIdListener(tf, msg, listener, ftimeout, timeout);
+        LST_UNLOCK(tf);
+        if (!ok)
         {
             TF_ReleaseTx(tf);
             return false;
@@ -1019,8 +3637,9 @@ static bool _TF_FN TF_SendFrame_Begin(TinyFrame *tf, TF_Msg *msg, TF_Listener li
  * @param tf - instance
  * @param buff - bytes to write
  * @param length - count
+ * @param add_cksum - add the bytes to tf->tx_cksum
  */
-static void _TF_FN TF_SendFrame_Chunk(TinyFrame *tf, const uint8_t *buff, uint32_t length)
+static void _TF_FN TF_SendFrame_Chunk(TinyFrame *tf, const uint8_t *buff, uint32_t length, bool add_cksum)
 {
     uint32_t remain;
     uint32_t chunk;
@@ -1030,13 +3649,14 @@ static void _TF_FN TF_SendFrame_Chunk(TinyFrame *tf, const uint8_t *buff, uint32
     while (remain > 0)
     {
         // Write what can fit in the tx buffer
-        chunk = TF_MIN(TF_SENDBUF_LEN - tf->tx_pos, remain);
-        tf->tx_pos += TF_ComposeBody(tf->sendbuf + tf->tx_pos, buff + sent, (TF_LEN)chunk, &tf->tx_cksum);
+        chunk = TF_MIN(TF_TX_CAP(tf) - tf->tx_pos, remain);
+        tf->tx_pos += TF_ComposeBody(tf->sendbuf + tf->tx_pos, buff + sent, (TF_LEN)chunk,
+                                     add_cksum ? &tf->tx_cksum : NULL);
         remain -= chunk;
         sent += chunk;
 
         // Flush if the buffer is full
-        if (tf->tx_pos == TF_SENDBUF_LEN)
+        if (tf->tx_pos == TF_TX_CAP(tf))
         {
             TF_WriteImpl(tf, (const uint8_t *)tf->sendbuf, tf->tx_pos);
             tf->tx_pos = 0;
@@ -1048,21 +3668,27 @@ static void _TF_FN TF_SendFrame_Chunk(TinyFrame *tf, const uint8_t *buff, uint32
  * End a multi-part frame. This sends the checksum and releases mutex.
  *
  * @param tf - instance
+ * @param cksum - finalized body checksum to send, NULL to use tf->tx_cksum
  */
-static void _TF_FN TF_SendFrame_End(TinyFrame *tf)
+static void _TF_FN TF_SendFrame_End(TinyFrame *tf, const TF_CKSUM *cksum)
 {
     // Checksum only if message had a body
     if (tf->tx_len > 0)
     {
         // Flush if checksum wouldn't fit in the buffer
-        if (TF_SENDBUF_LEN - tf->tx_pos < sizeof(TF_CKSUM))
+        if (TF_TX_CAP(tf) - tf->tx_pos < sizeof(TF_CKSUM))
         {
             TF_WriteImpl(tf, (const uint8_t *)tf->sendbuf, tf->tx_pos);
             tf->tx_pos = 0;
         }
 
         // Add checksum, flush what remains to be sent
-        tf->tx_pos += TF_ComposeTail(tf->sendbuf + tf->tx_pos, &tf->tx_cksum);
+        if (!cksum)
+        {
+            CKSUM_FINALIZE(tf->tx_cksum);
+            cksum = &tf->tx_cksum;
+        }
+        tf->tx_pos += TF_ComposeTail(tf->sendbuf + tf->tx_pos, *cksum);
     }
 
     TF_WriteImpl(tf, (const uint8_t *)tf->sendbuf, tf->tx_pos);
@@ -1087,8 +3713,8 @@ static bool _TF_FN TF_SendFrame(TinyFrame *tf, TF_Msg *msg, TF_Listener listener
         // Send the payload and checksum only if we're not starting a multi-part frame.
         // A multi-part frame is identified by passing NULL to the data field and setting the length.
         // User then needs to call those functions manually
-        TF_SendFrame_Chunk(tf, msg->data, msg->len);
-        TF_SendFrame_End(tf);
+        TF_SendFrame_Chunk(tf, msg->data, msg->len, true);
+        TF_SendFrame_End(tf, NULL);
     }
     return true;
 }
@@ -1172,44 +3798,170 @@ void _TF_FN TF_Respond_Multipart(TinyFrame *tf, TF_Msg *msg)
 
 void _TF_FN TF_Multipart_Payload(TinyFrame *tf, const uint8_t *buff, uint32_t length)
 {
-    TF_SendFrame_Chunk(tf, buff, length);
+    TF_SendFrame_Chunk(tf, buff, length, true);
+}
+
+void _TF_FN TF_Multipart_PayloadRaw(TinyFrame *tf, const uint8_t *buff, uint32_t length)
+{
+    TF_SendFrame_Chunk(tf, buff, length, false);
 }
 
 void _TF_FN TF_Multipart_Close(TinyFrame *tf)
 {
-    TF_SendFrame_End(tf);
+    TF_SendFrame_End(tf, NULL);
+}
+
+void _TF_FN TF_Multipart_CloseCksum(TinyFrame *tf, TF_CKSUM cksum)
+{
+    TF_SendFrame_End(tf, &cksum);
 }
 
 // endregion Sending API funcs - multipart
 
-/** Timebase hook - for timeouts */
+/** Expire an ID listener whose timeout has run out */
+static void _TF_FN expire_id_listener(TinyFrame *tf, TF_COUNT i, struct TF_IdListener_ *lst)
+{
+    TF_Error("ID listener %d has expired", (int)lst->id);
+    if (lst->fn_timeout != NULL)
+    {
+        lst->pins++; // the callback may remove the listener, the slot is freed below
+        lst->fn_timeout(tf); // execute timeout function
+        lst->pins--;
+    }
+    // Listener has expired
+    cleanup_id_listener(tf, i, lst);
+}
+
+/**
+ * Advance the timing wheel to 'now' and expire the ID listeners due in (tf->timer_now, now].
+ * Only the slots passed over are visited, at most one full turn.
+ */
+static void _TF_FN timer_advance(TinyFrame *tf, TF_TICKS now)
+{
+    TF_TICKS last = tf->timer_now;
+    TF_TICKS elapsed = (TF_TICKS)(now - last);
+    uint32_t step, steps, slot;
+    TF_COUNT i, head, n;
+    struct TF_IdListener_ *lst;
+
+    steps = (elapsed < TF_TIMER_SLOTS) ? (uint32_t)elapsed : TF_TIMER_SLOTS;
+    for (step = 1; step <= steps && tf->timer_count != 0; step++)
+    {
+        slot = timer_slot((TF_TICKS)(last + step));
+
+        // Usually nothing in the slot is due yet, it only holds listeners for later turns
+        head = tf->timer_wheel[slot];
+        for (n = head; n != 0; n = (lst->wnext != head) ? lst->wnext : 0)
+        {
+            lst = &tf->id_listeners[n - 1];
+            if ((TF_TICKS)(lst->deadline - last - 1) < elapsed)
+                break;
+        }
+        if (n == 0)
+            continue;
+
+        // Detach the slot's ring, then put back those due on a later turn.
+        // Callbacks may add, renew or remove listeners meanwhile, timer_unlink() knows about timer_due.
+        tf->timer_due = tf->timer_wheel[slot];
+        tf->timer_wheel[slot] = 0;
+        while (tf->timer_due != 0)
+        {
+            i = (TF_COUNT)(tf->timer_due - 1);
+            lst = &tf->id_listeners[i];
+            timer_unlink(tf, i, lst);
+            if ((TF_TICKS)(lst->deadline - last - 1) < elapsed)
+            {
+                expire_id_listener(tf, i, lst);
+            }
+            else
+            {
+                timer_link(tf, i, lst);
+            }
+        }
+    }
+    tf->timer_now = now;
+}
+
+#if TF_USE_CLOCK
+/** Timebase hook - expire due ID listeners */
 void _TF_FN TF_Tick(TinyFrame *tf)
 {
-    TF_COUNT i;
+    // the parser timeout is checked when receiving the next bytes
+    LST_LOCK(tf);
+    timer_advance(tf, TF_GetTime(tf));
+    LST_UNLOCK(tf);
+}
+
+/** Find the time of the next ID listener expiry */
+bool _TF_FN TF_NextDeadline(TinyFrame *tf, TF_TICKS *deadline)
+{
+    TF_TICKS now = TF_GetTime(tf);
+    TF_TICKS last;
+    TF_TICKS dist, best = 0;
+    uint32_t step;
+    TF_COUNT head, n;
     struct TF_IdListener_ *lst;
+    bool found = false;
 
-    // increment parser timeout (timeout is handled when receiving next byte)
-    if (tf->parser_timeout_ticks < TF_PARSER_TIMEOUT_TICKS)
+    LST_LOCK(tf);
+    if (tf->timer_count == 0)
     {
-        tf->parser_timeout_ticks++;
+        LST_UNLOCK(tf);
+        return false;
     }
+    last = tf->timer_now;
 
-    // decrement and expire ID listeners
-    for (i = 0; i < tf->count_id_lst; i++)
+    // Walk the wheel from the last tick. A listener in the slot 'step' ahead is due in 'step'
+    // ticks or a whole number of turns later, so once the nearest one found is no further
+    // than 'step', none of the remaining slots can hold a nearer one.
+    for (step = 1; step <= TF_TIMER_SLOTS; step++)
     {
-        lst = &tf->id_listeners[i];
-        if (!lst->fn || lst->timeout == 0)
-            continue;
-        // count down...
-        if (--lst->timeout == 0)
+        head = tf->timer_wheel[timer_slot((TF_TICKS)(last + step))];
+        for (n = head; n != 0; n = (lst->wnext != head) ? lst->wnext : 0)
         {
-            TF_Error("ID listener %d has expired", (int)lst->id);
-            if (lst->fn_timeout != NULL)
+            lst = &tf->id_listeners[n - 1];
+            dist = (TF_TICKS)(lst->deadline - last);
+            if (!found || dist < best)
             {
-                lst->fn_timeout(tf); // execute timeout function
+                best = dist;
+                found = true;
             }
-            // Listener has expired
-            cleanup_id_listener(tf, i, lst);
         }
+        if (found && best <= step)
+            break;
+    }
+
+    // already due, but TF_Tick() was not called yet
+    if (best <= (TF_TICKS)(now - last))
+    {
+        *deadline = now;
+    }
+    else
+    {
+        *deadline = (TF_TICKS)(last + best);
+    }
+    LST_UNLOCK(tf);
+    return found;
+}
+#else
+/** Timebase hook - for timeouts */
+void _TF_FN TF_Tick(TinyFrame *tf)
+{
+#if !TF_USE_DISPATCH_QUEUE
+    // increment parser timeout (timeout is handled when receiving next byte)
+    if (tf->parser_timeout_ticks < TF_PARSER_TIMEOUT_TICKS)
+    {
+        tf->parser_timeout_ticks++;
     }
+#endif
+
+    LST_LOCK(tf);
+#if TF_USE_DISPATCH_QUEUE
+    // the parser thread reads it, several threads may tick - written only here, in the lock
+    TF_QUEUE_STORE(&tf->tick_count, (TF_TICKS)(tf->tick_count + 1));
+#endif
+    // one tick on the wheel, only listeners in the current slot are looked at
+    timer_advance(tf, (TF_TICKS)(tf->timer_now + 1));
+    LST_UNLOCK(tf);
 }
+#endif
@@ -1,5 +1,7 @@
-#ifndef TinyFrameH
+#if !defined(TinyFrameH) || defined(TF_PREFIX)
+#ifndef TF_PREFIX
 #define TinyFrameH
+#endif
 
 /**
  * Thư viện giao thức TinyFrame
@@ -13,6 +15,11 @@
  * Upstream URL: https://github.com/MightyPork/TinyFrame
  */
 
+// Phần không phụ thuộc cấu hình, chung cho mọi instance có prefix
+// The config independent part, shared by all prefixed instances
+#ifndef TinyFrameCommonH
+#define TinyFrameCommonH
+
 #define TF_VERSION "2.3.0"
 
 //---------------------------------------------------------------------------
@@ -29,11 +36,235 @@
 #define TF_CKSUM_CRC8 9     // Dallas/Maxim CRC8 (1-wire)
 #define TF_CKSUM_CRC16 16   // CRC16 với đa thức 0x8005 (x^16 + x^15 + x^2 + 1) | CRC16 with the polynomial 0x8005 (x^16 + x^15 + x^2 + 1)
 #define TF_CKSUM_CRC32 32   // CRC32 với đa thức 0xedb88320 | CRC32 with the polynomial 0xedb88320
+#define TF_CKSUM_CRC32C 33  // CRC32C (Castagnoli) 0x82f63b78, tính bằng phần cứng nếu có | CRC32C (Castagnoli) 0x82f63b78, computed in hardware if available
+#define TF_CKSUM_FLETCHER16 17 // Fletcher-16 (mod 255), nhanh hơn CRC, mạnh hơn XOR | Fletcher-16 (mod 255), faster than CRC, stronger than XOR
+#define TF_CKSUM_ADLER32 34    // Adler-32 (mod 65521, như zlib), nhanh hơn CRC | Adler-32 (mod 65521, as in zlib), faster than CRC
 #define TF_CKSUM_CUSTOM8 1  // Checksum 8-bit tùy chỉnh | Custom 8-bit checksum
 #define TF_CKSUM_CUSTOM16 2 // Checksum 16-bit tùy chỉnh | Custom 16-bit checksum
 #define TF_CKSUM_CUSTOM32 3 // Checksum 32-bit tùy chỉnh | Custom 32-bit checksum
 
+// Số bucket của bảng tra cho n slot listener (lũy thừa của 2 >= n, ít nhất 8), dùng để khai báo
+// cfg.id_index / cfg.type_index cho TF_InitStaticEx() với TF_USE_EXTERNAL_LISTENERS
+// Nr of lookup buckets for n listener slots (a power of 2 >= n, at least 8), to declare
+// cfg.id_index / cfg.type_index for TF_InitStaticEx() with TF_USE_EXTERNAL_LISTENERS
+#define TF_INDEX_LEN(n) ((n) <= 8 ? 8u : (n) <= 16 ? 16u : (n) <= 32 ? 32u : (n) <= 64 ? 64u : (n) <= 128 ? 128u : \
+                         (n) <= 256 ? 256u : (n) <= 512 ? 512u : (n) <= 1024 ? 1024u : (n) <= 2048 ? 2048u : \
+                         (n) <= 4096 ? 4096u : (n) <= 8192 ? 8192u : (n) <= 16384 ? 16384u : (n) <= 32768 ? 32768u : 65536u)
+
+#define TF_PFX_(prefix, name) prefix##name
+#define TF_PFX2(prefix, name) TF_PFX_(prefix, name)
+#define TF_PFX(name) TF_PFX2(TF_PREFIX, name)
+
+/** Enum bit peer (dùng cho khởi tạo) | Peer bit enum (used for init) */
+typedef enum
+{
+    TF_SLAVE = 0,  // Thiết bị slave | slave device
+    TF_MASTER = 1, // Thiết bị master | master device
+} TF_Peer;
+
+/** Phản hồi từ các listener | Response from listeners */
+typedef enum
+{
+    TF_NEXT = 0,  //!< Không được xử lý, để listener khác xử lý | Not handled, let other listeners handle it
+    TF_STAY = 1,  //!< Đã xử lý, giữ listener | Handled, stay
+    TF_RENEW = 2, //!< Đã xử lý, giữ listener và gia hạn - chỉ hữu ích với listener có timeout | Handled, stay, renew - useful only with listener timeout
+    TF_CLOSE = 3, //!< Đã xử lý, xóa bỏ listener | Handled, remove self
+} TF_Result;
+
+// Enum trạng thái parser (nội bộ) | Parser state enum (internal)
+enum TF_State_
+{
+    TFState_SOF = 0,    //!< Chờ SOF | Wait for SOF
+    TFState_LEN,        //!< Chờ số byte | Wait for Number Of Bytes
+    TFState_HEAD_CKSUM, //!< Chờ Checksum header | Wait for header Checksum
+    TFState_ID,         //!< Chờ ID | Wait for ID
+    TFState_TYPE,       //!< Chờ loại thông điệp | Wait for message type
+    TFState_DATA,       //!< Nhận payload | Receive payload
+    TFState_DATA_CKSUM  //!< Chờ Checksum | Wait for Checksum
+};
+
+#endif // TinyFrameCommonH
+
+// Nhiều cấu hình trong một chương trình: định nghĩa TF_PREFIX (và TF_CONFIG_HEADER) trước khi include,
+// mọi tên công khai được đổi thành <TF_PREFIX>TF_..., xem TF_Prefix.h
+// Several configurations in one program: define TF_PREFIX (and TF_CONFIG_HEADER) before the include,
+// all public names are renamed to <TF_PREFIX>TF_..., see TF_Prefix.h
+#ifdef TF_PREFIX
+#include "TF_Prefix.h"
+#endif
+
+#ifdef TF_CONFIG_HEADER
+#include TF_CONFIG_HEADER
+#else
 #include "TF_Config.h"
+#endif
+
+// region Giá trị mặc định cho các tùy chọn | Defaults for optional settings
+// Các tùy chọn này có thể được bỏ qua trong TF_Config.h
+// Those options may be left out of TF_Config.h
+
+// Số byte CRC8 / CRC16 / CRC32 xử lý mỗi bước trên khối dữ liệu (1, 4 hoặc 8 - bảng lớn hơn)
+// Nr of bytes CRC8 / CRC16 / CRC32 processes per step on data blocks (1, 4 or 8 - larger tables)
+#ifndef TF_CRC_SLICING
+#define TF_CRC_SLICING 1
+#endif
+#if TF_CRC_SLICING != 1 && TF_CRC_SLICING != 4 && TF_CRC_SLICING != 8
+#error Giá trị không hợp lệ cho TF_CRC_SLICING, phải là 1, 4 hoặc 8 | Bad value of TF_CRC_SLICING, must be 1, 4 or 8
+#endif
+
+// Checksum tùy chỉnh: người dùng cung cấp thêm TF_CksumAddBlock() cho các khối byte
+// Custom checksums: the user also provides TF_CksumAddBlock() for byte blocks
+#ifndef TF_CKSUM_CUSTOM_BLOCK
+#define TF_CKSUM_CUSTOM_BLOCK 0
+#endif
+
+// Dùng lệnh CRC của CPU khi có: CRC32C với SSE 4.2 / ARMv8 CRC, CRC16 / CRC32 với PCLMULQDQ
+// Use CPU CRC instructions when available: CRC32C with SSE 4.2 / ARMv8 CRC, CRC16 / CRC32 with PCLMULQDQ
+#ifndef TF_USE_CRC_HW
+#define TF_USE_CRC_HW 1
+#endif
+
+// Giao payload trực tiếp từ buffer truyền vào TF_Accept() khi frame nằm trọn trong đó
+// Deliver the payload straight from the buffer passed to TF_Accept() when the frame lies entirely in it
+#ifndef TF_USE_ZERO_COPY_RX
+#define TF_USE_ZERO_COPY_RX 1
+#endif
+
+// Stream listener - nhận payload lớn hơn TF_MAX_PAYLOAD_RX theo từng phần
+// Stream listeners - receive payloads larger than TF_MAX_PAYLOAD_RX in chunks
+#ifndef TF_USE_STREAM_RX
+#define TF_USE_STREAM_RX 0
+#endif
+#ifndef TF_MAX_STREAM_LST
+#define TF_MAX_STREAM_LST 2
+#endif
+
+// Listener cho một dải type hoặc mẫu mask/value, tra qua bảng 256 ô theo byte thấp của type
+// Listeners for a type range or a mask/value pattern, looked up through a 256-entry table by the low type byte
+#ifndef TF_USE_RANGE_LST
+#define TF_USE_RANGE_LST 0
+#endif
+#ifndef TF_MAX_RANGE_LST
+#define TF_MAX_RANGE_LST 4
+#endif
+
+// Buffer Rx/Tx nằm ngoài struct, kích thước chọn riêng cho từng instance (TF_InitEx)
+// Rx/Tx buffers live outside the struct, sized per instance (TF_InitEx)
+#ifndef TF_USE_EXTERNAL_BUFFERS
+#define TF_USE_EXTERNAL_BUFFERS 0
+#endif
+
+// Bảng ID / Type / Generic listener nằm ngoài struct, số slot chọn riêng cho từng instance (TF_InitEx)
+// ID / Type / Generic listener tables live outside the struct, slot counts chosen per instance (TF_InitEx)
+#ifndef TF_USE_EXTERNAL_LISTENERS
+#define TF_USE_EXTERNAL_LISTENERS 0
+#endif
+
+// Batch listener - giao tất cả frame hoàn tất trong một lần gọi TF_Accept() cùng lúc
+// Batch listener - deliver all frames completed within one TF_Accept() call together
+#ifndef TF_USE_BATCH
+#define TF_USE_BATCH 0
+#endif
+#ifndef TF_MAX_BATCH
+#define TF_MAX_BATCH 16
+#endif
+#ifndef TF_BATCH_DATA_LEN
+#define TF_BATCH_DATA_LEN 256
+#endif
+
+// Hàng đợi SPSC giữa parser và TF_Dispatch() - listener chạy trên luồng gọi TF_Dispatch() thay vì trong TF_Accept()
+// SPSC queue between the parser and TF_Dispatch() - listeners run on the thread calling TF_Dispatch() instead of inside TF_Accept()
+#ifndef TF_USE_DISPATCH_QUEUE
+#define TF_USE_DISPATCH_QUEUE 0
+#endif
+// Số frame tối đa trong mỗi lane (lũy thừa của 2) | Max nr of frames in each lane (power of 2)
+#ifndef TF_DISPATCH_SLOTS
+#define TF_DISPATCH_SLOTS 8
+#endif
+// Số byte cho bản sao payload trong mỗi lane (lũy thừa của 2), mặc định >= 2 * TF_MAX_PAYLOAD_RX
+// Nr of bytes for payload copies in each lane (power of 2), by default >= 2 * TF_MAX_PAYLOAD_RX
+#ifndef TF_DISPATCH_DATA_LEN
+#define TF_DISPATCH_DATA_LEN (TF_MAX_PAYLOAD_RX <= 128 ? 256 : TF_MAX_PAYLOAD_RX <= 512 ? 1024 : \
+                              TF_MAX_PAYLOAD_RX <= 2048 ? 4096 : TF_MAX_PAYLOAD_RX <= 8192 ? 16384 : 65536)
+#endif
+// Số lane của hàng đợi (lũy thừa của 2): frame cùng type, hoặc phản hồi cùng frame ID, luôn vào cùng một lane
+// và được xử lý theo thứ tự; các lane khác nhau có thể chạy song song trên nhiều worker
+// Nr of queue lanes (power of 2): frames of one type, or replies to one frame ID, always go to the same lane
+// and are handled in order; different lanes may run in parallel on several workers
+#ifndef TF_DISPATCH_LANES
+#define TF_DISPATCH_LANES 1
+#endif
+#if TF_USE_DISPATCH_QUEUE
+#if TF_DISPATCH_LANES < 1 || (TF_DISPATCH_LANES & (TF_DISPATCH_LANES - 1)) != 0
+#error TF_DISPATCH_LANES phải là lũy thừa của 2 | TF_DISPATCH_LANES must be a power of 2
+#endif
+#if TF_DISPATCH_LANES > 64
+// Mỗi lane có thể đang chạy cùng một listener, số đếm pins của nó là 8-bit
+// Every lane may be running the same listener, its pins count is 8-bit
+#error TF_DISPATCH_LANES tối đa là 64 | TF_DISPATCH_LANES can be at most 64
+#endif
+#if TF_DISPATCH_SLOTS < 1 || (TF_DISPATCH_SLOTS & (TF_DISPATCH_SLOTS - 1)) != 0
+#error TF_DISPATCH_SLOTS phải là lũy thừa của 2 | TF_DISPATCH_SLOTS must be a power of 2
+#endif
+#if TF_DISPATCH_DATA_LEN < 1 || (TF_DISPATCH_DATA_LEN & (TF_DISPATCH_DATA_LEN - 1)) != 0
+#error TF_DISPATCH_DATA_LEN phải là lũy thừa của 2 | TF_DISPATCH_DATA_LEN must be a power of 2
+#endif
+#if TF_USE_BATCH
+#error TF_USE_DISPATCH_QUEUE không dùng cùng TF_USE_BATCH | TF_USE_DISPATCH_QUEUE cannot be combined with TF_USE_BATCH
+#endif
+#elif TF_DISPATCH_LANES > 1
+#error TF_DISPATCH_LANES cần TF_USE_DISPATCH_QUEUE | TF_DISPATCH_LANES requires TF_USE_DISPATCH_QUEUE
+#endif
+
+// Khi checksum header sai, quét lại các byte header để tìm frame bắt đầu bên trong chúng
+// After a header checksum failure, rescan the header bytes for a frame starting inside them
+#ifndef TF_USE_HEAD_LOOKBACK
+#define TF_USE_HEAD_LOOKBACK 1
+#endif
+
+// Timeout dựa trên đồng hồ đơn điệu TF_GetTime() thay vì đếm số lần gọi TF_Tick()
+// Timeouts based on the TF_GetTime() monotonic clock instead of counting TF_Tick() calls
+#ifndef TF_USE_CLOCK
+#define TF_USE_CLOCK 0
+#endif
+
+// Số bucket của bảng tra type listener (lũy thừa của 2). Với type 1 byte, 256 = tra trực tiếp không va chạm.
+// Với type 2 / 4 byte và TF_USE_EXTERNAL_LISTENERS, mỗi instance có bảng TF_INDEX_LEN(type_lst_len) riêng.
+// Nr of buckets in the type listener lookup table (power of 2). With 1-byte types, 256 = direct-mapped, no collisions.
+// With 2 / 4-byte types and TF_USE_EXTERNAL_LISTENERS, each instance has its own TF_INDEX_LEN(type_lst_len) table.
+#ifndef TF_TYPE_BUCKETS
+#if TF_TYPE_BYTES == 1
+#define TF_TYPE_BUCKETS 256
+#else
+#define TF_TYPE_BUCKETS 64
+#endif
+#endif
+#if TF_TYPE_BUCKETS < 1 || (TF_TYPE_BUCKETS & (TF_TYPE_BUCKETS - 1)) != 0
+#error TF_TYPE_BUCKETS phải là lũy thừa của 2 | TF_TYPE_BUCKETS must be a power of 2
+#endif
+
+// Số bucket của bảng tra ID listener theo frame ID (lũy thừa của 2), mặc định >= TF_MAX_ID_LST.
+// Với TF_USE_EXTERNAL_LISTENERS, mỗi instance có bảng TF_INDEX_LEN(id_lst_len) riêng.
+// Nr of buckets in the ID listener lookup table keyed by frame ID (power of 2), by default >= TF_MAX_ID_LST.
+// With TF_USE_EXTERNAL_LISTENERS, each instance has its own TF_INDEX_LEN(id_lst_len) table.
+#ifndef TF_ID_BUCKETS
+#define TF_ID_BUCKETS (TF_MAX_ID_LST <= 8 ? 8 : TF_MAX_ID_LST <= 32 ? 32 : TF_MAX_ID_LST <= 128 ? 128 : \
+                       TF_MAX_ID_LST <= 512 ? 512 : TF_MAX_ID_LST <= 2048 ? 2048 : 8192)
+#endif
+#if TF_ID_BUCKETS < 1 || (TF_ID_BUCKETS & (TF_ID_BUCKETS - 1)) != 0
+#error TF_ID_BUCKETS phải là lũy thừa của 2 | TF_ID_BUCKETS must be a power of 2
+#endif
+
+// Số ô của timing wheel cho timeout của ID listener (lũy thừa của 2, không lớn hơn phạm vi của TF_TICKS)
+// Nr of slots in the timing wheel for ID listener timeouts (power of 2, not larger than the range of TF_TICKS)
+#ifndef TF_TIMER_SLOTS
+#define TF_TIMER_SLOTS 64
+#endif
+#if TF_TIMER_SLOTS < 1 || (TF_TIMER_SLOTS & (TF_TIMER_SLOTS - 1)) != 0
+#error TF_TIMER_SLOTS phải là lũy thừa của 2 | TF_TIMER_SLOTS must be a power of 2
+#endif
+
+// endregion
 
 // region Xác định kiểu dữ liệu | Resolve data types
 
@@ -78,11 +309,12 @@ typedef uint32_t TF_ID;
 #if (TF_CKSUM_TYPE == TF_CKSUM_XOR) || (TF_CKSUM_TYPE == TF_CKSUM_NONE) || (TF_CKSUM_TYPE == TF_CKSUM_CUSTOM8) || (TF_CKSUM_TYPE == TF_CKSUM_CRC8)
 // ~XOR (nếu là 0, vẫn dùng 1 byte - nhưng không sử dụng) | ~XOR (if 0, still use 1 byte - it won't be used)
 typedef uint8_t TF_CKSUM;
-#elif (TF_CKSUM_TYPE == TF_CKSUM_CRC16) || (TF_CKSUM_TYPE == TF_CKSUM_CUSTOM16)
-// CRC16
+#elif (TF_CKSUM_TYPE == TF_CKSUM_CRC16) || (TF_CKSUM_TYPE == TF_CKSUM_FLETCHER16) || (TF_CKSUM_TYPE == TF_CKSUM_CUSTOM16)
+// CRC16, Fletcher-16
 typedef uint16_t TF_CKSUM;
-#elif (TF_CKSUM_TYPE == TF_CKSUM_CRC32) || (TF_CKSUM_TYPE == TF_CKSUM_CUSTOM32)
-// CRC32
+#elif (TF_CKSUM_TYPE == TF_CKSUM_CRC32) || (TF_CKSUM_TYPE == TF_CKSUM_CRC32C) || (TF_CKSUM_TYPE == TF_CKSUM_ADLER32) || \
+    (TF_CKSUM_TYPE == TF_CKSUM_CUSTOM32)
+// CRC32, Adler-32
 typedef uint32_t TF_CKSUM;
 #else
 #error Giá trị không hợp lệ cho TF_CKSUM_TYPE | Bad value for TF_CKSUM_TYPE
@@ -92,22 +324,6 @@ typedef uint32_t TF_CKSUM;
 
 //---------------------------------------------------------------------------
 
-/** Enum bit peer (dùng cho khởi tạo) | Peer bit enum (used for init) */
-typedef enum
-{
-    TF_SLAVE = 0,  // Thiết bị slave | slave device
-    TF_MASTER = 1, // Thiết bị master | master device
-} TF_Peer;
-
-/** Phản hồi từ các listener | Response from listeners */
-typedef enum
-{
-    TF_NEXT = 0,  //!< Không được xử lý, để listener khác xử lý | Not handled, let other listeners handle it
-    TF_STAY = 1,  //!< Đã xử lý, giữ listener | Handled, stay
-    TF_RENEW = 2, //!< Đã xử lý, giữ listener và gia hạn - chỉ hữu ích với listener có timeout | Handled, stay, renew - useful only with listener timeout
-    TF_CLOSE = 3, //!< Đã xử lý, xóa bỏ listener | Handled, remove self
-} TF_Result;
-
 /** Cấu trúc dữ liệu để gửi/nhận thông điệp | Data structure for sending / receiving messages */
 typedef struct TF_Msg_
 {
@@ -128,6 +344,11 @@ typedef struct TF_Msg_
      *   Lời gọi này phải được theo sau bởi việc gửi payload và đóng frame.
      * - If (data == NULL) and length is not zero when sending a frame, that starts a multi-part frame.
      *   This call then must be followed by sending the payload and closing the frame.
+     *
+     * - Dữ liệu nhận được chỉ hợp lệ trong lúc listener chạy. Nó có thể trỏ vào buffer nội bộ,
+     *   hoặc thẳng vào buffer đã truyền cho TF_Accept() (TF_USE_ZERO_COPY_RX).
+     * - Received data is valid only while the listener runs. It may point to the internal buffer,
+     *   or straight into the buffer passed to TF_Accept() (TF_USE_ZERO_COPY_RX).
      */
     const uint8_t *data;
     TF_LEN len; //!< độ dài của payload | length of the payload
@@ -179,6 +400,49 @@ typedef TF_Result (*TF_Listener)(TinyFrame *tf, TF_Msg *msg);
  */
 typedef TF_Result (*TF_Listener_Timeout)(TinyFrame *tf);
 
+#if TF_USE_STREAM_RX
+/**
+ * Callback nhận một phần payload của frame stream
+ * Stream listener payload chunk callback
+ *
+ * @param tf - instance
+ * @param msg - frame đang nhận: frame_id, type và len (tổng độ dài payload), data là NULL | the frame being received: frame_id, type and len (total payload length), data is NULL
+ * @param offset - vị trí của phần này trong payload | position of the chunk in the payload
+ * @param chunk - các byte payload | payload bytes
+ * @param len - số byte trong chunk | nr of bytes in the chunk
+ */
+typedef void (*TF_StreamChunk)(TinyFrame *tf, TF_Msg *msg, uint32_t offset, const uint8_t *chunk, uint32_t len);
+
+/**
+ * Callback kết thúc frame stream
+ * Stream listener end-of-frame callback
+ *
+ * Được gọi sau phần cuối cùng, hoặc khi frame bị bỏ dở (parser timeout / reset).
+ * Called after the last chunk, or when the frame is abandoned (parser timeout / reset).
+ *
+ * @param tf - instance
+ * @param msg - frame đã nhận, giống như trong callback chunk | the received frame, same as in the chunk callback
+ * @param cksum_ok - true nếu toàn bộ payload đã nhận và checksum khớp | true if the whole payload arrived and the checksum matched
+ * @return TF_CLOSE để xóa listener, các giá trị khác giữ nó | TF_CLOSE to remove the listener, other values keep it
+ */
+typedef TF_Result (*TF_StreamEnd)(TinyFrame *tf, TF_Msg *msg, bool cksum_ok);
+#endif
+
+#if TF_USE_BATCH
+/**
+ * Callback cho Batch listener
+ * Batch listener callback
+ *
+ * Dữ liệu của các thông điệp chỉ hợp lệ trong callback.
+ * The message data is only valid inside the callback.
+ *
+ * @param tf - instance
+ * @param msgs - các thông điệp nhận được, theo thứ tự đến | the received messages, in arrival order
+ * @param count - số thông điệp | nr of messages
+ */
+typedef void (*TF_BatchListener)(TinyFrame *tf, TF_Msg *msgs, uint32_t count);
+#endif
+
 // ---------------------------------- KHỞI TẠO | INIT ------------------------------
 
 /**
@@ -208,12 +472,87 @@ TinyFrame *TF_Init(TF_Peer peer_bit);
  * Trường .userdata / .usertag được bảo tồn khi TF_InitStatic được gọi.
  * The .userdata / .usertag field is preserved when TF_InitStatic is called.
  *
+ * Với TF_USE_EXTERNAL_BUFFERS / TF_USE_EXTERNAL_LISTENERS, instance phải đã được khởi
+ * tạo bằng TF_InitEx() hoặc TF_InitStaticEx(); buffer và bảng listener được giữ nguyên.
+ * With TF_USE_EXTERNAL_BUFFERS / TF_USE_EXTERNAL_LISTENERS, the instance must already
+ * have been initialized by TF_InitEx() or TF_InitStaticEx(); its buffers and listener
+ * tables are kept.
+ *
  * @param tf - instance
  * @param peer_bit - peer bit để sử dụng cho bản thân | peer bit to use for self
  * @return thành công | success
  */
 bool TF_InitStatic(TinyFrame *tf, TF_Peer peer_bit);
 
+/**
+ * Cấu hình cho TF_InitEx() / TF_InitStaticEx().
+ * Configuration for TF_InitEx() / TF_InitStaticEx().
+ * Các trường để 0 / NULL dùng giá trị mặc định.
+ * Fields left at 0 / NULL use the defaults.
+ */
+struct TF_IdListener_;
+struct TF_TypeListener_;
+struct TF_GenericListener_;
+
+typedef struct TF_InitCfg_
+{
+#if TF_USE_EXTERNAL_LISTENERS
+    struct TF_IdListener_ *id_lst;        // Bảng ID listener, NULL = cấp phát | ID listener table, NULL = allocate
+    TF_COUNT id_lst_len;                  // Số slot ID listener, 0 = TF_MAX_ID_LST | Nr of ID listener slots, 0 = TF_MAX_ID_LST
+    TF_COUNT *id_index;                   // TF_INDEX_LEN(id_lst_len) bucket theo frame ID, NULL = cấp phát | TF_INDEX_LEN(id_lst_len) buckets by frame ID, NULL = allocate
+    struct TF_TypeListener_ *type_lst;    // Bảng Type listener, NULL = cấp phát | Type listener table, NULL = allocate
+    TF_COUNT type_lst_len;                // Số slot Type listener, 0 = TF_MAX_TYPE_LST | Nr of Type listener slots, 0 = TF_MAX_TYPE_LST
+#if TF_TYPE_BYTES > 1
+    TF_COUNT *type_index;                 // TF_INDEX_LEN(type_lst_len) bucket theo type, NULL = cấp phát | TF_INDEX_LEN(type_lst_len) buckets by type, NULL = allocate
+#endif
+    struct TF_GenericListener_ *gen_lst;  // Bảng Generic listener, NULL = cấp phát | Generic listener table, NULL = allocate
+    TF_COUNT gen_lst_len;                 // Số slot Generic listener, 0 = TF_MAX_GEN_LST | Nr of Generic listener slots, 0 = TF_MAX_GEN_LST
+#endif
+#if TF_USE_EXTERNAL_BUFFERS
+    uint8_t *rx_buf;  // Buffer nhận, NULL = cấp phát | Receive buffer, NULL = allocate
+    uint32_t rx_len;  // Kích thước buffer nhận, 0 = TF_MAX_PAYLOAD_RX | Receive buffer size, 0 = TF_MAX_PAYLOAD_RX
+    uint8_t *tx_buf;  // Buffer truyền, NULL = cấp phát | Transmit buffer, NULL = allocate
+    uint32_t tx_len;  // Kích thước buffer truyền, 0 = TF_SENDBUF_LEN | Transmit buffer size, 0 = TF_SENDBUF_LEN
+#endif
+    void *(*alloc)(size_t size); // Hàm cấp phát, NULL = malloc() | Allocator, NULL = malloc()
+    void (*dealloc)(void *ptr);  // Hàm giải phóng, NULL = free() | Deallocator, NULL = free()
+} TF_InitCfg;
+
+/**
+ * Khởi tạo engine TinyFrame với cấu hình riêng cho instance.
+ * Initialize the TinyFrame engine with a per-instance configuration.
+ *
+ * Instance và các buffer / bảng listener không được cung cấp trong cfg được lấy bằng
+ * một lần gọi cfg->alloc; TF_DeInit() trả chúng lại qua cfg->dealloc.
+ * The instance and any buffers / listener tables not supplied in cfg are obtained
+ * with a single cfg->alloc call; TF_DeInit() returns them through cfg->dealloc.
+ *
+ * @param peer_bit - peer bit để sử dụng cho bản thân | peer bit to use for self
+ * @param cfg - cấu hình, NULL = mặc định | configuration, NULL = defaults
+ * @return TF instance hoặc NULL | TF instance or NULL
+ */
+TinyFrame *TF_InitEx(TF_Peer peer_bit, const TF_InitCfg *cfg);
+
+/**
+ * Khởi tạo instance được cấp phát tĩnh với buffer do người dùng cung cấp.
+ * Initialize a statically allocated instance with user-supplied buffers.
+ *
+ * Với TF_USE_EXTERNAL_BUFFERS, cfg->rx_buf và cfg->tx_buf là bắt buộc; với
+ * TF_USE_EXTERNAL_LISTENERS, cfg->id_lst, cfg->type_lst, cfg->gen_lst và cfg->id_index
+ * (cả cfg->type_index với type 2 / 4 byte) cũng vậy.
+ * Các lần gọi TF_InitStatic() sau đó (để reset) giữ nguyên các buffer / bảng này.
+ * With TF_USE_EXTERNAL_BUFFERS, cfg->rx_buf and cfg->tx_buf are required; with
+ * TF_USE_EXTERNAL_LISTENERS, so are cfg->id_lst, cfg->type_lst, cfg->gen_lst and
+ * cfg->id_index (and cfg->type_index with 2 / 4-byte types).
+ * Later TF_InitStatic() calls (to reset) keep these buffers / tables.
+ *
+ * @param tf - instance
+ * @param peer_bit - peer bit để sử dụng cho bản thân | peer bit to use for self
+ * @param cfg - cấu hình | configuration
+ * @return thành công | success
+ */
+bool TF_InitStaticEx(TinyFrame *tf, TF_Peer peer_bit, const TF_InitCfg *cfg);
+
 /**
  * Hủy khởi tạo TF instance được cấp phát động
  * De-init the dynamically allocated TF instance
@@ -256,10 +595,30 @@ void TF_AcceptChar(TinyFrame *tf, uint8_t c);
  * Một nơi phổ biến để gọi từ đó là SysTick handler.
  * A common place to call this from is the SysTick handler.
  *
+ * Với TF_USE_CLOCK, timeout của parser được kiểm tra theo TF_GetTime() khi nhận byte,
+ * và hàm này chỉ cần được gọi khi đến thời điểm trả về bởi TF_NextDeadline().
+ * With TF_USE_CLOCK, the parser timeout is checked against TF_GetTime() when receiving
+ * bytes, and this only needs to be called at the time returned by TF_NextDeadline().
+ *
  * @param tf - instance
  */
 void TF_Tick(TinyFrame *tf);
 
+#if TF_USE_CLOCK
+/**
+ * Tìm thời điểm hết hạn gần nhất của các ID listener.
+ * Find the time of the nearest ID listener expiry.
+ *
+ * Vòng lặp sự kiện có thể ngủ đến thời điểm này rồi gọi TF_Tick().
+ * The event loop can sleep until this time and then call TF_Tick().
+ *
+ * @param tf - instance
+ * @param deadline - thời điểm theo TF_GetTime(), có thể đã qua | the time on the TF_GetTime() clock, may be in the past
+ * @return false nếu không có listener nào có timeout | false if no listener has a timeout
+ */
+bool TF_NextDeadline(TinyFrame *tf, TF_TICKS *deadline);
+#endif
+
 /**
  * Reset state machine của frame parser.
  * Reset the frame parser state machine.
@@ -314,6 +673,57 @@ bool TF_AddTypeListener(TinyFrame *tf, TF_TYPE frame_type, TF_Listener cb);
  */
 bool TF_RemoveTypeListener(TinyFrame *tf, TF_TYPE type);
 
+#if TF_USE_RANGE_LST
+/**
+ * Đăng ký listener cho mọi type trong dải lo..hi (bao gồm cả hai đầu).
+ * Register a listener for every type in the range lo..hi (both inclusive).
+ *
+ * Được gọi sau các Type listener của đúng type đó và trước Generic listeners. Nhiều
+ * listener chồng lên nhau được gọi theo thứ tự đăng ký khi trả về TF_NEXT.
+ * Called after the Type listeners of that exact type and before Generic listeners.
+ * Overlapping listeners run in registration order when they return TF_NEXT.
+ *
+ * @param tf - instance
+ * @param lo - type đầu tiên | first type
+ * @param hi - type cuối cùng | last type
+ * @param cb - callback
+ * @return thành công | success
+ */
+bool TF_AddTypeRangeListener(TinyFrame *tf, TF_TYPE lo, TF_TYPE hi, TF_Listener cb);
+
+/**
+ * Đăng ký listener cho mọi type thỏa (type & mask) == value.
+ * Register a listener for every type where (type & mask) == value.
+ *
+ * @param tf - instance
+ * @param mask - các bit được so sánh | bits to compare
+ * @param value - giá trị của các bit đó | value of those bits
+ * @param cb - callback
+ * @return thành công | success
+ */
+bool TF_AddTypeMaskListener(TinyFrame *tf, TF_TYPE mask, TF_TYPE value, TF_Listener cb);
+
+/**
+ * Xóa một range listener theo dải mà nó đã đăng ký.
+ * Remove a range listener by the range it's registered for.
+ *
+ * @param tf - instance
+ * @param lo - type đầu tiên | first type
+ * @param hi - type cuối cùng | last type
+ */
+bool TF_RemoveTypeRangeListener(TinyFrame *tf, TF_TYPE lo, TF_TYPE hi);
+
+/**
+ * Xóa một mask listener theo mask/value mà nó đã đăng ký.
+ * Remove a mask listener by the mask/value it's registered for.
+ *
+ * @param tf - instance
+ * @param mask - các bit được so sánh | bits to compare
+ * @param value - giá trị của các bit đó | value of those bits
+ */
+bool TF_RemoveTypeMaskListener(TinyFrame *tf, TF_TYPE mask, TF_TYPE value);
+#endif
+
 /**
  * Đăng ký một generic listener.
  * Register a generic listener.
@@ -333,6 +743,100 @@ bool TF_AddGenericListener(TinyFrame *tf, TF_Listener cb);
  */
 bool TF_RemoveGenericListener(TinyFrame *tf, TF_Listener cb);
 
+#if TF_USE_BATCH
+/**
+ * Đặt batch listener thay cho Type và Generic listeners.
+ * Set a batch listener in place of the Type and Generic listeners.
+ *
+ * Frame không được ID listener xử lý sẽ được gom lại và giao cùng nhau ở cuối
+ * TF_Accept() / TF_AcceptChar(), hoặc sớm hơn khi có TF_MAX_BATCH thông điệp hay
+ * TF_BATCH_DATA_LEN byte dữ liệu đã sao chép. ID listeners vẫn được gọi ngay.
+ * Frames not handled by an ID listener are collected and delivered together at the end
+ * of TF_Accept() / TF_AcceptChar(), or earlier once TF_MAX_BATCH messages or
+ * TF_BATCH_DATA_LEN bytes of copied data are queued. ID listeners are still called at once.
+ *
+ * Không gọi TF_Accept() từ trong callback.
+ * Do not call TF_Accept() from the callback.
+ *
+ * @param tf - instance
+ * @param cb - callback, NULL để quay lại Type và Generic listeners | callback, NULL to go back to Type and Generic listeners
+ */
+void TF_SetBatchListener(TinyFrame *tf, TF_BatchListener cb);
+#endif
+
+#if TF_USE_DISPATCH_QUEUE
+/**
+ * Chạy listener cho các frame parser đã xếp vào hàng đợi.
+ * Run the listeners for frames the parser has queued.
+ *
+ * Với TF_USE_DISPATCH_QUEUE, TF_Accept() / TF_AcceptChar() chỉ phân tích và sao chép frame
+ * đã kiểm tra vào hàng đợi SPSC; ID, Type và Generic listener chạy ở đây. Một luồng (hoặc
+ * ISR) gọi TF_Accept(), một luồng khác gọi TF_Dispatch(). TF_Tick(), TF_Query() và việc
+ * thêm / xóa listener thuộc về luồng gọi TF_Dispatch(). Stream listener vẫn chạy trong parser,
+ * nên chỉ được thêm / xóa trên luồng gọi TF_Accept() (parser duyệt danh sách đó không khóa).
+ * With TF_USE_DISPATCH_QUEUE, TF_Accept() / TF_AcceptChar() only parse and copy verified
+ * frames into an SPSC queue; ID, Type and Generic listeners run here. One thread (or ISR)
+ * calls TF_Accept(), another calls TF_Dispatch(). TF_Tick(), TF_Query() and adding / removing
+ * listeners belong to the thread calling TF_Dispatch(). Stream listeners still run in the parser,
+ * so they may only be added / removed on the thread calling TF_Accept() (the parser walks
+ * that list without a lock).
+ *
+ * Với TF_DISPATCH_LANES > 1, nhiều worker có thể cùng gọi TF_Dispatch(). Mỗi lần gọi nhận
+ * riêng từng lane còn frame và xử lý nó theo thứ tự, nên worker rảnh lấy việc từ lane khác mà
+ * không đảo thứ tự trong một lane. Bảng listener được bảo vệ bằng TF_LockListeners(): ID
+ * listener chạy trong khóa, Type / Range / Generic listener chạy ngoài khóa, song song.
+ * TF_Tick(), TF_Query() và việc thêm / xóa listener khi đó được gọi từ bất kỳ luồng nào.
+ * With TF_DISPATCH_LANES > 1, several workers may call TF_Dispatch() at once. Each call takes
+ * over one lane with waiting frames at a time and handles it in order, so an idle worker picks up
+ * work from other lanes without reordering within a lane. The listener tables are guarded by
+ * TF_LockListeners(): ID listeners run inside the lock, Type / Range / Generic listeners run
+ * outside it, in parallel. TF_Tick(), TF_Query() and adding / removing listeners may then be
+ * called from any thread.
+ *
+ * Khi lane đầy, frame mới bị bỏ và tf->dispatch_dropped tăng lên.
+ * When a lane is full, new frames are dropped and tf->dispatch_dropped is incremented.
+ *
+ * @param tf - instance
+ * @param max - số frame tối đa để xử lý, 0 = tất cả frame đang chờ | max nr of frames to handle, 0 = all waiting frames
+ * @return số frame đã xử lý | nr of frames handled
+ */
+uint32_t TF_Dispatch(TinyFrame *tf, uint32_t max);
+#endif
+
+#if TF_USE_STREAM_RX
+/**
+ * Đăng ký một stream listener.
+ * Register a stream listener.
+ *
+ * Frame thuộc loại này có payload lớn hơn TF_MAX_PAYLOAD_RX không bị bỏ qua mà được
+ * giao theo từng phần khi các byte đến, qua buffer nhận có kích thước cố định.
+ * Frames of this type with a payload larger than TF_MAX_PAYLOAD_RX are not discarded,
+ * but handed over in chunks as the bytes arrive, through the fixed size receive buffer.
+ *
+ * Với TF_USE_DISPATCH_QUEUE chỉ gọi hàm này trên luồng gọi TF_Accept().
+ * With TF_USE_DISPATCH_QUEUE, only call this on the thread calling TF_Accept().
+ *
+ * @param tf - instance
+ * @param frame_type - loại frame để lắng nghe | frame type to listen for
+ * @param chunk_cb - callback cho từng phần payload | callback for each payload chunk
+ * @param end_cb - callback kết thúc frame với kết quả checksum | end-of-frame callback with the checksum result
+ * @return thành công | success
+ */
+bool TF_AddStreamListener(TinyFrame *tf, TF_TYPE frame_type, TF_StreamChunk chunk_cb, TF_StreamEnd end_cb);
+
+/**
+ * Xóa một stream listener theo type.
+ * Remove a stream listener by type.
+ *
+ * Với TF_USE_DISPATCH_QUEUE chỉ gọi hàm này trên luồng gọi TF_Accept().
+ * With TF_USE_DISPATCH_QUEUE, only call this on the thread calling TF_Accept().
+ *
+ * @param tf - instance
+ * @param type - type mà nó đã đăng ký | the type it's registered for
+ */
+bool TF_RemoveStreamListener(TinyFrame *tf, TF_TYPE type);
+#endif
+
 /**
  * Gia hạn timeout của ID listener từ bên ngoài (thay vì trả về TF_RENEW từ ID listener)
  * Renew an ID listener timeout externally (as opposed to by returning TF_RENEW from the ID listener)
@@ -455,22 +959,59 @@ void TF_Multipart_Payload(TinyFrame *tf, const uint8_t *buff, uint32_t length);
  */
 void TF_Multipart_Close(TinyFrame *tf);
 
+/**
+ * Gửi payload cho frame multipart mà không cộng vào checksum. Dùng khi checksum được
+ * tính riêng (ví dụ song song, rồi ghép bằng TF_CksumCombine()) và gửi bằng TF_Multipart_CloseCksum().
+ * Send the payload for a started multipart frame without adding it to the checksum. Use when the
+ * checksum is computed separately (e.g. in parallel, merged with TF_CksumCombine()) and sent with
+ * TF_Multipart_CloseCksum().
+ *
+ * @param tf - instance
+ * @param buff - buffer để gửi byte từ đó | buffer to send bytes from
+ * @param length - số byte để gửi | number of bytes to send
+ */
+void TF_Multipart_PayloadRaw(TinyFrame *tf, const uint8_t *buff, uint32_t length);
+
+/**
+ * Đóng thông điệp multipart với checksum payload đã tính sẵn (giá trị của TF_Cksum()), giải phóng khóa Tx.
+ * Close the multipart message with a precomputed payload checksum (a TF_Cksum() value), releasing the Tx lock.
+ *
+ * @param tf - instance
+ * @param cksum - checksum của toàn bộ payload | checksum of the whole payload
+ */
+void TF_Multipart_CloseCksum(TinyFrame *tf, TF_CKSUM cksum);
+
+// ------------------------ CÁC HÀM CHECKSUM | CHECKSUM FUNCTIONS -----------------------------
+
+/**
+ * Tính checksum của một buffer, giống giá trị được gửi trong frame.
+ * Compute the checksum of a buffer, as it is sent in a frame.
+ *
+ * @param buf - dữ liệu | data
+ * @param len - số byte | number of bytes
+ * @return checksum cuối cùng | final checksum
+ */
+TF_CKSUM TF_Cksum(const uint8_t *buf, uint32_t len);
+
+#if (TF_CKSUM_TYPE != TF_CKSUM_CUSTOM8) && (TF_CKSUM_TYPE != TF_CKSUM_CUSTOM16) && (TF_CKSUM_TYPE != TF_CKSUM_CUSTOM32)
+/**
+ * Ghép checksum của hai đoạn liên tiếp A, B thành checksum của A|B (như crc32_combine của zlib).
+ * Cho phép tính checksum các phần của payload song song hoặc không theo thứ tự.
+ * Combine the checksums of two consecutive blocks A, B into the checksum of A|B (like zlib's crc32_combine).
+ * Lets parts of a payload be checksummed in parallel or out of order.
+ *
+ * @param cksum1 - TF_Cksum() của A | TF_Cksum() of A
+ * @param cksum2 - TF_Cksum() của B | TF_Cksum() of B
+ * @param len2 - độ dài của B | length of B
+ * @return TF_Cksum() của A|B | TF_Cksum() of A|B
+ */
+TF_CKSUM TF_CksumCombine(TF_CKSUM cksum1, TF_CKSUM cksum2, uint32_t len2);
+#endif
+
 // ---------------------------------- NỘI BỘ | INTERNAL ----------------------------------
 // Phần này chỉ có thể nhìn thấy công khai để cho phép khởi tạo tĩnh.
 // This is publicly visible only to allow static init.
 
-// Enum trạng thái parser | Parser state enum
-enum TF_State_
-{
-    TFState_SOF = 0,    //!< Chờ SOF | Wait for SOF
-    TFState_LEN,        //!< Chờ số byte | Wait for Number Of Bytes
-    TFState_HEAD_CKSUM, //!< Chờ Checksum header | Wait for header Checksum
-    TFState_ID,         //!< Chờ ID | Wait for ID
-    TFState_TYPE,       //!< Chờ loại thông điệp | Wait for message type
-    TFState_DATA,       //!< Nhận payload | Receive payload
-    TFState_DATA_CKSUM  //!< Chờ Checksum | Wait for Checksum
-};
-
 // Struct cho ID listener
 // Struct for ID listener
 struct TF_IdListener_
@@ -478,10 +1019,14 @@ struct TF_IdListener_
     TF_ID id;                       // ID frame
     TF_Listener fn;                 // Callback function
     TF_Listener_Timeout fn_timeout; // Timeout callback
-    TF_TICKS timeout;               // số tick còn lại để vô hiệu hóa listener này | nr of ticks remaining to disable this listener
+    TF_TICKS deadline;              // thời điểm hết hạn theo bộ đếm TF_Tick() (TF_USE_CLOCK: theo TF_GetTime()) | expiry time on the TF_Tick() count (TF_USE_CLOCK: on TF_GetTime())
     TF_TICKS timeout_max;           // timeout gốc được lưu trữ ở đây (0 = không timeout) | the original timeout is stored here (0 = no timeout)
     void *userdata;                 // Dữ liệu người dùng 1 | User data 1
     void *userdata2;                // Dữ liệu người dùng 2 | User data 2
+    TF_COUNT next;                  // Slot tiếp theo trong cùng bucket (hoặc danh sách trống) + 1, 0 = hết | Next slot in the same bucket (or the free list) + 1, 0 = end
+    TF_COUNT wnext;                 // Slot tiếp theo trong vòng của ô timing wheel + 1, 0 = không có timeout | Next slot in the timing wheel slot ring + 1, 0 = not scheduled
+    TF_COUNT wprev;                 // Slot trước trong vòng của ô timing wheel + 1 | Previous slot in the timing wheel slot ring + 1
+    uint8_t pins;                   // Số callback của listener đang chạy, slot không bị dùng lại khi > 0 | Nr of its callbacks running, the slot is not reused while > 0
 };
 
 // Struct cho Type listener
@@ -490,6 +1035,8 @@ struct TF_TypeListener_
 {
     TF_TYPE type;   // Loại frame | Frame type
     TF_Listener fn; // Callback function
+    TF_COUNT next;  // Slot tiếp theo trong cùng bucket (hoặc danh sách trống) + 1, 0 = hết | Next slot in the same bucket (or the free list) + 1, 0 = end
+    uint8_t pins;   // Số callback của listener đang chạy, slot không bị dùng lại khi > 0 | Nr of its callbacks running, the slot is not reused while > 0
 };
 
 // Struct cho Generic listener
@@ -497,7 +1044,57 @@ struct TF_TypeListener_
 struct TF_GenericListener_
 {
     TF_Listener fn; // Callback function
+    TF_COUNT next;  // Slot tiếp theo theo thứ tự đăng ký (hoặc danh sách trống) + 1, 0 = hết | Next slot in registration order (or the free list) + 1, 0 = end
+    uint8_t pins;   // Số callback của listener đang chạy, slot không bị dùng lại khi > 0 | Nr of its callbacks running, the slot is not reused while > 0
+};
+
+#if TF_USE_RANGE_LST
+// Struct cho Range / Mask listener - khớp khi lo <= type <= hi và (type & mask) == value
+// Struct for Range / Mask listener - matches when lo <= type <= hi and (type & mask) == value
+struct TF_RangeListener_
+{
+    TF_TYPE lo;     // Type đầu tiên | First type
+    TF_TYPE hi;     // Type cuối cùng | Last type
+    TF_TYPE mask;   // Các bit được so sánh | Bits to compare
+    TF_TYPE value;  // Giá trị của các bit đó | Value of those bits
+    TF_Listener fn; // Callback function
+    TF_COUNT next;  // Slot tiếp theo theo thứ tự đăng ký (hoặc danh sách trống) + 1, 0 = hết | Next slot in registration order (or the free list) + 1, 0 = end
+    uint8_t pins;   // Số callback của listener đang chạy, slot không bị dùng lại khi > 0 | Nr of its callbacks running, the slot is not reused while > 0
+};
+#endif
+
+#if TF_USE_DISPATCH_QUEUE
+// Một lane của hàng đợi dispatch. Vị trí tăng liên tục (tràn vòng theo uint32_t). Parser chỉ ghi head / data_head,
+// worker đang giữ lane chỉ ghi tail / data_tail - chúng nằm ở hai đầu để không chung cache line.
+// One lane of the dispatch queue. Free-running positions (wrapping as uint32_t). The parser only writes head / data_head,
+// the worker holding the lane only writes tail / data_tail - they sit at both ends so they don't share a cache line.
+struct TF_DispatchLane_
+{
+    uint32_t head;                      // Số frame đã xếp vào | Nr of frames queued
+    uint32_t data_head;                 // Số byte payload đã dùng | Nr of payload bytes used
+    TF_Msg msg[TF_DISPATCH_SLOTS];      // Frame chờ xử lý | Frames waiting for dispatch
+    uint32_t end[TF_DISPATCH_SLOTS];    // data_head sau payload của mỗi frame | data_head after each frame's payload
+    uint8_t data[TF_DISPATCH_DATA_LEN]; // Bản sao payload | Payload copies
+    uint32_t tail;                      // Số frame đã xử lý | Nr of frames handled
+    uint32_t data_tail;                 // Số byte payload đã giải phóng | Nr of payload bytes released
+#if TF_DISPATCH_LANES > 1
+    uint32_t busy;                      // 1 khi một worker đang giữ lane | 1 while a worker holds the lane
+#endif
+};
+#endif
+
+#if TF_USE_STREAM_RX
+// Struct cho Stream listener
+// Struct for Stream listener
+struct TF_StreamListener_
+{
+    TF_TYPE type;            // Loại frame | Frame type
+    TF_StreamChunk fn_chunk; // Callback cho từng phần payload | Payload chunk callback
+    TF_StreamEnd fn_end;     // Callback kết thúc frame | End-of-frame callback
+    uint8_t pins;            // Số callback của listener đang chạy, slot không bị dùng lại khi > 0 | Nr of its callbacks running, the slot is not reused while > 0
+    TF_COUNT next;           // Slot tiếp theo theo thứ tự đăng ký (hoặc danh sách trống) + 1, 0 = hết | Next slot in registration order (or the free list) + 1, 0 = end
 };
+#endif
 
 /**
  * Trạng thái nội bộ của frame parser.
@@ -515,22 +1112,44 @@ struct TinyFrame_
     /* Trạng thái riêng | Own state */
     TF_Peer peer_bit; //!< Bit peer riêng (duy nhất để tránh xung đột ID msg) | Own peer bit (unique to avoid msg ID clash)
     TF_ID next_id;    //!< ID frame / chuỗi frame tiếp theo | Next frame / frame chain ID
+    void (*dealloc)(void *ptr); //!< Hàm giải phóng cho TF_DeInit(), NULL = free() | Deallocator for TF_DeInit(), NULL = free()
 
     /* Trạng thái parser | Parser state */
     enum TF_State_ state;            // Trạng thái hiện tại của state machine | Current state machine state
-    TF_TICKS parser_timeout_ticks;   // Tick timeout cho parser | Parser timeout ticks
+    TF_TICKS parser_timeout_ticks;   // Tick timeout cho parser (TF_USE_CLOCK: thời điểm nhận byte cuối, TF_USE_DISPATCH_QUEUE: tick_count khi nhận byte cuối) | Parser timeout ticks (TF_USE_CLOCK: time of the last received bytes, TF_USE_DISPATCH_QUEUE: tick_count at the last received bytes)
     TF_ID id;                        //!< ID gói tin đến | Incoming packet ID
     TF_LEN len;                      //!< Độ dài payload | Payload length
+#if TF_USE_EXTERNAL_BUFFERS
+    uint8_t *data;                   //!< Buffer byte dữ liệu | Data byte buffer
+    uint32_t data_size;              //!< Kích thước buffer dữ liệu | Data buffer size
+#else
     uint8_t data[TF_MAX_PAYLOAD_RX]; //!< Buffer byte dữ liệu | Data byte buffer
+#endif
+#if TF_USE_ZERO_COPY_RX
+    const uint8_t *payload;          //!< Payload giao cho listener - tf->data hoặc buffer của TF_Accept() | Payload handed to listeners - tf->data or the TF_Accept() buffer
+#endif
     TF_LEN rxi;                      //!< Bộ đếm byte kích thước trường | Field size byte counter
     TF_CKSUM cksum;                  //!< Checksum được tính của luồng dữ liệu | Checksum calculated of the data stream
     TF_CKSUM ref_cksum;              //!< Checksum tham chiếu đọc từ thông điệp | Reference checksum read from the message
     TF_TYPE type;                    //!< Số loại thông điệp được thu thập | Collected message type number
+#if TF_USE_HEAD_LOOKBACK && TF_CKSUM_TYPE != TF_CKSUM_NONE
+    uint8_t lookback[TF_ID_BYTES + TF_LEN_BYTES + TF_TYPE_BYTES + sizeof(TF_CKSUM)]; //!< Các byte header đã nhận | Received header bytes
+    uint8_t lookback_len;            //!< Số byte trong lookback | Nr of bytes in lookback
+#endif
     bool discard_data;               //!< Đặt nếu (len > TF_MAX_PAYLOAD) để đọc frame nhưng bỏ qua dữ liệu | Set if (len > TF_MAX_PAYLOAD) to read the frame, but ignore the data.
+#if TF_USE_STREAM_RX
+    struct TF_StreamListener_ *stream; //!< Stream listener nhận frame hiện tại | Stream listener receiving the current frame
+    TF_LEN stream_fill;                //!< Số byte trong data chưa giao cho stream listener | Nr of bytes in data not yet passed to the stream listener
+#endif
 
     /* Trạng thái Tx | Tx state */
     // Buffer để xây dựng frame | Buffer for building frames
+#if TF_USE_EXTERNAL_BUFFERS
+    uint8_t *sendbuf;                //!< Buffer tạm thời truyền | Transmit temporary buffer
+    uint32_t sendbuf_size;           //!< Kích thước buffer truyền | Transmit buffer size
+#else
     uint8_t sendbuf[TF_SENDBUF_LEN]; //!< Buffer tạm thời truyền | Transmit temporary buffer
+#endif
 
     uint32_t tx_pos;   //!< Vị trí ghi tiếp theo trong buffer Tx (dùng cho multipart) | Next write position in the Tx buffer (used for multipart)
     uint32_t tx_len;   //!< Tổng độ dài Tx dự kiến | Total expected Tx length
@@ -543,19 +1162,90 @@ struct TinyFrame_
     /* --- Callbacks --- */
 
     /* Callback giao dịch | Transaction callbacks */
+#if TF_USE_EXTERNAL_LISTENERS
+    struct TF_IdListener_ *id_listeners;                           // Mảng ID listeners
+    TF_COUNT max_id_lst;                                           // Số slot của mảng | Nr of slots in the array
+#else
     struct TF_IdListener_ id_listeners[TF_MAX_ID_LST];            // Mảng ID listeners
+#endif
+#if TF_USE_EXTERNAL_LISTENERS
+    TF_COUNT *id_index;                                            // Slot đầu tiên của mỗi bucket + 1 | First slot of each bucket + 1
+    uint32_t id_mask;                                              // Số bucket - 1 | Nr of buckets - 1
+#else
+    TF_COUNT id_index[TF_ID_BUCKETS];                              // Slot đầu tiên của mỗi bucket + 1 | First slot of each bucket + 1
+#endif
+    TF_COUNT id_free;                                              // Slot trống đầu tiên + 1 (các slot >= count_id_lst cũng trống) | First free slot + 1 (slots >= count_id_lst are free too)
+    TF_COUNT timer_wheel[TF_TIMER_SLOTS];                          // ID listener đầu tiên trong mỗi ô timing wheel + 1 | First ID listener in each timing wheel slot + 1
+    TF_COUNT timer_due;                                            // ID listener đầu tiên TF_Tick() đang kiểm tra + 1 | First ID listener being checked by TF_Tick() + 1
+    TF_COUNT timer_count;                                          // Số ID listener có timeout | Nr of ID listeners with a timeout
+    TF_TICKS timer_now;                                            // Số lần gọi TF_Tick() (TF_USE_CLOCK: thời điểm lần gọi cuối) | TF_Tick() call count (TF_USE_CLOCK: time of the last call)
+#if TF_USE_EXTERNAL_LISTENERS
+    struct TF_TypeListener_ *type_listeners;                       // Mảng Type listeners
+    TF_COUNT max_type_lst;                                         // Số slot của mảng | Nr of slots in the array
+#else
     struct TF_TypeListener_ type_listeners[TF_MAX_TYPE_LST];      // Mảng Type listeners
+#endif
+#if TF_USE_EXTERNAL_LISTENERS && TF_TYPE_BYTES > 1
+    TF_COUNT *type_index;                                          // Slot đầu tiên của mỗi bucket + 1, theo thứ tự đăng ký | First slot of each bucket + 1, chained in registration order
+    uint32_t type_mask;                                            // Số bucket - 1 | Nr of buckets - 1
+#else
+    TF_COUNT type_index[TF_TYPE_BUCKETS];                          // Slot đầu tiên của mỗi bucket + 1, theo thứ tự đăng ký | First slot of each bucket + 1, chained in registration order
+#endif
+    TF_COUNT type_free;                                            // Slot trống đầu tiên + 1 | First free slot + 1
+#if TF_USE_EXTERNAL_LISTENERS
+    struct TF_GenericListener_ *generic_listeners;                 // Mảng Generic listeners
+    TF_COUNT max_generic_lst;                                      // Số slot của mảng | Nr of slots in the array
+#else
     struct TF_GenericListener_ generic_listeners[TF_MAX_GEN_LST]; // Mảng Generic listeners
+#endif
+    TF_COUNT generic_head;                                         // Generic listener đầu tiên + 1 | First Generic listener + 1
+    TF_COUNT generic_free;                                         // Slot trống đầu tiên + 1 | First free slot + 1
+#if TF_USE_RANGE_LST
+    struct TF_RangeListener_ range_listeners[TF_MAX_RANGE_LST];   // Mảng Range / Mask listeners
+    TF_COUNT range_head;                                           // Range listener đầu tiên + 1 | First Range listener + 1
+    TF_COUNT range_free;                                           // Slot trống đầu tiên + 1 | First free slot + 1
+    TF_COUNT range_index[256];                                     // Theo byte thấp của type: range listener đầu tiên có thể khớp + 1 | By the low type byte: first range listener that may match + 1
+#endif
+#if TF_USE_STREAM_RX
+    struct TF_StreamListener_ stream_listeners[TF_MAX_STREAM_LST]; // Mảng Stream listeners
+    TF_COUNT stream_head;                                          // Stream listener đầu tiên + 1 | First Stream listener + 1
+    TF_COUNT stream_free;                                          // Slot trống đầu tiên + 1 | First free slot + 1
+#endif
+
+    // Số slot đã từng cấp phát. Các slot từ đây trở đi chưa dùng, slot đã giải phóng nằm trong danh sách trống,
+    // nên việc thêm listener là O(1) và không có gì phải quét đến mốc cao nhất này.
+    // Nr of slots handed out so far. Slots from here on are unused, freed slots are kept on the free lists,
+    // so adding a listener is O(1) and nothing has to scan up to this high-water mark.
+    TF_COUNT count_id_lst;      // Số slot ID listener đã từng dùng | Nr of ID listener slots handed out so far
+    TF_COUNT count_type_lst;    // Số slot Type listener đã từng dùng | Nr of Type listener slots handed out so far
+    TF_COUNT count_generic_lst; // Số slot Generic listener đã từng dùng | Nr of Generic listener slots handed out so far
+#if TF_USE_RANGE_LST
+    TF_COUNT count_range_lst;   // Số slot Range listener đã từng dùng | Nr of Range listener slots handed out so far
+#endif
+#if TF_USE_STREAM_RX
+    TF_COUNT count_stream_lst;  // Số slot Stream listener đã từng dùng | Nr of Stream listener slots handed out so far
+#endif
+
+#if TF_USE_BATCH
+    /* Batch listener */
+    TF_BatchListener batch_fn;              // Callback
+    TF_Msg batch[TF_MAX_BATCH];             // Thông điệp chờ giao | Messages waiting for delivery
+    uint32_t batch_count;                   // Số thông điệp trong batch | Nr of messages in the batch
+    uint32_t batch_fill;                    // Số byte đã dùng trong batch_data | Nr of bytes used in batch_data
+    uint8_t batch_data[TF_BATCH_DATA_LEN];  // Bản sao payload không giao được trực tiếp | Copies of payloads that cannot be delivered in place
+#endif
 
-    // Các bộ đếm này được sử dụng để tối ưu hóa thời gian tra cứu.
-    // Chúng trỏ đến số slot được sử dụng cao nhất,
-    // hoặc gần với nó, tùy thuộc vào thứ tự xóa.
-    // Those counters are used to optimize look-up times.
-    // They point to the highest used slot number,
-    // or close to it, depending on the removal order.
-    TF_COUNT count_id_lst;      // Số lượng ID listeners | Count of ID listeners
-    TF_COUNT count_type_lst;    // Số lượng Type listeners | Count of Type listeners
-    TF_COUNT count_generic_lst; // Số lượng Generic listeners | Count of Generic listeners
+#if TF_USE_DISPATCH_QUEUE
+    /* Hàng đợi dispatch | Dispatch queue */
+    uint32_t dispatch_dropped;                            // Số frame bị bỏ vì lane đầy (chỉ parser ghi) | Nr of frames dropped because a lane was full (written by the parser only)
+    struct TF_DispatchLane_ dispatch[TF_DISPATCH_LANES];  // Các lane | Lanes
+#if TF_DISPATCH_LANES > 1
+    uint32_t dispatch_next;                               // Lane để lần gọi TF_Dispatch() tiếp theo bắt đầu | Lane the next TF_Dispatch() call starts at
+#endif
+#if !TF_USE_CLOCK
+    TF_TICKS tick_count;                                  // Số lần gọi TF_Tick(), parser đọc để tính timeout | TF_Tick() call count, read by the parser for its timeout
+#endif
+#endif
 };
 
 // ------------------------ CẦN ĐƯỢC IMPLEMENT BỞI NGƯỜI DÙNG | TO BE IMPLEMENTED BY USER ------------------------
@@ -569,6 +1259,22 @@ struct TinyFrame_
  */
 extern void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len);
 
+#if TF_USE_CLOCK
+/**
+ * Đọc đồng hồ đơn điệu, dùng với TF_USE_CLOCK.
+ * Read the monotonic clock, used with TF_USE_CLOCK.
+ *
+ * Đơn vị tùy ý (ví dụ ms), giống với các timeout truyền cho TinyFrame. Giá trị được
+ * phép tràn vòng trong phạm vi của TF_TICKS.
+ * Any unit (e.g. ms), the same as the timeouts passed to TinyFrame. The value may
+ * wrap around within the range of TF_TICKS.
+ *
+ * ! Implement hàm này trong mã ứng dụng của bạn !
+ * ! Implement this in your application code !
+ */
+extern TF_TICKS TF_GetTime(TinyFrame *tf);
+#endif
+
 // Các hàm Mutex | Mutex functions
 #if TF_USE_MUTEX
 
@@ -586,6 +1292,24 @@ extern void TF_ReleaseTx(TinyFrame *tf);
 
 #endif
 
+#if TF_USE_DISPATCH_QUEUE && TF_DISPATCH_LANES > 1
+
+/**
+ * Khóa bảng listener cho các worker của TF_Dispatch(). Phải là khóa đệ quy (recursive):
+ * ID listener chạy trong khóa và có thể gọi TF_Query() hay thêm / xóa listener.
+ * Lock the listener tables for the TF_Dispatch() workers. Must be a recursive lock:
+ * ID listeners run inside it and may call TF_Query() or add / remove listeners.
+ */
+extern void TF_LockListeners(TinyFrame *tf);
+
+/**
+ * Mở khóa bảng listener
+ * Unlock the listener tables
+ */
+extern void TF_UnlockListeners(TinyFrame *tf);
+
+#endif
+
 // Các hàm checksum tùy chỉnh | Custom checksum functions
 #if (TF_CKSUM_TYPE == TF_CKSUM_CUSTOM8) || (TF_CKSUM_TYPE == TF_CKSUM_CUSTOM16) || (TF_CKSUM_TYPE == TF_CKSUM_CUSTOM32)
 
@@ -616,6 +1340,31 @@ extern TF_CKSUM TF_CksumAdd(TF_CKSUM cksum, uint8_t byte);
  */
 extern TF_CKSUM TF_CksumEnd(TF_CKSUM cksum);
 
+#if TF_CKSUM_CUSTOM_BLOCK
+/**
+ * Cập nhật checksum với một khối byte, dùng với TF_CKSUM_CUSTOM_BLOCK.
+ * Update a checksum with a block of bytes, used with TF_CKSUM_CUSTOM_BLOCK.
+ * Kết quả phải giống như gọi TF_CksumAdd() cho từng byte.
+ * The result must be the same as calling TF_CksumAdd() for each byte.
+ *
+ * @param cksum - giá trị checksum trước đó | previous checksum value
+ * @param buf - các byte để thêm | bytes to add
+ * @param len - số byte | nr of bytes
+ * @return giá trị checksum đã cập nhật | updated checksum value
+ */
+extern TF_CKSUM TF_CksumAddBlock(TF_CKSUM cksum, const uint8_t *buf, uint32_t len);
+#endif
+
+#endif
+
+// Bỏ tên có prefix và cấu hình để có thể include instance tiếp theo (TinyFrame.c giữ lại chúng)
+// Drop the prefixed names and the config so the next instance can be included (TinyFrame.c keeps them)
+#if defined(TF_PREFIX) && !defined(TF_KEEP_PREFIX)
+#define TF_PREFIX_UNDEF
+#include "TF_Prefix.h"
+#undef TF_PREFIX_UNDEF
+#undef TF_PREFIX
+#undef TF_CONFIG_HEADER
 #endif
 
 #endif
@@ -0,0 +1,30 @@
+#ifndef TF_CONFIG_H
+#define TF_CONFIG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define TF_ID_BYTES     1
+#define TF_LEN_BYTES    2
+#define TF_TYPE_BYTES   1
+#define TF_CKSUM_TYPE TF_CKSUM_CRC16
+#define TF_USE_SOF_BYTE 1
+#define TF_SOF_BYTE     0x01
+typedef uint16_t TF_TICKS;
+typedef uint8_t TF_COUNT;
+#define TF_MAX_PAYLOAD_RX 96
+#define TF_SENDBUF_LEN 128
+#define TF_MAX_ID_LST   4
+#define TF_MAX_TYPE_LST 4
+#define TF_MAX_GEN_LST  2
+#define TF_PARSER_TIMEOUT_TICKS 10
+
+// a small queue and copy buffer, so they fill up within one TF_Accept() call;
+// payloads up to TF_MAX_PAYLOAD_RX don't all fit in the copy buffer
+#define TF_USE_BATCH 1
+#define TF_MAX_BATCH 8
+#define TF_BATCH_DATA_LEN 64
+
+#define TF_Error(format, ...) printf("[TF] " format "\n", ##__VA_ARGS__)
+
+#endif //TF_CONFIG_H
@@ -0,0 +1,270 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+
+// Feeds many small frames to a batch listener and checks every delivered message against
+// the frames sent: order, type, length and payload bytes. The frames are fed in one
+// TF_Accept() call (payloads delivered in place from the caller's buffer), in random pieces
+// mixing TF_Accept() and TF_AcceptChar() (payloads split over two pieces are copied), and byte
+// by byte. The pieces are overwritten after each call, so a message still queued then reads
+// garbage. Each batch must hold at most TF_MAX_BATCH messages and TF_BATCH_DATA_LEN bytes of
+// copies, a batch delivered before the end of the call must have been full (or the next
+// payload must not have fit next to its copies), and all frames received by a call must be
+// delivered before it returns. test_copy.bin is built without TF_USE_ZERO_COPY_RX, all
+// payloads are copied there and the copy buffer fills up.
+
+#define ROUNDS 3000
+#define MAX_FRAMES 64
+#define MAX_FRAME (1 + 4 + 2 + TF_MAX_PAYLOAD_RX + 2) // SOF, header, payload, CRC16
+
+/** How the bytes are fed to the parser */
+enum
+{
+    FEED_BULK,  // one TF_Accept()
+    FEED_MIXED, // random pieces, each with TF_Accept() or byte by byte
+    FEED_CHAR,  // TF_AcceptChar() for every byte
+    FEED_COUNT
+};
+
+static const char *feed_names[FEED_COUNT] = {"bulk", "mixed", "char"};
+
+/** A frame as sent */
+typedef struct
+{
+    TF_TYPE type;
+    TF_LEN len;
+    uint8_t data[TF_MAX_PAYLOAD_RX];
+    uint32_t end; // offset in `wire` after its last byte
+} Frame;
+
+static Frame frames[MAX_FRAMES];
+static int nframes;
+static uint8_t wire[MAX_FRAMES * MAX_FRAME];
+static uint32_t wire_len;
+
+// the buffer passed to the current TF_Accept() call
+static uint8_t piece[MAX_FRAMES * MAX_FRAME];
+static uint32_t piece_len;
+
+/** Batches delivered during the current TF_Accept() / TF_AcceptChar() call */
+static struct
+{
+    int next;        // next expected frame
+    bool have_prev;  // a batch was delivered earlier in this call
+    uint32_t count;  // its nr of messages
+    uint32_t fill;   // its bytes of copied payloads
+    bool single;     // it was a payload too long to copy, delivered on its own
+    bool bad;
+} rx;
+
+static long batches, full_flushes, copy_flushes, singles, in_place, copied;
+
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    memcpy(wire + wire_len, buff, len);
+    wire_len += len;
+}
+
+/** The payload is in the buffer of the current TF_Accept() call */
+static bool inPiece(const TF_Msg *msg)
+{
+    return msg->data >= piece && msg->data + msg->len <= piece + piece_len;
+}
+
+static void batchListener(TinyFrame *tf, TF_Msg *msgs, uint32_t count)
+{
+    uint32_t i, fill = 0;
+    bool copy, first_copy = false, single;
+    const Frame *f;
+
+    if (count == 0 || count > TF_MAX_BATCH)
+    {
+        printf("batch of %u messages\n", (unsigned)count);
+        rx.bad = true;
+        return;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (rx.next == nframes)
+        {
+            printf("more messages than frames sent\n");
+            rx.bad = true;
+            return;
+        }
+        f = &frames[rx.next];
+        if (msgs[i].type != f->type || msgs[i].len != f->len || (f->len > 0 && memcmp(msgs[i].data, f->data, f->len) != 0))
+        {
+            printf("message %u of %u: expected frame %d (type %d, %d bytes), got type %d, %d bytes%s\n",
+                   (unsigned)i, (unsigned)count, rx.next, f->type, f->len, msgs[i].type, msgs[i].len,
+                   msgs[i].type == f->type && msgs[i].len == f->len ? " with other data" : "");
+            rx.bad = true;
+            return;
+        }
+        rx.next++;
+
+        copy = msgs[i].len > 0 && !inPiece(&msgs[i]);
+        if (copy) fill += msgs[i].len;
+        if (i == 0) first_copy = copy;
+        if (msgs[i].len > 0) copy ? copied++ : in_place++;
+    }
+
+    single = count == 1 && first_copy && msgs[0].len > TF_BATCH_DATA_LEN;
+    if (!single && fill > TF_BATCH_DATA_LEN)
+    {
+        printf("batch of %u messages with %u bytes of copies\n", (unsigned)count, (unsigned)fill);
+        rx.bad = true;
+    }
+
+    // The batch before this one was flushed before the end of the call - it had to be
+    if (rx.have_prev)
+    {
+        if (rx.count == TF_MAX_BATCH)
+            full_flushes++;
+        else if (first_copy && msgs[0].len > TF_BATCH_DATA_LEN - rx.fill)
+            copy_flushes++;
+        else if (!rx.single)
+        {
+            printf("batch of %u messages, %u bytes of copies flushed early\n", (unsigned)rx.count, (unsigned)rx.fill);
+            rx.bad = true;
+        }
+    }
+
+    rx.have_prev = true;
+    rx.count = count;
+    rx.fill = fill;
+    rx.single = single;
+    if (single) singles++;
+    batches++;
+}
+
+/** Build a round of frames in `wire` */
+static void buildFrames(TinyFrame *tx)
+{
+    TF_Msg msg;
+    Frame *f;
+    int k;
+    uint32_t i;
+
+    nframes = 1 + rand() % MAX_FRAMES;
+    wire_len = 0;
+    for (k = 0; k < nframes; k++)
+    {
+        f = &frames[k];
+        f->type = (TF_TYPE)rand();
+        // mostly short frames, some too long for the copy buffer
+        f->len = (TF_LEN)((rand() & 7) ? rand() % 24 : rand() % (TF_MAX_PAYLOAD_RX + 1));
+        for (i = 0; i < f->len; i++) f->data[i] = (uint8_t)rand();
+
+        TF_ClearMsg(&msg);
+        msg.type = f->type;
+        msg.data = f->data;
+        msg.len = f->len;
+        TF_Send(tx, &msg);
+        f->end = wire_len;
+    }
+}
+
+/** After a call that fed the bytes up to `fed`: all frames received so far were delivered */
+static bool checkDelivered(uint32_t fed)
+{
+    int done = 0;
+    while (done < nframes && frames[done].end <= fed) done++;
+    rx.have_prev = false;
+    if (rx.bad) return false;
+    if (rx.next != done)
+    {
+        printf("%d of %d frames received after %u bytes, %d delivered\n", done, nframes, (unsigned)fed, rx.next);
+        return false;
+    }
+    return true;
+}
+
+/** Pass `n` bytes from `wire` in a buffer that is overwritten after the call */
+static bool acceptPiece(TinyFrame *tf, uint32_t from, uint32_t n)
+{
+    memcpy(piece, wire + from, n);
+    piece_len = n;
+    TF_Accept(tf, piece, n);
+    memset(piece, 0xA5, n);
+    piece_len = 0;
+    return checkDelivered(from + n);
+}
+
+static bool feed(TinyFrame *tf, int mode)
+{
+    uint32_t i = 0, n;
+
+    switch (mode)
+    {
+    case FEED_BULK:
+        return acceptPiece(tf, 0, wire_len);
+    case FEED_MIXED:
+        while (i < wire_len)
+        {
+            n = 1 + (uint32_t)rand() % 200;
+            if (n > wire_len - i) n = wire_len - i;
+            if (rand() & 1)
+            {
+                if (!acceptPiece(tf, i, n)) return false;
+                i += n;
+            }
+            else
+            {
+                while (n--)
+                {
+                    TF_AcceptChar(tf, wire[i++]);
+                    if (!checkDelivered(i)) return false;
+                }
+            }
+        }
+        return true;
+    default:
+        for (i = 0; i < wire_len; i++)
+        {
+            TF_AcceptChar(tf, wire[i]);
+            if (!checkDelivered(i + 1)) return false;
+        }
+        return true;
+    }
+}
+
+int main(void)
+{
+    TinyFrame *tx, *tf;
+    int round, mode = 0;
+    bool bad = false;
+
+    srand(1);
+    printf("------ batch%s --------\n", TF_USE_ZERO_COPY_RX ? "" : ", no TF_USE_ZERO_COPY_RX");
+    tx = TF_Init(TF_MASTER);
+    tf = TF_Init(TF_SLAVE);
+    TF_SetBatchListener(tf, batchListener);
+
+    for (round = 0; round < ROUNDS; round++)
+    {
+        mode = round % FEED_COUNT;
+        buildFrames(tx);
+        rx.next = 0;
+        if (!feed(tf, mode) || rx.next != nframes)
+        {
+            printf("%s, round %d: %d of %d frames delivered\n", feed_names[mode], round, rx.next, nframes);
+            bad = true;
+            break;
+        }
+    }
+
+    TF_DeInit(tf);
+    TF_DeInit(tx);
+    printf("%ld batches: %ld flushed full, %ld with the copy buffer full, %ld too long to copy\n",
+           batches, full_flushes, copy_flushes, singles);
+    printf("%ld payloads in place, %ld copied\n", in_place, copied);
+    if (full_flushes == 0 || singles == 0 || copied == 0 || (TF_USE_ZERO_COPY_RX ? in_place == 0 : copy_flushes == 0))
+    {
+        printf("not all cases covered\n");
+        bad = true;
+    }
+    printf("%s\n", bad ? "FAILED" : "OK - all messages delivered in order and intact");
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../TinyFrame.c"
+
+// Compares the block checksum (TF_Cksum) and the byte-by-byte one with a plain reference
+// implementation, for all offsets and many lengths, on random data and on all-0xFF data
+// (the worst case for the unreduced lane sums of Fletcher / Adler). TF_CksumCombine() is
+// checked at every split point.
+
+#if TF_CKSUM_TYPE == TF_CKSUM_CRC16
+#define CKSUM_NAME "CRC16"
+#define CRC_REF_POLY 0xA001u
+#define CRC_REF_INIT 0u
+#define CHECK_STR "123456789"
+#define CHECK_VALUE 0xBB3Du
+#elif TF_CKSUM_TYPE == TF_CKSUM_CRC32
+#define CKSUM_NAME "CRC32"
+#define CRC_REF_POLY 0xEDB88320u
+#define CRC_REF_INIT 0xFFFFFFFFu
+#define CHECK_STR "123456789"
+#define CHECK_VALUE 0xCBF43926u
+#elif TF_CKSUM_TYPE == TF_CKSUM_CRC32C
+#define CKSUM_NAME "CRC32C"
+#define CRC_REF_POLY 0x82F63B78u
+#define CRC_REF_INIT 0xFFFFFFFFu
+#define CHECK_STR "123456789"
+#define CHECK_VALUE 0xE3069283u
+#elif TF_CKSUM_TYPE == TF_CKSUM_FLETCHER16
+#define CKSUM_NAME "Fletcher-16"
+#define CHECK_STR "abcde"
+#define CHECK_VALUE 0xC8F0u
+
+static uint32_t cksum_ref(const uint8_t *buf, uint32_t len)
+{
+    uint32_t a = 0, b = 0;
+    while (len--)
+    {
+        a = (a + *buf++) % 255;
+        b = (b + a) % 255;
+    }
+    return (b << 8) | a;
+}
+#elif TF_CKSUM_TYPE == TF_CKSUM_ADLER32
+#define CKSUM_NAME "Adler-32"
+#define CHECK_STR "Wikipedia"
+#define CHECK_VALUE 0x11E60398u
+
+static uint32_t cksum_ref(const uint8_t *buf, uint32_t len)
+{
+    uint32_t a = 1, b = 0;
+    while (len--)
+    {
+        a = (a + *buf++) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+#endif
+
+#ifdef CRC_REF_POLY
+/** Bit-by-bit reflected CRC, the pre- and post-inversion are the same value */
+static uint32_t cksum_ref(const uint8_t *buf, uint32_t len)
+{
+    uint32_t c = CRC_REF_INIT;
+    while (len--)
+    {
+        c ^= *buf++;
+        for (int k = 0; k < 8; k++)
+        {
+            c = (c & 1) ? (c >> 1) ^ CRC_REF_POLY : c >> 1;
+        }
+    }
+    return c ^ CRC_REF_INIT;
+}
+#endif
+
+static uint32_t cksum_bytes(const uint8_t *buf, uint32_t len)
+{
+    TF_CKSUM c = TF_CksumStart();
+    while (len--)
+    {
+        c = TF_CksumAdd(c, *buf++);
+    }
+    return TF_CksumEnd(c);
+}
+
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    (void)tf;
+    (void)buff;
+    (void)len;
+}
+
+static uint8_t buf[70000 + 8];
+
+static int check_buffer(const char *what)
+{
+    static const uint32_t big[] = {4095, 4096, 4097, 4111, 8192, 12345, 65535, 70000};
+    int bad = 0;
+
+    for (uint32_t off = 0; off < 8; off++)
+    {
+        for (uint32_t len = 0; len <= 300; len++)
+        {
+            uint32_t ref = cksum_ref(buf + off, len);
+            if (TF_Cksum(buf + off, len) != ref || cksum_bytes(buf + off, len) != ref)
+            {
+                printf("%s: mismatch at offset %u, len %u\n", what, off, len);
+                bad++;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < sizeof(big) / sizeof(big[0]); i++)
+    {
+        if (TF_Cksum(buf + 3, big[i]) != cksum_ref(buf + 3, big[i]))
+        {
+            printf("%s: mismatch at len %u\n", what, big[i]);
+            bad++;
+        }
+    }
+    return bad;
+}
+
+/** Checksum of the two halves combined must equal the checksum of the whole, at every split point */
+static int check_combine(const char *what, const uint8_t *data, uint32_t len, uint32_t step)
+{
+    TF_CKSUM whole = TF_Cksum(data, len);
+    int bad = 0;
+
+    for (uint32_t split = 0; split <= len; split += step)
+    {
+        TF_CKSUM c = TF_CksumCombine(TF_Cksum(data, split), TF_Cksum(data + split, len - split), len - split);
+        if (c != whole)
+        {
+            printf("%s: combine mismatch, len %u split at %u\n", what, len, split);
+            bad++;
+        }
+    }
+    return bad;
+}
+
+int main(void)
+{
+    int bad = 0;
+    uint32_t check = TF_Cksum((const uint8_t *)CHECK_STR, (uint32_t)strlen(CHECK_STR));
+
+    printf("------ %s --------\n", CKSUM_NAME);
+    printf("check value of \"%s\": 0x%08X (expect 0x%08X)\n", CHECK_STR, check, CHECK_VALUE);
+    if (check != CHECK_VALUE)
+    {
+        bad++;
+    }
+
+    srand(1);
+    for (uint32_t i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = (uint8_t)rand();
+    }
+    bad += check_buffer("random");
+    for (uint32_t len = 0; len <= 64; len++)
+    {
+        bad += check_combine("random", buf + 1, len, 1);
+    }
+    bad += check_combine("random", buf + 1, 1000, 1);
+    bad += check_combine("random", buf + 1, 70000, 997);
+
+    memset(buf, 0xFF, sizeof(buf));
+    bad += check_buffer("0xFF");
+    bad += check_combine("0xFF", buf, 1000, 1);
+
+    printf("%s\n", bad ? "FAILED" : "OK - all lengths, offsets and split points match");
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,31 @@
+#ifndef TF_CONFIG_H
+#define TF_CONFIG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define TF_ID_BYTES     2
+#define TF_LEN_BYTES    2
+#define TF_TYPE_BYTES   1
+#define TF_CKSUM_TYPE TF_CKSUM_CRC16
+#define TF_USE_SOF_BYTE 1
+#define TF_SOF_BYTE     0x01
+typedef uint32_t TF_TICKS;
+typedef uint8_t TF_COUNT;
+#define TF_MAX_PAYLOAD_RX 1024
+#define TF_SENDBUF_LEN 128
+#define TF_MAX_ID_LST   48
+#define TF_MAX_TYPE_LST 24
+#define TF_MAX_GEN_LST  2
+#define TF_PARSER_TIMEOUT_TICKS 10
+
+#define TF_USE_MUTEX 1
+#define TF_USE_DISPATCH_QUEUE 1
+#define TF_DISPATCH_SLOTS 16
+#define TF_DISPATCH_DATA_LEN 1024
+#define TF_DISPATCH_LANES 4
+
+// Query timeouts and full lanes are expected here, test.c counts them itself
+#define TF_Error(format, ...) do {} while (0)
+
+#endif //TF_CONFIG_H
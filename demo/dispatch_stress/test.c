@@ -0,0 +1,482 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "../../TinyFrame.h"
+
+// Stress test for the dispatch queue with several lanes (TF_DISPATCH_LANES > 1).
+//
+// Peer B sends typed frames with a per-type sequence number and answers A's queries
+// with several parts. A's receive thread feeds the bytes in random chunks, NR_WORKERS
+// threads sleep until it signals new frames and then call TF_Dispatch(). Meanwhile a
+// query thread runs TF_Query() / TF_Tick() and a churn thread keeps adding and removing
+// type listeners that share one callback, while their frames are being dispatched.
+//
+// Checked: frames of one type run one at a time and in order, the parts of a reply
+// arrive in order, every frame is delivered (or counted as dropped) once the workers are
+// idle - the receive thread stops to check that every QUIET_EVERY rounds - and a churn
+// listener disappears only when removed or closed by its own callback. No slot is lost.
+//
+// `make tsan` builds and runs the same test with -fsanitize=thread.
+
+#define NR_WORKERS 4
+#define NR_TYPES 8        // types 0x20..0x27, per-type sequence numbers
+#define NR_CHURN_TYPES 4  // types 0x40..0x43, listeners added / removed by the churn thread
+#define NR_FRAMES 20000   // frames sent by B, every 8th one to a churn type
+#define NR_QUERIES 2000
+#define NR_CHURN 5000     // add / remove rounds
+#define MAX_OUTSTANDING 32
+#define QUIET_EVERY 2     // receive rounds between checks that the idle workers left nothing queued
+
+#define TYPE_BASE 0x20
+#define CHURN_BASE 0x40
+#define QUERY_TYPE 0x10
+#define SPARE_TYPE 0x50
+
+#define ATOMIC_INC(x) __atomic_fetch_add(&(x), 1, __ATOMIC_SEQ_CST)
+#define ATOMIC_DEC(x) __atomic_fetch_sub(&(x), 1, __ATOMIC_SEQ_CST)
+#define ATOMIC_GET(x) __atomic_load_n(&(x), __ATOMIC_SEQ_CST)
+#define ATOMIC_SET(x, v) __atomic_store_n(&(x), (v), __ATOMIC_SEQ_CST)
+
+/** One side of the simulated wire - the bytes a peer wrote, and the locks of its instance */
+typedef struct
+{
+    pthread_mutex_t tx;   // TF_ClaimTx() / TF_ReleaseTx()
+    pthread_mutex_t lst;  // TF_LockListeners() / TF_UnlockListeners(), recursive
+    pthread_mutex_t wire; // guards buf / len
+    uint8_t *buf;
+    uint32_t len;
+    uint32_t cap;
+} Peer;
+
+/** A query in flight, passed as the ID listener userdata */
+typedef struct
+{
+    uint32_t qid;
+    uint8_t parts;
+    uint8_t next;
+} Query;
+
+static TinyFrame *tf_a, *tf_b;
+static Peer peer_a, peer_b;
+
+// worker wake-up
+static pthread_mutex_t ev_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ev_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t idle_cond = PTHREAD_COND_INITIALIZER;
+static uint32_t rx_events; // posted by the receive thread, each one wakes one worker
+static int idle_workers;
+static int stop_workers;
+static int stop_rx;
+
+// results
+static uint32_t last_seq[NR_TYPES];
+static int in_type[NR_TYPES];
+static uint32_t b_sent;     // frames sent by B
+static uint32_t a_frames;   // frames consumed by A's listeners
+static uint32_t type_bad, part_bad, churn_bad, stranded;
+static uint32_t churn_calls;
+static uint32_t churn_closed[NR_CHURN_TYPES]; // closed by the callback, per type
+static uint32_t issued, completed, timed_out, outstanding;
+
+static Peer *peer_of(TinyFrame *tf)
+{
+    return tf == tf_a ? &peer_a : &peer_b;
+}
+
+static uint32_t rd32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void wr32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+bool TF_ClaimTx(TinyFrame *tf)
+{
+    pthread_mutex_lock(&peer_of(tf)->tx);
+    return true;
+}
+
+void TF_ReleaseTx(TinyFrame *tf)
+{
+    pthread_mutex_unlock(&peer_of(tf)->tx);
+}
+
+void TF_LockListeners(TinyFrame *tf)
+{
+    pthread_mutex_lock(&peer_of(tf)->lst);
+}
+
+void TF_UnlockListeners(TinyFrame *tf)
+{
+    pthread_mutex_unlock(&peer_of(tf)->lst);
+}
+
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    Peer *p = peer_of(tf);
+    pthread_mutex_lock(&p->wire);
+    if (p->len + len > p->cap)
+    {
+        p->cap = (p->len + len) * 2;
+        p->buf = realloc(p->buf, p->cap);
+    }
+    memcpy(p->buf + p->len, buff, len);
+    p->len += len;
+    pthread_mutex_unlock(&p->wire);
+}
+
+/** Wake one of A's workers */
+static void postEvent(void)
+{
+    pthread_mutex_lock(&ev_mutex);
+    rx_events++;
+    pthread_cond_signal(&ev_cond);
+    pthread_mutex_unlock(&ev_mutex);
+}
+
+/** Wait until every event is taken and the workers are asleep, true if A has no frames left queued */
+static bool waitQuiet(void)
+{
+    bool quiet;
+    pthread_mutex_lock(&ev_mutex);
+    while (rx_events != 0 || idle_workers < NR_WORKERS)
+    {
+        pthread_cond_wait(&idle_cond, &ev_mutex);
+    }
+    quiet = ATOMIC_GET(a_frames) + tf_a->dispatch_dropped == ATOMIC_GET(b_sent);
+    pthread_mutex_unlock(&ev_mutex);
+    return quiet;
+}
+
+/** Pass everything peer `from` wrote to `tf` in random chunks, returns the nr of bytes */
+static uint32_t feed(TinyFrame *tf, Peer *from, unsigned *seed)
+{
+    uint8_t *buf;
+    uint32_t len, pos, chunk;
+
+    pthread_mutex_lock(&from->wire);
+    len = from->len;
+    buf = malloc(len + 1);
+    memcpy(buf, from->buf, len);
+    from->len = 0;
+    pthread_mutex_unlock(&from->wire);
+
+    for (pos = 0; pos < len; pos += chunk)
+    {
+        chunk = 1 + rand_r(seed) % 300;
+        if (chunk > len - pos) chunk = len - pos;
+        TF_Accept(tf, buf + pos, chunk);
+        if (tf == tf_a) postEvent();
+    }
+    free(buf);
+    return len;
+}
+
+/** A: typed frames - one at a time per type, sequence numbers increasing (drops leave gaps) */
+static TF_Result typeListener(TinyFrame *tf, TF_Msg *msg)
+{
+    int t = msg->type - TYPE_BASE;
+    uint32_t seq = rd32(msg->data);
+    volatile int spin;
+
+    if (ATOMIC_INC(in_type[t]) != 0) ATOMIC_INC(type_bad);
+    if (seq <= last_seq[t]) ATOMIC_INC(type_bad);
+    last_seq[t] = seq;
+    for (spin = 0; spin < 2000; spin++); // some decoding work
+    sched_yield(); // let the other threads in while the lane is held, even on one core
+    ATOMIC_DEC(in_type[t]);
+    ATOMIC_INC(a_frames);
+    return TF_STAY;
+}
+
+/** A: shared by all the churn listeners, closes itself when asked, else passes the frame on */
+static TF_Result churnListener(TinyFrame *tf, TF_Msg *msg)
+{
+    volatile int spin;
+    for (spin = 0; spin < 500; spin++);
+    sched_yield();
+    ATOMIC_INC(churn_calls);
+    if (msg->data[0] != 0)
+    {
+        ATOMIC_INC(churn_closed[msg->type - CHURN_BASE]);
+        ATOMIC_INC(a_frames);
+        return TF_CLOSE;
+    }
+    return TF_NEXT;
+}
+
+/** A: churn frames and replies that came after their query timed out */
+static TF_Result genericListener(TinyFrame *tf, TF_Msg *msg)
+{
+    ATOMIC_INC(a_frames);
+    return TF_STAY;
+}
+
+/** A: parts of a reply, in order; data == NULL when the query timed out */
+static TF_Result replyListener(TinyFrame *tf, TF_Msg *msg)
+{
+    Query *q = msg->userdata;
+
+    if (msg->data == NULL)
+    {
+        free(q);
+        msg->userdata = NULL;
+        ATOMIC_INC(timed_out);
+        ATOMIC_DEC(outstanding);
+        return TF_CLOSE;
+    }
+
+    ATOMIC_INC(a_frames);
+    if (rd32(msg->data) != q->qid || msg->data[4] != q->next) ATOMIC_INC(part_bad);
+    q->next++;
+    if (q->next == q->parts)
+    {
+        free(q);
+        msg->userdata = NULL;
+        ATOMIC_INC(completed);
+        ATOMIC_DEC(outstanding);
+        return TF_CLOSE;
+    }
+    return TF_RENEW;
+}
+
+/** B: answer a query with the requested nr of parts */
+static TF_Result queryListener(TinyFrame *tf, TF_Msg *msg)
+{
+    uint8_t part[5];
+    TF_Msg resp;
+    uint8_t i;
+
+    for (i = 0; i < msg->data[4]; i++)
+    {
+        wr32(part, rd32(msg->data));
+        part[4] = i;
+        resp = *msg;
+        resp.data = part;
+        resp.len = 5;
+        if (TF_Respond(tf, &resp)) ATOMIC_INC(b_sent);
+    }
+    return TF_STAY;
+}
+
+/** Receives for both peers, B's listeners run here too */
+static void *rxThread(void *arg)
+{
+    unsigned seed = 9;
+    uint32_t seq[NR_TYPES] = {0};
+    uint32_t sent = 0, fed, round = 0;
+    uint8_t payload[8] = {0};
+    uint8_t close_flag;
+    int k, t;
+
+    while (true)
+    {
+        for (k = 0; k < 4 && sent < NR_FRAMES; k++, sent++)
+        {
+            if (sent % 8 == 7)
+            {
+                t = CHURN_BASE + rand_r(&seed) % NR_CHURN_TYPES;
+                close_flag = (uint8_t)(rand_r(&seed) % 2);
+                if (TF_SendSimple(tf_b, (TF_TYPE)t, &close_flag, 1)) ATOMIC_INC(b_sent);
+                continue;
+            }
+            t = rand_r(&seed) % NR_TYPES;
+            wr32(payload, ++seq[t]);
+            if (TF_SendSimple(tf_b, (TF_TYPE)(TYPE_BASE + t), payload, sizeof(payload))) ATOMIC_INC(b_sent);
+        }
+
+        // B only sends from this thread, so everything it sent so far is fed here.
+        // A frame left in a lane once the workers are idle would stay there until the next event.
+        fed = feed(tf_a, &peer_b, &seed);
+        if (fed != 0 && ++round % QUIET_EVERY == 0 && !waitQuiet()) stranded++;
+
+        fed += feed(tf_b, &peer_a, &seed);
+        TF_Dispatch(tf_b, 0);
+
+        if (fed == 0 && sent == NR_FRAMES && ATOMIC_GET(stop_rx)) break;
+        sched_yield();
+    }
+    return NULL;
+}
+
+/**
+ * Takes one event, like a worker pool on a semaphore, and makes one TF_Dispatch() call. A lane
+ * held by another worker is skipped, so that worker must take the frames queued meanwhile.
+ */
+static void *workerThread(void *arg)
+{
+    pthread_mutex_lock(&ev_mutex);
+    while (!stop_workers)
+    {
+        if (rx_events == 0)
+        {
+            idle_workers++;
+            pthread_cond_signal(&idle_cond);
+            pthread_cond_wait(&ev_cond, &ev_mutex);
+            idle_workers--;
+            continue;
+        }
+        rx_events--;
+        pthread_mutex_unlock(&ev_mutex);
+
+        TF_Dispatch(tf_a, 0);
+
+        pthread_mutex_lock(&ev_mutex);
+    }
+    pthread_mutex_unlock(&ev_mutex);
+    return NULL;
+}
+
+static void *queryThread(void *arg)
+{
+    unsigned seed = 5;
+    uint8_t payload[5];
+    uint32_t i;
+    Query *q;
+    TF_Msg msg;
+
+    for (i = 0; i < NR_QUERIES; i++)
+    {
+        while (ATOMIC_GET(outstanding) >= MAX_OUTSTANDING)
+        {
+            TF_Tick(tf_a);
+            sched_yield();
+        }
+
+        q = malloc(sizeof(Query));
+        q->qid = i;
+        q->parts = (uint8_t)(1 + rand_r(&seed) % 4);
+        q->next = 0;
+        wr32(payload, i);
+        payload[4] = q->parts;
+
+        TF_ClearMsg(&msg);
+        msg.type = QUERY_TYPE;
+        msg.data = payload;
+        msg.len = sizeof(payload);
+        msg.userdata = q;
+        ATOMIC_INC(outstanding);
+        if (!TF_Query(tf_a, &msg, replyListener, NULL, (TF_TICKS)(20 + rand_r(&seed) % 100)))
+        {
+            free(q);
+            ATOMIC_DEC(outstanding);
+            continue;
+        }
+        ATOMIC_INC(issued);
+        if (rand_r(&seed) % 4 == 0) TF_Tick(tf_a);
+    }
+
+    // let the rest complete or time out
+    while (ATOMIC_GET(outstanding) != 0)
+    {
+        TF_Tick(tf_a);
+        sched_yield();
+    }
+    return NULL;
+}
+
+/**
+ * Adds and removes type listeners with the same callback while their frames are dispatched.
+ * The type changes each round, so a freed slot is soon reused for another type. A remove may
+ * only fail when a callback of that type closed the listener in between.
+ */
+static void *churnThread(void *arg)
+{
+    uint32_t i, closed;
+    int t;
+
+    for (i = 0; i < NR_CHURN; i++)
+    {
+        t = i % NR_CHURN_TYPES;
+        closed = ATOMIC_GET(churn_closed[t]);
+        if (!TF_AddTypeListener(tf_a, (TF_TYPE)(CHURN_BASE + t), churnListener)) ATOMIC_INC(churn_bad);
+        sched_yield();
+        if (!TF_RemoveTypeListener(tf_a, (TF_TYPE)(CHURN_BASE + t)) && ATOMIC_GET(churn_closed[t]) == closed)
+        {
+            ATOMIC_INC(churn_bad);
+        }
+    }
+    return NULL;
+}
+
+static void initPeer(Peer *p)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&p->tx, NULL);
+    pthread_mutex_init(&p->lst, &attr);
+    pthread_mutex_init(&p->wire, NULL);
+    pthread_mutexattr_destroy(&attr);
+}
+
+int main(void)
+{
+    pthread_t workers[NR_WORKERS], rx, query, churn;
+    uint32_t delivered, spare = 0;
+    bool bad;
+    int i;
+
+    initPeer(&peer_a);
+    initPeer(&peer_b);
+    tf_a = TF_Init(TF_MASTER);
+    tf_b = TF_Init(TF_SLAVE);
+
+    for (i = 0; i < NR_TYPES; i++)
+    {
+        TF_AddTypeListener(tf_a, (TF_TYPE)(TYPE_BASE + i), typeListener);
+    }
+    TF_AddGenericListener(tf_a, genericListener);
+    TF_AddTypeListener(tf_b, QUERY_TYPE, queryListener);
+
+    for (i = 0; i < NR_WORKERS; i++)
+    {
+        pthread_create(&workers[i], NULL, workerThread, NULL);
+    }
+    pthread_create(&rx, NULL, rxThread, NULL);
+    pthread_create(&query, NULL, queryThread, NULL);
+    pthread_create(&churn, NULL, churnThread, NULL);
+
+    pthread_join(query, NULL);
+    pthread_join(churn, NULL);
+    ATOMIC_SET(stop_rx, 1);
+    pthread_join(rx, NULL);
+
+    // No drain by hand: once the workers are asleep again, all frames must have been delivered
+    if (!waitQuiet()) stranded++;
+    delivered = ATOMIC_GET(a_frames);
+
+    pthread_mutex_lock(&ev_mutex);
+    stop_workers = 1;
+    pthread_cond_broadcast(&ev_cond);
+    pthread_mutex_unlock(&ev_mutex);
+    for (i = 0; i < NR_WORKERS; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    // All churn listeners were removed, their slots must be free again
+    while (TF_AddTypeListener(tf_a, SPARE_TYPE, typeListener)) spare++;
+
+    printf("------ %d workers, %d lanes --------\n", NR_WORKERS, TF_DISPATCH_LANES);
+    printf("frames sent %u, delivered %u, dropped %u\n", b_sent, delivered, tf_a->dispatch_dropped);
+    printf("queries issued %u, completed %u, timed out %u\n", issued, completed, timed_out);
+    printf("churn listener calls %u, free type slots %u (expect %d)\n", churn_calls, spare, TF_MAX_TYPE_LST - NR_TYPES);
+    printf("type order errors %u, part order errors %u, add / remove errors %u, stranded %u\n",
+           type_bad, part_bad, churn_bad, stranded);
+
+    bad = type_bad != 0 || part_bad != 0 || churn_bad != 0 || stranded != 0
+          || delivered + tf_a->dispatch_dropped != b_sent
+          || completed + timed_out != issued
+          || spare != TF_MAX_TYPE_LST - NR_TYPES;
+    printf("%s\n", bad ? "FAILED" : "OK - ordering held, all frames accounted for");
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,36 @@
+#ifndef TF_CONFIG_H
+#define TF_CONFIG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define TF_ID_BYTES     1
+#define TF_LEN_BYTES    2
+#define TF_TYPE_BYTES   1
+#define TF_CKSUM_TYPE TF_CKSUM_CRC16
+#define TF_USE_SOF_BYTE 1
+#define TF_SOF_BYTE     0x01
+typedef uint16_t TF_TICKS;
+typedef uint8_t TF_COUNT;
+#define TF_MAX_PAYLOAD_RX 64
+#define TF_SENDBUF_LEN 64
+#define TF_MAX_ID_LST   24
+#define TF_MAX_TYPE_LST 8
+#define TF_MAX_GEN_LST  4
+#define TF_USE_RANGE_LST 1
+#define TF_MAX_RANGE_LST 8
+#define TF_PARSER_TIMEOUT_TICKS 10
+
+// test_clock.bin is built with TF_USE_CLOCK=1
+#ifndef TF_USE_CLOCK
+#define TF_USE_CLOCK 0
+#endif
+
+// small tables, so IDs share buckets and listeners stay in the wheel for several turns
+#define TF_ID_BUCKETS 8
+#define TF_TIMER_SLOTS 16
+
+// failed adds / removes are part of the test
+#define TF_Error(format, ...) do {} while (0)
+
+#endif //TF_CONFIG_H
@@ -0,0 +1,676 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+
+// Runs random sequences of listener operations against TinyFrame and against a plain
+// reference model (arrays in the order the listeners were added, scanned linearly) and
+// compares which callbacks run, in what order, and what every call returns.
+//
+// ID listeners: add / remove / renew, frames for an ID delivered to its listeners in the
+// order they were added (TF_NEXT / TF_STAY / TF_CLOSE / TF_RENEW), timeouts on TF_Tick().
+// Timeouts run up to MAX_TIMEOUT, many turns of the TF_TIMER_SLOTS wheel. The TF_USE_CLOCK
+// build (test_clock.bin) moves the clock by random steps between the TF_Tick() calls and
+// also checks TF_NextDeadline().
+//
+// Type, Range / Mask and Generic listeners: add / remove with a full table and slots reused
+// through the free lists, including a listener that removes itself and the next one of its
+// type from its callback and returns TF_NEXT. The 256-entry range index is checked against
+// a linear scan of all Range / Mask listeners. `make asan` runs it all with ASan / UBSan.
+
+#define STEPS 200000
+#define NR_IDS 24 // 3 IDs per bucket, several listeners per ID
+#define MAX_TIMEOUT 300
+#define NR_TYPES 12       // types 0, 7, 14.. - several per bucket
+#define NR_TYPE_FN 8      // distinct type listener callbacks
+#define NR_GEN_FN 4       // distinct generic listener callbacks
+#define REMOVER 7         // this type listener removes the first two of its type when called
+#define NR_RANGE_FN 4     // distinct range listener callbacks
+#define RANGE_REMOVER 3   // this one is always added for REMOVER_LO..REMOVER_HI and removes that range
+#define REMOVER_LO 0x80
+#define REMOVER_HI 0xBF
+
+/** One callback call, as recorded by the listeners and predicted by the model */
+enum
+{
+    EV_ID = 1,  // ID listener got a frame
+    EV_CLEANUP, // ID listener removed or timed out, userdata handed back
+    EV_GENERIC, // nobody else took the frame, or generic listener k + 1
+    EV_TYPE,    // type listener k
+    EV_RANGE,   // range / mask listener k
+};
+
+#define EVENT(kind, tag) (((kind) << 16) | (tag))
+#define MAX_EVENTS 64
+
+static int got[MAX_EVENTS], ngot;
+static int expect[MAX_EVENTS], nexpect;
+static uint8_t frame_byte; // payload of the frame being delivered, picks the listener results
+
+/** ID listener in the model - same order as they were added */
+typedef struct
+{
+    int tag;
+    TF_ID id;
+    TF_TICKS timeout;
+    uint32_t due; // on the model clock, which doesn't wrap
+} IdModel;
+
+/** Type or Generic listener in the model; removed ones stay until the step ends, like pinned slots */
+typedef struct
+{
+    int k;
+    TF_TYPE type;
+    bool live;
+} SlotModel;
+
+static IdModel id_model[TF_MAX_ID_LST];
+static int id_live;
+static uint32_t now; // model clock, TF_TICKS wraps around it
+
+/** Range / Mask listener in the model, a range has mask = value = 0, a mask lo = 0, hi = 0xFF */
+typedef struct
+{
+    int k;
+    TF_TYPE lo, hi, mask, value;
+    bool live;
+} RangeModel;
+
+static RangeModel range_model[TF_MAX_RANGE_LST];
+static int range_n;
+
+static SlotModel type_model[TF_MAX_TYPE_LST];
+static SlotModel gen_model[TF_MAX_GEN_LST];
+static int type_n, gen_n;
+
+#if TF_USE_CLOCK
+TF_TICKS TF_GetTime(TinyFrame *tf)
+{
+    return (TF_TICKS)now;
+}
+#endif
+
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    TF_Accept(tf, buff, len); // loop back
+}
+
+static void record(int ev)
+{
+    if (ngot < MAX_EVENTS) got[ngot++] = ev;
+}
+
+static void predict(int ev)
+{
+    if (nexpect < MAX_EVENTS) expect[nexpect++] = ev;
+}
+
+static int cmpInt(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+/** Compare the recorded and predicted calls; `any_order` for expiry, where the model has no order */
+static bool compareEvents(const char *what, int step, bool any_order)
+{
+    int i;
+    if (any_order)
+    {
+        qsort(got, ngot, sizeof(int), cmpInt);
+        qsort(expect, nexpect, sizeof(int), cmpInt);
+    }
+    if (ngot == nexpect && memcmp(got, expect, ngot * sizeof(int)) == 0)
+    {
+        ngot = nexpect = 0;
+        return true;
+    }
+
+    printf("%s: mismatch at step %d\n  got   ", what, step);
+    for (i = 0; i < ngot; i++) printf(" %d:%d", got[i] >> 16, got[i] & 0xFFFF);
+    printf("\n  expect");
+    for (i = 0; i < nexpect; i++) printf(" %d:%d", expect[i] >> 16, expect[i] & 0xFFFF);
+    printf("\n");
+    return false;
+}
+
+/** What a listener returns for the current frame - differs per listener and per frame */
+static TF_Result resultOf(int tag)
+{
+    static const TF_Result results[4] = {TF_NEXT, TF_STAY, TF_CLOSE, TF_RENEW};
+    return results[(frame_byte >> (tag % 7)) & 3];
+}
+
+static TF_Result idListener(TinyFrame *tf, TF_Msg *msg)
+{
+    int tag = (int)(intptr_t)msg->userdata;
+    if (msg->data == NULL)
+    {
+        record(EVENT(EV_CLEANUP, tag));
+        return TF_STAY;
+    }
+    record(EVENT(EV_ID, tag));
+    return resultOf(tag);
+}
+
+static TF_Result genericListener(TinyFrame *tf, TF_Msg *msg)
+{
+    record(EVENT(EV_GENERIC, 0));
+    return TF_STAY;
+}
+
+static TF_Result typeCall(TinyFrame *tf, TF_Msg *msg, int k)
+{
+    record(EVENT(EV_TYPE, k));
+    if (k == REMOVER)
+    {
+        TF_RemoveTypeListener(tf, msg->type);
+        TF_RemoveTypeListener(tf, msg->type);
+    }
+    return resultOf(k);
+}
+
+static TF_Result genCall(TinyFrame *tf, TF_Msg *msg, int k)
+{
+    record(EVENT(EV_GENERIC, k + 1));
+    return resultOf(k + 3);
+}
+
+static TF_Result rangeCall(TinyFrame *tf, TF_Msg *msg, int k)
+{
+    record(EVENT(EV_RANGE, k));
+    if (k == RANGE_REMOVER) TF_RemoveTypeRangeListener(tf, REMOVER_LO, REMOVER_HI);
+    return resultOf(k + 5);
+}
+
+#define TYPE_LISTENER(k) \
+    static TF_Result typeListener##k(TinyFrame *tf, TF_Msg *msg) { return typeCall(tf, msg, k); }
+#define GEN_LISTENER(k) \
+    static TF_Result genListener##k(TinyFrame *tf, TF_Msg *msg) { return genCall(tf, msg, k); }
+#define RANGE_LISTENER(k) \
+    static TF_Result rangeListener##k(TinyFrame *tf, TF_Msg *msg) { return rangeCall(tf, msg, k); }
+
+TYPE_LISTENER(0) TYPE_LISTENER(1) TYPE_LISTENER(2) TYPE_LISTENER(3)
+TYPE_LISTENER(4) TYPE_LISTENER(5) TYPE_LISTENER(6) TYPE_LISTENER(7)
+GEN_LISTENER(0) GEN_LISTENER(1) GEN_LISTENER(2) GEN_LISTENER(3)
+RANGE_LISTENER(0) RANGE_LISTENER(1) RANGE_LISTENER(2) RANGE_LISTENER(3)
+
+static const TF_Listener type_fn[NR_TYPE_FN] = {
+    typeListener0, typeListener1, typeListener2, typeListener3,
+    typeListener4, typeListener5, typeListener6, typeListener7,
+};
+static const TF_Listener gen_fn[NR_GEN_FN] = {genListener0, genListener1, genListener2, genListener3};
+static const TF_Listener range_fn[NR_RANGE_FN] = {rangeListener0, rangeListener1, rangeListener2, rangeListener3};
+
+static int findId(TF_ID id)
+{
+    int j;
+    for (j = 0; j < id_live; j++)
+    {
+        if (id_model[j].id == id) return j;
+    }
+    return -1;
+}
+
+static void dropId(int j)
+{
+    for (; j < id_live - 1; j++) id_model[j] = id_model[j + 1];
+    id_live--;
+}
+
+/** Deliver a response frame with the given ID, predict who gets it */
+static void deliverId(TinyFrame *tf, TF_ID id)
+{
+    TF_Msg msg;
+    TF_Result res;
+    int j;
+
+    frame_byte = (uint8_t)rand();
+    TF_ClearMsg(&msg);
+    msg.frame_id = id;
+    msg.is_response = true;
+    msg.type = 1;
+    msg.data = &frame_byte;
+    msg.len = 1;
+    TF_Send(tf, &msg);
+
+    for (j = 0; j < id_live; j++)
+    {
+        if (id_model[j].id != id) continue;
+        predict(EVENT(EV_ID, id_model[j].tag));
+        res = resultOf(id_model[j].tag);
+        if (res == TF_NEXT) continue;
+        if (res == TF_RENEW) id_model[j].due = now + id_model[j].timeout;
+        if (res == TF_CLOSE) dropId(j); // closed by its callback, no cleanup call
+        return;
+    }
+    predict(EVENT(EV_GENERIC, 0));
+}
+
+/** Move the clock and call TF_Tick(), predict the expired listeners */
+static void tickId(TinyFrame *tf)
+{
+    int j;
+#if TF_USE_CLOCK
+    now += rand() % 4 ? rand() % 6 : rand() % (2 * MAX_TIMEOUT);
+#else
+    now++;
+#endif
+    TF_Tick(tf);
+    for (j = 0; j < id_live; j++)
+    {
+        if (id_model[j].timeout != 0 && id_model[j].due <= now)
+        {
+            predict(EVENT(EV_CLEANUP, id_model[j].tag));
+            dropId(j--);
+        }
+    }
+}
+
+#if TF_USE_CLOCK
+/** TF_NextDeadline() gives the nearest due time, or now if one is overdue */
+static bool checkDeadline(TinyFrame *tf, int step)
+{
+    TF_TICKS deadline;
+    uint32_t best = UINT32_MAX;
+    bool found;
+    int j;
+
+    for (j = 0; j < id_live; j++)
+    {
+        if (id_model[j].timeout != 0 && id_model[j].due < best) best = id_model[j].due;
+    }
+    if (best < now) best = now;
+
+    found = TF_NextDeadline(tf, &deadline);
+    if (found != (best != UINT32_MAX) || (found && deadline != (TF_TICKS)best))
+    {
+        printf("ID listeners: TF_NextDeadline() gave %d / %u, expected %u, step %d\n",
+               found, (unsigned)deadline, (unsigned)(TF_TICKS)best, step);
+        return false;
+    }
+    return true;
+}
+#endif
+
+/** First live listener in a model table, by type (type listeners) or by callback (generic) */
+static int findSlot(SlotModel *model, int n, int k, TF_TYPE type)
+{
+    int j;
+    for (j = 0; j < n; j++)
+    {
+        if (model[j].live && model[j].k == k && model[j].type == type) return j;
+    }
+    return -1;
+}
+
+/** Drop the removed listeners from a model table, returns the nr left */
+static int compactSlots(SlotModel *model, int n)
+{
+    int j, live = 0;
+    for (j = 0; j < n; j++)
+    {
+        if (model[j].live) model[live++] = model[j];
+    }
+    return live;
+}
+
+static int firstOfType(TF_TYPE type)
+{
+    int j;
+    for (j = 0; j < type_n; j++)
+    {
+        if (type_model[j].live && type_model[j].type == type) return j;
+    }
+    return -1;
+}
+
+static bool rangeMatch(const RangeModel *m, TF_TYPE type)
+{
+    return type >= m->lo && type <= m->hi && (type & m->mask) == m->value;
+}
+
+/** Mark the first live range listener with these parameters removed, false if there is none */
+static bool dropRange(TF_TYPE lo, TF_TYPE hi, TF_TYPE mask, TF_TYPE value)
+{
+    int j;
+    for (j = 0; j < range_n; j++)
+    {
+        RangeModel *m = &range_model[j];
+        if (m->live && m->lo == lo && m->hi == hi && m->mask == mask && m->value == value)
+        {
+            m->live = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int compactRanges(void)
+{
+    int j, live = 0;
+    for (j = 0; j < range_n; j++)
+    {
+        if (range_model[j].live) range_model[live++] = range_model[j];
+    }
+    return live;
+}
+
+/** Add a random range or mask listener, or the self-removing one */
+static bool addRange(TinyFrame *tf, int step)
+{
+    RangeModel m;
+    TF_TYPE x;
+    bool ok;
+
+    m.k = rand() % NR_RANGE_FN;
+    m.mask = m.value = 0;
+    m.live = true;
+    if (m.k == RANGE_REMOVER)
+    {
+        m.lo = REMOVER_LO;
+        m.hi = REMOVER_HI;
+        ok = TF_AddTypeRangeListener(tf, m.lo, m.hi, range_fn[m.k]);
+    }
+    else if (rand() % 2)
+    {
+        m.lo = (TF_TYPE)(rand() % 256);
+        m.hi = (TF_TYPE)(rand() % 256);
+        if (rand() % 3 == 0) m.hi = (TF_TYPE)(m.lo + rand() % 20); // narrow
+        if (m.hi < m.lo)
+        {
+            x = m.lo;
+            m.lo = m.hi;
+            m.hi = x;
+        }
+        ok = TF_AddTypeRangeListener(tf, m.lo, m.hi, range_fn[m.k]);
+    }
+    else
+    {
+        m.lo = 0;
+        m.hi = 0xFF;
+        m.mask = (TF_TYPE)(rand() % 256);
+        m.value = (TF_TYPE)(rand() & m.mask);
+        ok = TF_AddTypeMaskListener(tf, m.mask, m.value, range_fn[m.k]);
+    }
+
+    if (ok != (range_n < TF_MAX_RANGE_LST))
+    {
+        printf("Range listeners: add returned %d with %d live, step %d\n", ok, range_n, step);
+        return false;
+    }
+    if (ok) range_model[range_n++] = m;
+    return true;
+}
+
+/** Remove one of the live range / mask listeners */
+static bool removeRange(TinyFrame *tf, int step)
+{
+    RangeModel m;
+    bool ok;
+
+    if (range_n == 0) return true;
+    m = range_model[rand() % range_n];
+    dropRange(m.lo, m.hi, m.mask, m.value);
+    if (m.mask != 0 || (m.lo == 0 && m.hi == 0xFF))
+        ok = TF_RemoveTypeMaskListener(tf, m.mask, m.value);
+    else
+        ok = TF_RemoveTypeRangeListener(tf, m.lo, m.hi);
+    if (!ok) printf("Range listeners: remove of %d..%d %d/%d failed, step %d\n", m.lo, m.hi, m.value, m.mask, step);
+    return ok;
+}
+
+/** Deliver a frame of the given type, predict who gets it */
+static void deliverType(TinyFrame *tf, TF_TYPE type)
+{
+    TF_Result res;
+    int j, r;
+
+    frame_byte = (uint8_t)rand();
+    TF_SendSimple(tf, type, &frame_byte, 1);
+
+    for (j = 0; j < type_n; j++)
+    {
+        if (!type_model[j].live || type_model[j].type != type) continue;
+        predict(EVENT(EV_TYPE, type_model[j].k));
+        if (type_model[j].k == REMOVER)
+        {
+            for (r = 0; r < 2 && firstOfType(type) >= 0; r++) type_model[firstOfType(type)].live = false;
+        }
+        res = resultOf(type_model[j].k);
+        if (res == TF_NEXT) continue;
+        if (res == TF_CLOSE) type_model[j].live = false;
+        return;
+    }
+    // every range / mask listener looked at in order - what the index must reproduce
+    for (j = 0; j < range_n; j++)
+    {
+        if (!range_model[j].live || !rangeMatch(&range_model[j], type)) continue;
+        predict(EVENT(EV_RANGE, range_model[j].k));
+        if (range_model[j].k == RANGE_REMOVER) dropRange(REMOVER_LO, REMOVER_HI, 0, 0);
+        res = resultOf(range_model[j].k + 5);
+        if (res == TF_NEXT) continue;
+        if (res == TF_CLOSE) range_model[j].live = false;
+        return;
+    }
+    for (j = 0; j < gen_n; j++)
+    {
+        if (!gen_model[j].live) continue;
+        predict(EVENT(EV_GENERIC, gen_model[j].k + 1));
+        res = resultOf(gen_model[j].k + 3);
+        if (res == TF_NEXT) continue;
+        if (res == TF_CLOSE) gen_model[j].live = false;
+        return;
+    }
+}
+
+static bool checkTypeListeners(void)
+{
+    TinyFrame *tf = TF_Init(TF_MASTER);
+    TF_TYPE type;
+    int step, r, j, k;
+    bool ok;
+    long delivered = 0, added = 0;
+
+    type_n = gen_n = range_n = 0;
+
+    for (step = 0; step < STEPS; step++)
+    {
+        r = rand() % 28;
+        type = (TF_TYPE)(rand() % NR_TYPES * 7);
+        k = rand() % NR_TYPE_FN;
+
+        if (r < 4)
+        {
+            ok = TF_AddTypeListener(tf, type, type_fn[k]);
+            if (ok != (type_n < TF_MAX_TYPE_LST))
+            {
+                printf("Type listeners: add returned %d with %d live, step %d\n", ok, type_n, step);
+                break;
+            }
+            if (ok)
+            {
+                type_model[type_n].k = k;
+                type_model[type_n].type = type;
+                type_model[type_n++].live = true;
+                added++;
+            }
+        }
+        else if (r < 5)
+        {
+            k %= NR_GEN_FN;
+            ok = TF_AddGenericListener(tf, gen_fn[k]);
+            if (ok != (gen_n < TF_MAX_GEN_LST))
+            {
+                printf("Generic listeners: add returned %d with %d live, step %d\n", ok, gen_n, step);
+                break;
+            }
+            if (ok)
+            {
+                gen_model[gen_n].k = k;
+                gen_model[gen_n].type = 0;
+                gen_model[gen_n++].live = true;
+                added++;
+            }
+        }
+        else if (r < 7)
+        {
+            j = firstOfType(type);
+            if (j >= 0) type_model[j].live = false;
+            if (TF_RemoveTypeListener(tf, type) != (j >= 0))
+            {
+                printf("Type listeners: remove of type %d returned the wrong result, step %d\n", (int)type, step);
+                break;
+            }
+        }
+        else if (r < 8)
+        {
+            k %= NR_GEN_FN;
+            j = findSlot(gen_model, gen_n, k, 0);
+            if (j >= 0) gen_model[j].live = false;
+            if (TF_RemoveGenericListener(tf, gen_fn[k]) != (j >= 0))
+            {
+                printf("Generic listeners: remove returned the wrong result, step %d\n", step);
+                break;
+            }
+        }
+        else if (r < 12)
+        {
+            if (!addRange(tf, step)) break;
+        }
+        else if (r < 13)
+        {
+            if (!removeRange(tf, step)) break;
+        }
+        else
+        {
+            // a type listener's type, any type, or one inside a range / mask listener
+            r = rand() % 4;
+            if (r == 1)
+            {
+                type = (TF_TYPE)(rand() % 256);
+            }
+            else if (r > 1 && range_n != 0)
+            {
+                RangeModel *m = &range_model[rand() % range_n];
+                if (m->mask != 0)
+                    type = (TF_TYPE)((rand() & ~m->mask) | m->value);
+                else
+                    type = (TF_TYPE)(m->lo + rand() % (m->hi - m->lo + 1));
+            }
+            deliverType(tf, type);
+            delivered++;
+        }
+
+        type_n = compactSlots(type_model, type_n);
+        range_n = compactRanges();
+        gen_n = compactSlots(gen_model, gen_n);
+        if (!compareEvents("Type / Range / Generic listeners", step, false)) break;
+    }
+
+    TF_DeInit(tf);
+    printf("Type / Range / Generic listeners: %ld frames, %ld added, %d + %d + %d live at the end\n",
+           delivered, added, type_n, range_n, gen_n);
+    return step == STEPS;
+}
+
+static bool checkIdListeners(void)
+{
+    TinyFrame *tf = TF_Init(TF_MASTER);
+    TF_Msg msg;
+    TF_ID id;
+    TF_TICKS timeout;
+    int step, r, j, tag = 0;
+    bool ok, any_order;
+    long delivered = 0, expired = 0;
+
+    TF_AddGenericListener(tf, genericListener);
+    id_live = 0;
+    now = 0;
+
+    for (step = 0; step < STEPS; step++)
+    {
+        r = rand() % 10;
+        id = (TF_ID)(rand() % NR_IDS);
+        any_order = false;
+
+        if (r < 2)
+        {
+            timeout = (TF_TICKS)(rand() % 2 ? 40 : MAX_TIMEOUT);
+            timeout = (TF_TICKS)(rand() % 4 ? 1 + rand() % timeout : 0);
+            TF_ClearMsg(&msg);
+            msg.frame_id = id;
+            msg.userdata = (void *)(intptr_t)++tag;
+            ok = TF_AddIdListener(tf, &msg, idListener, NULL, timeout);
+            if (ok != (id_live < TF_MAX_ID_LST))
+            {
+                printf("ID listeners: add returned %d with %d live, step %d\n", ok, id_live, step);
+                break;
+            }
+            if (ok)
+            {
+                id_model[id_live].tag = tag;
+                id_model[id_live].id = id;
+                id_model[id_live].timeout = timeout;
+                id_model[id_live].due = now + timeout;
+                id_live++;
+            }
+        }
+        else if (r < 5)
+        {
+            deliverId(tf, id);
+            delivered++;
+        }
+        else if (r < 6)
+        {
+            j = findId(id);
+            if (j >= 0)
+            {
+                predict(EVENT(EV_CLEANUP, id_model[j].tag));
+                dropId(j);
+            }
+            if (TF_RemoveIdListener(tf, id) != (j >= 0))
+            {
+                printf("ID listeners: remove of ID %d returned the wrong result, step %d\n", (int)id, step);
+                break;
+            }
+        }
+        else if (r < 7)
+        {
+            j = findId(id);
+            if (j >= 0) id_model[j].due = now + id_model[j].timeout;
+            if (TF_RenewIdListener(tf, id) != (j >= 0))
+            {
+                printf("ID listeners: renew of ID %d returned the wrong result, step %d\n", (int)id, step);
+                break;
+            }
+        }
+        else
+        {
+            tickId(tf);
+            expired += nexpect;
+            any_order = true;
+        }
+
+        if (!compareEvents("ID listeners", step, any_order)) break;
+#if TF_USE_CLOCK
+        if (!checkDeadline(tf, step)) break;
+#endif
+    }
+
+    TF_DeInit(tf);
+    printf("ID listeners: %ld frames, %ld timeouts, %d live at the end\n", delivered, expired, id_live);
+    return step == STEPS;
+}
+
+int main(void)
+{
+    bool bad = false;
+
+    srand(1);
+    printf("------ listener model%s --------\n", TF_USE_CLOCK ? ", TF_USE_CLOCK" : "");
+    bad |= !checkIdListeners();
+    bad |= !checkTypeListeners();
+
+    printf("%s\n", bad ? "FAILED" : "OK - all listener calls match the model");
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,28 @@
+//
+// Link B: 2-byte ID and type, CRC32, larger buffers
+//
+
+#ifndef LINK_B_CONFIG_H
+#define LINK_B_CONFIG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define TF_ID_BYTES     2
+#define TF_LEN_BYTES    2
+#define TF_TYPE_BYTES   2
+#define TF_CKSUM_TYPE TF_CKSUM_CRC32
+#define TF_USE_SOF_BYTE 1
+#define TF_SOF_BYTE     0x5A
+typedef uint32_t TF_TICKS;
+typedef uint16_t TF_COUNT;
+#define TF_MAX_PAYLOAD_RX 1024
+#define TF_SENDBUF_LEN 256
+#define TF_MAX_ID_LST   10
+#define TF_MAX_TYPE_LST 10
+#define TF_MAX_GEN_LST  5
+#define TF_PARSER_TIMEOUT_TICKS 100
+
+#define TF_Error(format, ...) printf("[TF B] " format "\n", ##__VA_ARGS__)
+
+#endif //LINK_B_CONFIG_H
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <string.h>
+
+// Both links in one file, each with its own prefix and config
+#define TF_PREFIX link_a_
+#define TF_CONFIG_HEADER "link_a_config.h"
+#include "../../TinyFrame.h"
+
+#define TF_PREFIX link_b_
+#define TF_CONFIG_HEADER "link_b_config.h"
+#include "../../TinyFrame.h"
+
+link_a_TinyFrame *tf_a;
+link_b_TinyFrame *tf_b;
+
+static void dump(const char *name, const uint8_t *buff, uint32_t len)
+{
+    printf("%s frame, %u bytes:", name, (unsigned)len);
+    for (uint32_t i = 0; i < len; i++)
+    {
+        printf(" %02X", buff[i]);
+    }
+    printf("\n");
+}
+
+/** Link A loops back to itself */
+void link_a_TF_WriteImpl(link_a_TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    dump("A", buff, len);
+    link_a_TF_Accept(tf, buff, len);
+}
+
+/** Link B loops back to itself */
+void link_b_TF_WriteImpl(link_b_TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    dump("B", buff, len);
+    link_b_TF_Accept(tf, buff, len);
+}
+
+/** Forward everything received on link A to link B, with the type moved to 0x1000 + type */
+TF_Result forwardListener(link_a_TinyFrame *tf, link_a_TF_Msg *msg)
+{
+    printf("A received type %02Xh id %02Xh, forwarding to B\n", msg->type, msg->frame_id);
+    link_b_TF_SendSimple(tf_b, (link_b_TF_TYPE)(0x1000 + msg->type), msg->data, msg->len);
+    return TF_STAY;
+}
+
+TF_Result sinkListener(link_b_TinyFrame *tf, link_b_TF_Msg *msg)
+{
+    printf("B received type %04Xh id %04Xh: \"%.*s\"\n", msg->type, msg->frame_id, (int)msg->len, (const char *)msg->data);
+    return TF_STAY;
+}
+
+int main(void)
+{
+    tf_a = link_a_TF_Init(TF_MASTER);
+    tf_b = link_b_TF_Init(TF_SLAVE);
+
+    link_a_TF_AddGenericListener(tf_a, forwardListener);
+    link_b_TF_AddGenericListener(tf_b, sinkListener);
+
+    printf("sizeof(link_a_TinyFrame) = %u, sizeof(link_b_TinyFrame) = %u\n",
+           (unsigned)sizeof(link_a_TinyFrame), (unsigned)sizeof(link_b_TinyFrame));
+
+    link_a_TF_SendSimple(tf_a, 0x22, (const uint8_t *)"Hello TinyFrame", 16);
+    link_a_TF_SendSimple(tf_a, 0x33, (const uint8_t *)"Gateway", 8);
+    return 0;
+}
@@ -0,0 +1,4 @@
+// TinyFrame compiled for link A, all names prefixed with link_a_
+#define TF_PREFIX link_a_
+#define TF_CONFIG_HEADER "link_a_config.h"
+#include "../../TinyFrame.c"
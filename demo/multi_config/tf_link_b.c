@@ -0,0 +1,4 @@
+// TinyFrame compiled for link B, all names prefixed with link_b_
+#define TF_PREFIX link_b_
+#define TF_CONFIG_HEADER "link_b_config.h"
+#include "../../TinyFrame.c"
@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+
+// Checks that the parser finds a frame starting inside a broken header. Each step sends the
+// start of a frame cut off inside its header, or a whole frame with a corrupted header, then
+// two good frames; both good frames must be delivered, in order and intact. The bytes are fed
+// byte by byte with TF_AcceptChar() (the lookback replay in the state machine), in one
+// TF_Accept() call (the header fast path, which resumes right after the broken header's first
+// byte) and in random pieces mixing both. Built with and without the SOF byte.
+
+#define HEAD_BYTES (TF_ID_BYTES + TF_LEN_BYTES + TF_TYPE_BYTES + 4) // header after the SOF, CRC32
+#define STEPS 20000
+#define MAX_FRAME (TF_USE_SOF_BYTE + HEAD_BYTES + TF_MAX_PAYLOAD_RX + 4)
+
+/** How the bytes are fed to the parser */
+enum
+{
+    FEED_CHAR,  // TF_AcceptChar() for every byte
+    FEED_BULK,  // one TF_Accept()
+    FEED_MIXED, // random pieces, each with TF_Accept() or byte by byte
+    FEED_COUNT
+};
+
+static const char *feed_names[FEED_COUNT] = {"char", "bulk", "mixed"};
+
+/** A frame as sent, and as received */
+typedef struct
+{
+    TF_TYPE type;
+    TF_LEN len;
+    uint8_t data[TF_MAX_PAYLOAD_RX];
+} Frame;
+
+static uint8_t wire[3 * MAX_FRAME];
+static uint32_t wire_len;
+
+static Frame got[4];
+static int ngot;
+
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    memcpy(wire + wire_len, buff, len);
+    wire_len += len;
+}
+
+static TF_Result genericListener(TinyFrame *tf, TF_Msg *msg)
+{
+    if (ngot < 4)
+    {
+        got[ngot].type = msg->type;
+        got[ngot].len = msg->len;
+        memcpy(got[ngot].data, msg->data, msg->len);
+    }
+    ngot++;
+    return TF_STAY;
+}
+
+/** Append a random frame to `wire` */
+static void sendFrame(TinyFrame *tx, Frame *f, bool broken)
+{
+    TF_Msg msg;
+    uint32_t i;
+
+    f->type = (TF_TYPE)rand();
+    f->len = (TF_LEN)(rand() % (TF_MAX_PAYLOAD_RX + 1));
+    if (broken && f->len == TF_USE_SOF_BYTE + HEAD_BYTES - 4)
+    {
+        // The payload checksum covers as many bytes as a header checksum - a frame found in the
+        // payload (at its start, in the SOF byte build if that's a SOF) has a valid header
+        f->len++;
+    }
+    for (i = 0; i < f->len; i++) f->data[i] = (uint8_t)rand();
+
+    TF_ClearMsg(&msg);
+    msg.type = f->type;
+    msg.data = f->data;
+    msg.len = f->len;
+    TF_Send(tx, &msg);
+}
+
+/** Feed `wire`, as given by `mode` */
+static void feed(TinyFrame *tf, int mode)
+{
+    uint32_t i = 0, n;
+
+    switch (mode)
+    {
+    case FEED_CHAR:
+        for (i = 0; i < wire_len; i++) TF_AcceptChar(tf, wire[i]);
+        break;
+    case FEED_BULK:
+        TF_Accept(tf, wire, wire_len);
+        break;
+    default:
+        while (i < wire_len)
+        {
+            n = 1 + (uint32_t)rand() % 24;
+            if (n > wire_len - i) n = wire_len - i;
+            if (rand() & 1)
+            {
+                TF_Accept(tf, wire + i, n);
+                i += n;
+            }
+            else
+            {
+                while (n--) TF_AcceptChar(tf, wire[i++]);
+            }
+        }
+        break;
+    }
+}
+
+static bool sameFrame(const Frame *a, const Frame *b)
+{
+    return a->type == b->type && a->len == b->len && memcmp(a->data, b->data, a->len) == 0;
+}
+
+int main(void)
+{
+    TinyFrame *tx, *tf;
+    Frame broken, good[2];
+    uint8_t head[TF_USE_SOF_BYTE + HEAD_BYTES];
+    uint32_t cut, start, resumed = 0, corrupted = 0;
+    int step, mode;
+    bool bad = false;
+
+    srand(1);
+    printf("------ resync, %s --------\n", TF_USE_SOF_BYTE ? "SOF byte" : "no SOF byte");
+    tx = TF_Init(TF_MASTER);
+    tf = TF_Init(TF_SLAVE);
+    TF_AddGenericListener(tf, genericListener);
+
+    for (step = 0; step < STEPS && !bad; step++)
+    {
+        mode = step % FEED_COUNT;
+        wire_len = 0;
+        sendFrame(tx, &broken, true);
+        memcpy(head, wire, sizeof(head));
+
+        if (step & 1)
+        {
+            // cut off inside the header, the next frame starts in the bytes read as its header
+            cut = 1 + (uint32_t)rand() % (TF_USE_SOF_BYTE ? HEAD_BYTES : HEAD_BYTES - 1);
+            wire_len = cut;
+        }
+        else
+        {
+            // a whole frame with a corrupted header byte
+            wire[TF_USE_SOF_BYTE + (uint32_t)rand() % HEAD_BYTES] ^= (uint8_t)(1 + rand() % 255);
+        }
+
+        start = wire_len;
+        sendFrame(tx, &good[0], false);
+        sendFrame(tx, &good[1], false);
+
+        // The next frame may start with the bytes cut off (its SOF or ID byte in place of the last
+        // checksum byte) - the header is then not broken, try another one
+        if ((step & 1) && memcmp(wire + cut, head + cut, sizeof(head) - cut) == 0)
+        {
+            step--;
+            continue;
+        }
+        if (step & 1)
+            resumed++;
+        else
+            corrupted++;
+
+        ngot = 0;
+        feed(tf, mode);
+
+        if (ngot != 2 || !sameFrame(&got[0], &good[0]) || !sameFrame(&got[1], &good[1]))
+        {
+            printf("%s, step %d: %d frames delivered after %u broken bytes (%s)\n", feed_names[mode], step,
+                   ngot, (unsigned)start, (step & 1) ? "header cut off" : "header corrupted");
+            bad = true;
+        }
+    }
+
+    TF_DeInit(tf);
+    TF_DeInit(tx);
+    printf("%u cut off headers, %u corrupted headers\n", (unsigned)resumed, (unsigned)corrupted);
+    printf("%s\n", bad ? "FAILED" : "OK - every frame after a broken header delivered");
+    return bad ? 1 : 0;
+}
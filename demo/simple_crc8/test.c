@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../../TinyFrame.c"
+#include "../utils.h"
+
+TinyFrame *demo_tf;
+
+/** The former bit-by-bit CRC8, kept here as the reference */
+static uint8_t crc8_bits(uint8_t data)
+{
+    uint8_t crc = 0;
+    if (data & 1)
+        crc ^= 0x5e;
+    if (data & 2)
+        crc ^= 0xbc;
+    if (data & 4)
+        crc ^= 0x61;
+    if (data & 8)
+        crc ^= 0xc2;
+    if (data & 0x10)
+        crc ^= 0x9d;
+    if (data & 0x20)
+        crc ^= 0x23;
+    if (data & 0x40)
+        crc ^= 0x46;
+    if (data & 0x80)
+        crc ^= 0x8c;
+    return crc;
+}
+
+static uint8_t crc8_ref(const uint8_t *buf, uint32_t len)
+{
+    uint8_t crc = 0;
+    while (len--)
+    {
+        crc = crc8_bits(*buf++ ^ crc);
+    }
+    return crc;
+}
+
+static uint8_t crc8_table_bytes(const uint8_t *buf, uint32_t len)
+{
+    TF_CKSUM crc = TF_CksumStart();
+    while (len--)
+    {
+        crc = TF_CksumAdd(crc, *buf++);
+    }
+    return TF_CksumEnd(crc);
+}
+
+static uint8_t crc8_sliced(const uint8_t *buf, uint32_t len)
+{
+    return TF_CksumEnd(TF_CksumAddBlock(TF_CksumStart(), buf, len));
+}
+
+static double bench(uint8_t (*fn)(const uint8_t *, uint32_t), const uint8_t *buf, uint32_t len, int rounds)
+{
+    volatile uint8_t sink = 0;
+    clock_t t0 = clock();
+    for (int i = 0; i < rounds; i++)
+    {
+        sink ^= fn(buf, len);
+    }
+    double secs = (double)(clock() - t0) / CLOCKS_PER_SEC;
+    return secs > 0 ? (double)len * rounds / secs / 1e6 : 0;
+}
+
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    // Send it back as if we received it
+    TF_Accept(tf, buff, len);
+}
+
+TF_Result myListener(TinyFrame *tf, TF_Msg *msg)
+{
+    dumpFrameInfo(msg);
+    return TF_STAY;
+}
+
+int main(void)
+{
+    static uint8_t buf[4096 + 8];
+    TF_Msg msg;
+    int bad = 0;
+
+    srand(1);
+    for (uint32_t i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = (uint8_t)rand();
+    }
+
+    printf("------ Check value of \"123456789\" (expect 0xA1) --------\n");
+    printf("bits 0x%02X, table 0x%02X, sliced 0x%02X\n", crc8_ref((const uint8_t *)"123456789", 9),
+           crc8_table_bytes((const uint8_t *)"123456789", 9), crc8_sliced((const uint8_t *)"123456789", 9));
+
+    printf("------ Compare table / sliced with bit-by-bit --------\n");
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        if (crc8_table[i] != crc8_bits((uint8_t)i))
+        {
+            printf("table mismatch at %u\n", i);
+            bad++;
+        }
+    }
+    for (uint32_t off = 0; off < 8; off++)
+    {
+        for (uint32_t len = 0; len <= 300; len++)
+        {
+            uint8_t ref = crc8_ref(buf + off, len);
+            if (crc8_table_bytes(buf + off, len) != ref || crc8_sliced(buf + off, len) != ref)
+            {
+                printf("mismatch at offset %u, len %u\n", off, len);
+                bad++;
+            }
+        }
+    }
+    for (uint32_t len = 0; len <= 300; len++)
+    {
+        for (uint32_t split = 0; split <= len; split++)
+        {
+            TF_CKSUM c = TF_CksumCombine(TF_Cksum(buf, split), TF_Cksum(buf + split, len - split), len - split);
+            if (c != crc8_ref(buf, len))
+            {
+                printf("combine mismatch at len %u, split %u\n", len, split);
+                bad++;
+            }
+        }
+    }
+    printf("%s\n", bad ? "FAILED" : "OK - all lengths, offsets and split points match");
+
+    printf("------ Throughput, 4 KB blocks --------\n");
+    printf("bit-by-bit: %8.1f MB/s\n", bench(crc8_ref, buf, 4096, 20000));
+    printf("table:      %8.1f MB/s\n", bench(crc8_table_bytes, buf, 4096, 20000));
+    printf("sliced-%d:   %8.1f MB/s\n", TF_CRC_SLICING, bench(crc8_sliced, buf, 4096, 20000));
+
+    printf("------ Send a frame with the CRC8 checksum --------\n");
+    demo_tf = TF_Init(TF_MASTER);
+    TF_AddGenericListener(demo_tf, myListener);
+
+    TF_ClearMsg(&msg);
+    msg.type = 0x22;
+    msg.data = (pu8) "Hello TinyFrame";
+    msg.len = 16;
+    TF_Send(demo_tf, &msg);
+
+    return bad ? 1 : 0;
+}
@@ -12,6 +12,7 @@
 #define TF_LEN_BYTES    2
 #define TF_TYPE_BYTES   1
 #define TF_CKSUM_TYPE TF_CKSUM_CUSTOM8
+#define TF_CKSUM_CUSTOM_BLOCK 1
 #define TF_USE_SOF_BYTE 1
 #define TF_SOF_BYTE     0x01
 typedef uint16_t TF_TICKS;
@@ -86,3 +86,12 @@ TF_CKSUM TF_CksumEnd(TF_CKSUM cksum)
 {
     return ~cksum ^ 0xA5;
 }
+
+// same as TF_CksumAdd() for each byte, without a function call per byte
+TF_CKSUM TF_CksumAddBlock(TF_CKSUM cksum, const uint8_t *buf, uint32_t len)
+{
+    while (len--) {
+        cksum ^= *buf++ + 1;
+    }
+    return cksum;
+}
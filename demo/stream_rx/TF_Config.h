@@ -0,0 +1,28 @@
+#ifndef TF_CONFIG_H
+#define TF_CONFIG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define TF_ID_BYTES     1
+#define TF_LEN_BYTES    2
+#define TF_TYPE_BYTES   1
+#define TF_CKSUM_TYPE TF_CKSUM_CRC32
+#define TF_USE_SOF_BYTE 1
+#define TF_SOF_BYTE     0x01
+typedef uint16_t TF_TICKS;
+typedef uint8_t TF_COUNT;
+#define TF_MAX_PAYLOAD_RX 64
+#define TF_SENDBUF_LEN 64
+#define TF_MAX_ID_LST   4
+#define TF_MAX_TYPE_LST 4
+#define TF_MAX_GEN_LST  2
+#define TF_PARSER_TIMEOUT_TICKS 10
+
+#define TF_USE_STREAM_RX 1
+#define TF_MAX_STREAM_LST 2
+
+// broken frames and payloads too long for the buffer are part of the test
+#define TF_Error(format, ...) do {} while (0)
+
+#endif //TF_CONFIG_H
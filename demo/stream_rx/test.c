@@ -0,0 +1,383 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+
+// Streams payloads larger than TF_MAX_PAYLOAD_RX to a stream listener and checks that the
+// chunks cover the payload in order (offsets, lengths and bytes) and that the end callback
+// gets cksum_ok. The frames are fed with TF_Accept() in one piece, byte by byte with
+// TF_AcceptChar(), and mixed at random split points; some have a corrupted payload or
+// checksum. Frames abandoned by TF_ResetParser() or by the parser timeout end with
+// cksum_ok = false. Listeners removing themselves from the chunk or the end callback (and
+// adding a new one) stop the stream without touching the removed slot.
+
+#define BIG_TYPE 0x42
+#define SMALL_TYPE 0x10
+#define MAX_LEN 1500
+#define HEAD_LEN (1 + TF_ID_BYTES + TF_LEN_BYTES + TF_TYPE_BYTES + 4) // SOF, header, CRC32
+#define STEPS 4000
+
+/** How the frame is fed to the parser */
+enum
+{
+    FEED_BULK,  // one TF_Accept()
+    FEED_CHAR,  // TF_AcceptChar() for every byte
+    FEED_MIXED, // random pieces, each with TF_Accept() or byte by byte
+    FEED_SPLIT, // header + 3 payload bytes byte by byte, the rest with TF_Accept()
+    FEED_COUNT
+};
+
+/** What the stream listener does when called */
+enum
+{
+    ACT_STAY,         // keep the listener
+    ACT_CLOSE,        // end returns TF_CLOSE
+    ACT_CHUNK_REMOVE, // the first chunk removes the listener
+    ACT_CHUNK_READD,  // the first chunk removes the listener and adds it again
+    ACT_END_REMOVE,   // end removes the listener, returns TF_STAY
+    ACT_END_READD,    // end removes the listener, adds it again and returns TF_CLOSE
+};
+
+static uint8_t wire[MAX_LEN + 64];
+static uint32_t wire_len;
+
+/** State of the stream listener */
+static struct
+{
+    const uint8_t *payload; // payload as fed to the parser
+    uint32_t len;
+    uint32_t next; // offset of the next expected chunk
+    int chunks;
+    int ends;
+    bool ok;       // cksum_ok of the last end
+    uint32_t done; // payload bytes received before the last end
+    bool bad;      // a chunk didn't match
+    int action;
+} rx;
+
+static int generic_calls;
+static uint32_t generic_len;
+
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    memcpy(wire + wire_len, buff, len);
+    wire_len += len;
+}
+
+static void onChunk(TinyFrame *tf, TF_Msg *msg, uint32_t offset, const uint8_t *chunk, uint32_t len);
+static TF_Result onEnd(TinyFrame *tf, TF_Msg *msg, bool cksum_ok);
+
+static void onChunk(TinyFrame *tf, TF_Msg *msg, uint32_t offset, const uint8_t *chunk, uint32_t len)
+{
+    if (msg->type != BIG_TYPE || msg->len != rx.len || msg->data != NULL || offset != rx.next ||
+        len == 0 || len > rx.len - offset || memcmp(chunk, rx.payload + offset, len) != 0)
+    {
+        printf("bad chunk: offset %u len %u, expected offset %u of %u\n",
+               (unsigned)offset, (unsigned)len, (unsigned)rx.next, (unsigned)rx.len);
+        rx.bad = true;
+    }
+    rx.next = offset + len;
+    rx.chunks++;
+
+    if (rx.action == ACT_CHUNK_REMOVE || rx.action == ACT_CHUNK_READD)
+    {
+        if (!TF_RemoveStreamListener(tf, msg->type)) rx.bad = true;
+        if (rx.action == ACT_CHUNK_READD && !TF_AddStreamListener(tf, msg->type, onChunk, onEnd)) rx.bad = true;
+        rx.action = ACT_STAY;
+    }
+}
+
+static TF_Result onEnd(TinyFrame *tf, TF_Msg *msg, bool cksum_ok)
+{
+    int action = rx.action;
+
+    rx.ends++;
+    rx.ok = cksum_ok;
+    rx.done = rx.next;
+    rx.next = 0;
+    if (msg->type != BIG_TYPE || msg->len != rx.len) rx.bad = true;
+
+    rx.action = ACT_STAY;
+    switch (action)
+    {
+    case ACT_CLOSE:
+        return TF_CLOSE;
+    case ACT_END_REMOVE:
+        if (!TF_RemoveStreamListener(tf, msg->type)) rx.bad = true;
+        return TF_STAY;
+    case ACT_END_READD:
+        // the new listener takes a free slot, TF_CLOSE must not remove it
+        if (!TF_RemoveStreamListener(tf, msg->type)) rx.bad = true;
+        if (!TF_AddStreamListener(tf, msg->type, onChunk, onEnd)) rx.bad = true;
+        return TF_CLOSE;
+    default:
+        return TF_STAY;
+    }
+}
+
+static TF_Result genericListener(TinyFrame *tf, TF_Msg *msg)
+{
+    generic_calls++;
+    generic_len = msg->len;
+    return TF_STAY;
+}
+
+/** Build a frame in `wire` */
+static void buildFrame(TinyFrame *tx, TF_TYPE type, uint32_t len)
+{
+    static uint8_t payload[MAX_LEN];
+    TF_Msg msg;
+    uint32_t i;
+
+    for (i = 0; i < len; i++) payload[i] = (uint8_t)rand();
+    TF_ClearMsg(&msg);
+    msg.type = type;
+    msg.data = payload;
+    msg.len = (TF_LEN)len;
+    wire_len = 0;
+    TF_Send(tx, &msg);
+}
+
+/** Feed `len` bytes of `buf`, as given by `mode` */
+static void feed(TinyFrame *tf, const uint8_t *buf, uint32_t len, int mode)
+{
+    uint32_t i = 0, n;
+
+    switch (mode)
+    {
+    case FEED_BULK:
+        TF_Accept(tf, buf, len);
+        break;
+    case FEED_CHAR:
+        for (i = 0; i < len; i++) TF_AcceptChar(tf, buf[i]);
+        break;
+    case FEED_MIXED:
+        while (i < len)
+        {
+            n = 1 + (uint32_t)rand() % 100;
+            if (n > len - i) n = len - i;
+            if (rand() & 1)
+            {
+                TF_Accept(tf, buf + i, n);
+                i += n;
+            }
+            else
+            {
+                while (n--) TF_AcceptChar(tf, buf[i++]);
+            }
+        }
+        break;
+    default:
+        n = len < HEAD_LEN + 3 ? len : HEAD_LEN + 3;
+        for (i = 0; i < n; i++) TF_AcceptChar(tf, buf[i]);
+        TF_Accept(tf, buf + n, len - n);
+        break;
+    }
+}
+
+/** Start receiving a frame of `len` payload bytes from `wire` */
+static void expectFrame(uint32_t len)
+{
+    rx.payload = wire + HEAD_LEN;
+    rx.len = len;
+    rx.next = 0;
+    rx.chunks = 0;
+    rx.ends = 0;
+}
+
+/** Big and small frames, good and corrupted, fed in all the ways */
+static bool checkStream(TinyFrame *tx, TinyFrame *tf)
+{
+    int step, mode, generic_before;
+    uint32_t len;
+    bool corrupt;
+
+    for (step = 0; step < STEPS; step++)
+    {
+        len = (rand() & 7) == 0 ? 1 + (uint32_t)rand() % TF_MAX_PAYLOAD_RX
+                                : TF_MAX_PAYLOAD_RX + 1 + (uint32_t)rand() % (MAX_LEN - TF_MAX_PAYLOAD_RX);
+        mode = step % FEED_COUNT;
+        buildFrame(tx, BIG_TYPE, len);
+
+        // a corrupted payload or payload checksum byte
+        corrupt = (rand() & 3) == 0;
+        if (corrupt) wire[HEAD_LEN + (uint32_t)rand() % (len + 4)] ^= (uint8_t)(1 + rand() % 255);
+
+        expectFrame(len);
+        generic_before = generic_calls;
+        feed(tf, wire, wire_len, mode);
+
+        if (len <= TF_MAX_PAYLOAD_RX)
+        {
+            // fits in the buffer, goes to the generic listener
+            if (rx.chunks != 0 || rx.ends != 0 || generic_calls != generic_before + !corrupt)
+            {
+                printf("stream: short frame of %u streamed, step %d\n", (unsigned)len, step);
+                return false;
+            }
+        }
+        else if (rx.bad || rx.ends != 1 || rx.done != len || rx.ok == corrupt || generic_calls != generic_before)
+        {
+            printf("stream: frame of %u, mode %d%s: %d chunks, %u bytes, %d ends, cksum_ok %d, step %d\n",
+                   (unsigned)len, mode, corrupt ? ", corrupted" : "", rx.chunks, (unsigned)rx.done, rx.ends, rx.ok, step);
+            return false;
+        }
+    }
+    printf("stream: %d frames, all chunks in order\n", step);
+    return true;
+}
+
+/** Frames abandoned by a parser reset or timeout end with cksum_ok = false, the next frame is received */
+static bool checkAbandoned(TinyFrame *tx, TinyFrame *tf)
+{
+    int step, mode;
+    uint32_t len, cut;
+    bool timeout;
+
+    for (step = 0; step < 1000; step++)
+    {
+        len = TF_MAX_PAYLOAD_RX + 1 + (uint32_t)rand() % (MAX_LEN - TF_MAX_PAYLOAD_RX);
+        mode = step % FEED_COUNT;
+        timeout = step & 1;
+        buildFrame(tx, BIG_TYPE, len);
+        expectFrame(len);
+
+        cut = HEAD_LEN + 1 + (uint32_t)rand() % (len - 1);
+        feed(tf, wire, cut, mode);
+        if (timeout)
+        {
+            for (int i = 0; i < TF_PARSER_TIMEOUT_TICKS; i++) TF_Tick(tf);
+        }
+        else
+        {
+            TF_ResetParser(tf);
+            if (rx.ends != 1 || rx.ok || rx.done > cut - HEAD_LEN)
+            {
+                printf("abandoned: reset after %u of %u bytes: %d ends, cksum_ok %d, step %d\n",
+                       (unsigned)(cut - HEAD_LEN), (unsigned)len, rx.ends, rx.ok, step);
+                return false;
+            }
+        }
+
+        // the same frame again, in full - after a timeout, its first byte ends the abandoned one
+        feed(tf, wire, wire_len, mode);
+        if (rx.bad || rx.ends != 2 || !rx.ok || rx.done != len)
+        {
+            printf("abandoned: frame of %u after %s at %u: %d ends, cksum_ok %d, %u bytes, step %d\n",
+                   (unsigned)len, timeout ? "timeout" : "reset", (unsigned)(cut - HEAD_LEN), rx.ends, rx.ok,
+                   (unsigned)rx.done, step);
+            return false;
+        }
+    }
+    printf("abandoned: %d frames reset or timed out\n", step);
+    return true;
+}
+
+/** Feed a frame of 300 payload bytes, the listener does `action` */
+static void sendBig(TinyFrame *tx, TinyFrame *tf, int action, int mode)
+{
+    buildFrame(tx, BIG_TYPE, 300);
+    expectFrame(300);
+    rx.action = action;
+    feed(tf, wire, wire_len, mode);
+}
+
+/** A small frame after a stopped stream reaches the generic listener */
+static bool smallFrameOk(TinyFrame *tx, TinyFrame *tf)
+{
+    int before = generic_calls;
+    buildFrame(tx, SMALL_TYPE, 20);
+    TF_Accept(tf, wire, wire_len);
+    return generic_calls == before + 1 && generic_len == 20;
+}
+
+/** Listeners removed (and added again) from their own callbacks */
+static bool checkRemoval(TinyFrame *tx)
+{
+    static const char *feed_names[FEED_COUNT] = {"bulk", "char", "mixed", "split"};
+    TinyFrame *tf;
+    int mode;
+    const char *why;
+    bool good, ok = true;
+
+    for (mode = 0; mode < FEED_COUNT; mode++)
+    {
+        good = true;
+        why = NULL;
+        tf = TF_Init(TF_SLAVE);
+        TF_AddGenericListener(tf, genericListener);
+
+        // the first chunk removes the listener - the rest of the frame is discarded
+        rx.bad = false;
+        TF_AddStreamListener(tf, BIG_TYPE, onChunk, onEnd);
+        sendBig(tx, tf, ACT_CHUNK_REMOVE, mode);
+        good &= !rx.bad && rx.chunks == 1 && rx.ends == 0 && smallFrameOk(tx, tf);
+        sendBig(tx, tf, ACT_STAY, mode);
+        good &= !rx.bad && rx.chunks == 0 && rx.ends == 0;
+        if (!good && why == NULL) why = "removed in the chunk callback";
+
+        // removed and added again from the chunk callback - gets the next frame
+        TF_AddStreamListener(tf, BIG_TYPE, onChunk, onEnd);
+        sendBig(tx, tf, ACT_CHUNK_READD, mode);
+        good &= !rx.bad && rx.chunks == 1 && rx.ends == 0 && smallFrameOk(tx, tf);
+        sendBig(tx, tf, ACT_STAY, mode);
+        good &= !rx.bad && rx.ends == 1 && rx.ok && rx.done == 300;
+        if (!good && why == NULL) why = "added again in the chunk callback";
+
+        // the end callback removes it and returns TF_STAY
+        sendBig(tx, tf, ACT_END_REMOVE, mode);
+        good &= !rx.bad && rx.ends == 1 && rx.ok;
+        sendBig(tx, tf, ACT_STAY, mode);
+        good &= !rx.bad && rx.chunks == 0 && rx.ends == 0 && smallFrameOk(tx, tf);
+        if (!good && why == NULL) why = "removed in the end callback";
+
+        // TF_CLOSE from the end callback
+        TF_AddStreamListener(tf, BIG_TYPE, onChunk, onEnd);
+        sendBig(tx, tf, ACT_CLOSE, mode);
+        good &= !rx.bad && rx.ends == 1 && rx.ok;
+        sendBig(tx, tf, ACT_STAY, mode);
+        good &= !rx.bad && rx.chunks == 0 && rx.ends == 0;
+        if (!good && why == NULL) why = "TF_CLOSE";
+
+        // removed and added again from the end callback, which returns TF_CLOSE for the old one
+        TF_AddStreamListener(tf, BIG_TYPE, onChunk, onEnd);
+        sendBig(tx, tf, ACT_END_READD, mode);
+        good &= !rx.bad && rx.ends == 1 && rx.ok;
+        sendBig(tx, tf, ACT_STAY, mode);
+        good &= !rx.bad && rx.ends == 1 && rx.ok && rx.done == 300;
+        if (!good && why == NULL) why = "added again in the end callback";
+
+        // both slots usable again
+        good &= TF_AddStreamListener(tf, BIG_TYPE + 1, onChunk, onEnd);
+        if (!good && why == NULL) why = "stream listener slot not freed";
+
+        TF_DeInit(tf);
+        if (!good) printf("removal (%s): %s\n", feed_names[mode], why);
+        ok &= good;
+    }
+    if (ok) printf("removal: listeners removed from their callbacks, all feeding modes\n");
+    return ok;
+}
+
+int main(void)
+{
+    TinyFrame *tx, *tf;
+    bool bad = false;
+
+    srand(1);
+    printf("------ stream rx --------\n");
+    tx = TF_Init(TF_MASTER);
+
+    tf = TF_Init(TF_SLAVE);
+    TF_AddGenericListener(tf, genericListener);
+    TF_AddStreamListener(tf, BIG_TYPE, onChunk, onEnd);
+    bad |= !checkStream(tx, tf);
+    bad |= !checkAbandoned(tx, tf);
+    TF_DeInit(tf);
+
+    bad |= !checkRemoval(tx);
+    TF_DeInit(tx);
+
+    printf("%s\n", bad ? "FAILED" : "OK - all chunks and stream ends as expected");
+    return bad ? 1 : 0;
+}